@@ -212,6 +212,52 @@ FilopodiaFunctions::readSpatialGraph(const QFileInfo& fileInfo)
     return graph;
 }
 
+std::vector<McHandle<HxSpatialGraph> >
+FilopodiaFunctions::readSpatialGraphs(const QStringList& files)
+{
+    // AmiraMesh::read and readData() depend on the global
+    // AmiraMesh::recordFilePosition and are not known to be reentrant, so the
+    // files are read one after another. Each graph is created as soon as its
+    // file has been parsed, so only one AmiraMesh is in memory at a time.
+    std::vector<McHandle<HxSpatialGraph> > graphs(files.size());
+    for (int f = 0; f < files.size(); ++f)
+    {
+        graphs[f] = readSpatialGraph(QFileInfo(files[f]));
+    }
+    return graphs;
+}
+
+void
+FilopodiaFunctions::mergeSpatialGraphs(std::vector<McHandle<HxSpatialGraph> > graphs,
+                                       HxSpatialGraph* mergedGraph)
+{
+    if (graphs.empty())
+    {
+        mergedGraph->clear();
+        return;
+    }
+
+    // Neighboring graphs are merged pairwise, so that every vertex and edge is copied
+    // log2(n) times instead of once for each later graph. Since merging appends,
+    // the result is the same as merging the graphs one after the other.
+    while (graphs.size() > 1)
+    {
+        std::vector<McHandle<HxSpatialGraph> > merged;
+        for (int i = 0; i + 1 < int(graphs.size()); i += 2)
+        {
+            graphs[i]->merge(graphs[i + 1]);
+            merged.push_back(graphs[i]);
+        }
+        if (graphs.size() % 2 == 1)
+        {
+            merged.push_back(graphs.back());
+        }
+        graphs.swap(merged);
+    }
+
+    mergedGraph->copyFrom(graphs[0]);
+}
+
 void
 FilopodiaFunctions::convertToUnsignedChar(HxUniformScalarField3* inputField)
 {
@@ -7,6 +7,7 @@
 #include <hxspatialgraph/internal/HierarchicalLabels.h>
 #include <hxfield/HxUniformScalarField3.h>
 #include <hxfield/HxUniformLabelField3.h>
+#include <mclib/McHandle.h>
 
 #include "api.h"
 
@@ -103,6 +104,9 @@ namespace FilopodiaFunctions
     HxUniformScalarField3* loadUniformScalarField3(const QString& fileName);
     HxUniformLabelField3* loadUniformLabelField3(const QString& fileName);
     HxSpatialGraph* readSpatialGraph(const QFileInfo& fileInfo);
+    std::vector<McHandle<HxSpatialGraph> > readSpatialGraphs(const QStringList& files);
+    void mergeSpatialGraphs(std::vector<McHandle<HxSpatialGraph> > graphs,
+                            HxSpatialGraph* mergedGraph);
     void convertToUnsignedChar(HxUniformScalarField3* inputField);
     void getGrowthConeNumberAndTimeFromFileName(const QString& path,
                                                 int& gc,
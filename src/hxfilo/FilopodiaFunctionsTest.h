@@ -0,0 +1,171 @@
+#include "FilopodiaFunctions.h"
+#include <hxspatialgraph/internal/HxSpatialGraph.h>
+#include <hxspatialgraph/internal/HierarchicalLabels.h>
+#include <gtest/gtest.h>
+#include <mclib/McException.h>
+#include <qdebug.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const char* regionAttributeName = "Region";
+const char* kindAttributeName = "Kind";
+const char* valueAttributeName = "Value";
+
+// Adds a label group with a random subset of the label names, in random order,
+// each label either on top level or as child of a label added before. The
+// returned ids are those of the added labels.
+std::vector<int>
+addRandomLabelGroup(HxSpatialGraph* graph, const char* attributeName, const bool isEdgeGroup, std::mt19937& generator)
+{
+    const char* names[5] = { "A", "B", "C", "D", "E" };
+    std::vector<int> order = { 0, 1, 2, 3, 4 };
+    std::shuffle(order.begin(), order.end(), generator);
+    const int numLabels = std::uniform_int_distribution<int>(1, 5)(generator);
+
+    HierarchicalLabels* labels = graph->addNewLabelGroup(attributeName, isEdgeGroup, !isEdgeGroup, false);
+    std::vector<int> ids;
+    for (int i = 0; i < numLabels; ++i)
+    {
+        const int parent = std::uniform_int_distribution<int>(-1, int(ids.size()) - 1)(generator);
+        ids.push_back(labels->addLabel(parent < 0 ? 0 : ids[parent], names[order[i]], SbColor()));
+    }
+    return ids;
+}
+
+// A small graph whose vertices and edges carry labels of label groups which
+// differ from graph to graph, and a float attribute.
+McHandle<HxSpatialGraph>
+createRandomGraph(std::mt19937& generator)
+{
+    McHandle<HxSpatialGraph> graph = HxSpatialGraph::createInstance();
+    std::uniform_real_distribution<float> coord(0.0f, 10.0f);
+
+    const int numVertices = std::uniform_int_distribution<int>(2, 6)(generator);
+    for (int v = 0; v < numVertices; ++v)
+    {
+        graph->addVertex(McVec3f(coord(generator), coord(generator), coord(generator)));
+    }
+
+    std::uniform_int_distribution<int> vertex(0, numVertices - 1);
+    const int numEdges = std::uniform_int_distribution<int>(1, 6)(generator);
+    for (int e = 0; e < numEdges; ++e)
+    {
+        const int source = vertex(generator);
+        const int target = vertex(generator);
+        std::vector<McVec3f> points;
+        points.push_back(graph->getVertexCoords(source));
+        points.push_back(McVec3f(coord(generator), coord(generator), coord(generator)));
+        points.push_back(graph->getVertexCoords(target));
+        graph->addEdge(source, target, points);
+    }
+
+    const std::vector<int> regionIds = addRandomLabelGroup(graph, regionAttributeName, false, generator);
+    const std::vector<int> kindIds = addRandomLabelGroup(graph, kindAttributeName, true, generator);
+    EdgeVertexAttribute* valueAtt = static_cast<EdgeVertexAttribute*>(
+        graph->addAttribute(valueAttributeName, HxSpatialGraph::VERTEX, McPrimType::MC_FLOAT, 1));
+
+    EdgeVertexAttribute* regionAtt = graph->findVertexAttribute(regionAttributeName);
+    std::uniform_int_distribution<int> region(0, int(regionIds.size()) - 1);
+    for (int v = 0; v < numVertices; ++v)
+    {
+        regionAtt->setIntDataAtIdx(v, regionIds[region(generator)]);
+        valueAtt->setFloatDataAtIdx(v, coord(generator));
+    }
+
+    EdgeVertexAttribute* kindAtt = graph->findEdgeAttribute(kindAttributeName);
+    std::uniform_int_distribution<int> kind(0, int(kindIds.size()) - 1);
+    for (int e = 0; e < numEdges; ++e)
+    {
+        kindAtt->setIntDataAtIdx(e, kindIds[kind(generator)]);
+    }
+
+    return graph;
+}
+
+// Compares the label hierarchies below label id of both groups: same ids, names and children.
+void
+expectSameLabels(const HierarchicalLabels* labels, const HierarchicalLabels* expectedLabels, const int id)
+{
+    McString name;
+    McString expectedName;
+    EXPECT_EQ(labels->getLabelName(id, name), expectedLabels->getLabelName(id, expectedName));
+    EXPECT_EQ(QString(name.getString()), QString(expectedName.getString()));
+
+    const McDArray<int> childIds = labels->getChildIds(id);
+    const McDArray<int> expectedChildIds = expectedLabels->getChildIds(id);
+    ASSERT_EQ(childIds.size(), expectedChildIds.size());
+    for (int i = 0; i < childIds.size(); ++i)
+    {
+        EXPECT_EQ(childIds[i], expectedChildIds[i]);
+        expectSameLabels(labels, expectedLabels, expectedChildIds[i]);
+    }
+}
+
+} // namespace
+
+// The pairwise merge has to give the same graph, label ids and attribute values
+// as merging the graphs one after the other, also if the label groups differ.
+TEST(FilopodiaFunctionsTest, MergeSpatialGraphsMatchesSequentialMerge)
+{
+    for (int numGraphs = 1; numGraphs <= 9; ++numGraphs)
+    {
+        std::mt19937 generator(numGraphs);
+        std::vector<McHandle<HxSpatialGraph> > graphs;
+        for (int i = 0; i < numGraphs; ++i)
+        {
+            graphs.push_back(createRandomGraph(generator));
+        }
+
+        McHandle<HxSpatialGraph> expected = graphs[0]->duplicate();
+        for (int i = 1; i < numGraphs; ++i)
+        {
+            McHandle<HxSpatialGraph> graph = graphs[i]->duplicate();
+            expected->merge(graph);
+        }
+
+        McHandle<HxSpatialGraph> merged = HxSpatialGraph::createInstance();
+        try
+        {
+            FilopodiaFunctions::mergeSpatialGraphs(graphs, merged);
+        }
+        catch (McException& e)
+        {
+            qDebug() << "\n Error in FilopodiaFunctionsTest MergeSpatialGraphs: \n" << e.what();
+            EXPECT_TRUE(false);
+            continue;
+        }
+
+        ASSERT_EQ(merged->getNumVertices(), expected->getNumVertices());
+        ASSERT_EQ(merged->getNumEdges(), expected->getNumEdges());
+        ASSERT_EQ(merged->getTotalNumEdgePoints(), expected->getTotalNumEdgePoints());
+
+        expectSameLabels(merged->getLabelGroup(regionAttributeName), expected->getLabelGroup(regionAttributeName), 0);
+        expectSameLabels(merged->getLabelGroup(kindAttributeName), expected->getLabelGroup(kindAttributeName), 0);
+
+        const EdgeVertexAttribute* regionAtt = merged->findVertexAttribute(regionAttributeName);
+        const EdgeVertexAttribute* expectedRegionAtt = expected->findVertexAttribute(regionAttributeName);
+        const EdgeVertexAttribute* valueAtt = merged->findVertexAttribute(valueAttributeName);
+        const EdgeVertexAttribute* expectedValueAtt = expected->findVertexAttribute(valueAttributeName);
+        for (int v = 0; v < merged->getNumVertices(); ++v)
+        {
+            EXPECT_EQ(merged->getVertexCoords(v), expected->getVertexCoords(v));
+            EXPECT_EQ(regionAtt->getIntDataAtIdx(v), expectedRegionAtt->getIntDataAtIdx(v));
+            EXPECT_EQ(valueAtt->getFloatDataAtIdx(v), expectedValueAtt->getFloatDataAtIdx(v));
+        }
+
+        const EdgeVertexAttribute* kindAtt = merged->findEdgeAttribute(kindAttributeName);
+        const EdgeVertexAttribute* expectedKindAtt = expected->findEdgeAttribute(kindAttributeName);
+        for (int e = 0; e < merged->getNumEdges(); ++e)
+        {
+            EXPECT_EQ(merged->getEdgeSource(e), expected->getEdgeSource(e));
+            EXPECT_EQ(merged->getEdgeTarget(e), expected->getEdgeTarget(e));
+            EXPECT_EQ(merged->getEdgePoints(e), expected->getEdgePoints(e));
+            EXPECT_EQ(kindAtt->getIntDataAtIdx(e), expectedKindAtt->getIntDataAtIdx(e));
+        }
+    }
+}
@@ -1,9 +1,15 @@
 #include "HxAdjustWindowLevelOfAmiraMesh.h"
 #include "FilopodiaFunctions.h"
+#include "ParallelFor.h"
 #include <mclib/McException.h>
 #include <hxcore/HxResource.h>
 #include <hxcore/HxFileFormat.h>
 #include <hxcore/HxObjectPool.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <vector>
 
 
 HX_INIT_CLASS(HxAdjustWindowLevelOfAmiraMesh, HxCompModule);
@@ -25,6 +31,9 @@ HxAdjustWindowLevelOfAmiraMesh::HxAdjustWindowLevelOfAmiraMesh()
 
 HxAdjustWindowLevelOfAmiraMesh::~HxAdjustWindowLevelOfAmiraMesh(){}
 
+namespace
+{
+
 McHandle<HxUniformScalarField3>
 loadSingleAmFile(QString fileName)
 {
@@ -59,6 +68,214 @@ loadSingleAmFile(QString fileName)
     return imageField;
 }
 
+// AmiraMesh files written by Avizo start with "# Avizo" instead of "# AmiraMesh".
+bool
+isAmiraMeshHeader(const QByteArray& header)
+{
+    return header.startsWith("# AmiraMesh") || header.startsWith("# Avizo");
+}
+
+// Returns the AmiraMesh header of the file, i.e. everything up to and including
+// the line "# Data section follows". Returns an empty array if no such line is found.
+QByteArray
+readAmiraMeshHeader(QFile& file)
+{
+    const QByteArray dataSectionLine("\n# Data section follows");
+    const qint64 maxHeaderSize = 1024 * 1024;
+
+    QByteArray header;
+    while (header.size() < maxHeaderSize && !file.atEnd())
+    {
+        const QByteArray chunk = file.read(64 * 1024);
+        if (chunk.isEmpty())
+            break;
+
+        const int searchFrom = std::max(0, header.size() - dataSectionLine.size());
+        header.append(chunk);
+
+        const int pos = header.indexOf(dataSectionLine, searchFrom);
+        if (pos >= 0)
+        {
+            const int lineEnd = header.indexOf('\n', pos + dataSectionLine.size());
+            if (lineEnd >= 0)
+            {
+                header.truncate(lineEnd + 1);
+                return header;
+            }
+        }
+    }
+
+    return QByteArray();
+}
+
+// Sets the DataWindow entry in the Parameters block of an AmiraMesh header.
+// The entry is replaced if it exists, otherwise it is added as the first entry
+// of the block. Returns false if the header has no top level Parameters block.
+bool
+setDataWindowInAmiraMeshHeader(QByteArray& header, const float dataWindowMin, const float dataWindowMax)
+{
+    const QByteArray value = QString("%1 %2").arg(dataWindowMin).arg(dataWindowMax).toLatin1();
+
+    int blockStart = -1;
+    if (header.startsWith("Parameters"))
+        blockStart = 0;
+    else
+    {
+        const int pos = header.indexOf("\nParameters");
+        if (pos >= 0)
+            blockStart = pos + 1;
+    }
+    if (blockStart < 0)
+        return false;
+
+    const int blockOpen = header.indexOf('{', blockStart);
+    if (blockOpen < 0 || !header.mid(blockStart + 10, blockOpen - blockStart - 10).trimmed().isEmpty())
+        return false;
+
+    // Scan the block for a DataWindow entry on nesting level 1, skipping
+    // nested bundles and quoted strings.
+    int depth = 1;
+    bool inString = false;
+    bool atLineStart = false;
+    bool hasEntries = false;
+    int blockClose = -1;
+    for (int i = blockOpen + 1; i < header.size() && blockClose < 0; ++i)
+    {
+        const char c = header.at(i);
+        if (inString)
+        {
+            if (c == '\\')
+                ++i;
+            else if (c == '"')
+                inString = false;
+            continue;
+        }
+
+        if (c == '\n')
+        {
+            atLineStart = true;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r')
+            continue;
+
+        if (atLineStart && depth == 1 && header.mid(i, 10) == "DataWindow" &&
+            (header.at(i + 10) == ' ' || header.at(i + 10) == '\t'))
+        {
+            int valueStart = i + 10;
+            while (header.at(valueStart) == ' ' || header.at(valueStart) == '\t')
+                ++valueStart;
+
+            int valueEnd = header.indexOf('\n', valueStart);
+            if (valueEnd < 0)
+                return false;
+            while (valueEnd > valueStart && (header.at(valueEnd - 1) == ',' || header.at(valueEnd - 1) == ' ' ||
+                                             header.at(valueEnd - 1) == '\t' || header.at(valueEnd - 1) == '\r'))
+                --valueEnd;
+
+            header.replace(valueStart, valueEnd - valueStart, value);
+            return true;
+        }
+        atLineStart = false;
+
+        if (c == '"')
+            inString = true;
+        else if (c == '{')
+            ++depth;
+        else if (c == '}')
+        {
+            --depth;
+            if (depth == 0)
+                blockClose = i;
+        }
+
+        if (depth > 0)
+            hasEntries = true;
+    }
+
+    if (blockClose < 0)
+        return false;
+
+    int insertPos = header.indexOf('\n', blockOpen);
+    if (insertPos < 0 || insertPos > blockClose)
+        return false;
+    ++insertPos;
+
+    QByteArray entry = "    DataWindow " + value;
+    if (hasEntries)
+        entry += ",";
+    entry += "\n";
+    header.insert(insertPos, entry);
+
+    return true;
+}
+
+// Writes a copy of the AmiraMesh file with the given data window to outputFileName.
+// Only the header is modified, the data section is copied unchanged. If input and
+// output are the same file and the header size does not change, only the header is
+// overwritten. Returns false if the file could not be patched.
+bool
+writeAmiraMeshWithDataWindow(const QString& inputFileName, const QString& outputFileName,
+                             const float dataWindowMin, const float dataWindowMax)
+{
+    QFile input(inputFileName);
+    if (!input.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray header = readAmiraMeshHeader(input);
+    if (header.isEmpty() || !isAmiraMeshHeader(header))
+        return false;
+
+    const qint64 dataOffset = header.size();
+    if (!setDataWindowInAmiraMeshHeader(header, dataWindowMin, dataWindowMax))
+        return false;
+
+    const bool sameFile = QFileInfo(inputFileName).canonicalFilePath() == QFileInfo(outputFileName).canonicalFilePath();
+    if (sameFile && header.size() == dataOffset)
+    {
+        input.close();
+        QFile output(outputFileName);
+        if (!output.open(QIODevice::ReadWrite))
+            return false;
+        return output.write(header) == header.size();
+    }
+
+    // Write to a temporary file which replaces the output file on commit,
+    // so the input is not destroyed if both are the same file.
+    QSaveFile output(outputFileName);
+    if (!output.open(QIODevice::WriteOnly))
+        return false;
+
+    if (output.write(header) != header.size() || !input.seek(dataOffset))
+    {
+        output.cancelWriting();
+        return false;
+    }
+
+    QByteArray buffer(4 * 1024 * 1024, Qt::Uninitialized);
+    while (true)
+    {
+        const qint64 n = input.read(buffer.data(), buffer.size());
+        if (n < 0)
+        {
+            output.cancelWriting();
+            return false;
+        }
+        if (n == 0)
+            break;
+        if (output.write(buffer.constData(), n) != n)
+        {
+            output.cancelWriting();
+            return false;
+        }
+    }
+
+    input.close();
+    return output.commit();
+}
+
+} // namespace
+
 McHandle<HxUniformScalarField3>
 HxAdjustWindowLevelOfAmiraMesh::getSingleFile()
 {
@@ -128,13 +345,29 @@ void HxAdjustWindowLevelOfAmiraMesh::compute(){
         if (answer == 1) return;
     }
 
-    for (int f = 0; f < files.size(); ++f)
+    // Patch the headers of all files concurrently. The data section is copied unchanged.
+    const int numFiles = files.size();
+    std::vector<char> isPatched(numFiles, 0);
+    const float dataWindowMin = windowMin;
+    const float dataWindowMax = windowMax;
+
+    ParallelFor::forEach(numFiles, [&](const int f)
+    {
+        const QString outputFile = FilopodiaFunctions::getOutputFileName(files[f], outputDir);
+        isPatched[f] = writeAmiraMeshWithDataWindow(files[f], outputFile, dataWindowMin, dataWindowMax);
+    });
+
+    // Files whose header could not be patched are loaded and written completely.
+    for (int f = 0; f < numFiles; ++f)
     {
         QString fileName = files[f];
-        McHandle<HxUniformScalarField3> image = loadSingleAmFile(fileName);
-        setWindowMinMax(image, windowMin, windowMax);
         QString outputFile = FilopodiaFunctions::getOutputFileName(fileName, outputDir);
-        image->writeAmiraMeshBinary(qPrintable(outputFile));
+        if (!isPatched[f])
+        {
+            McHandle<HxUniformScalarField3> image = loadSingleAmFile(fileName);
+            setWindowMinMax(image, windowMin, windowMax);
+            image->writeAmiraMeshBinary(qPrintable(outputFile));
+        }
         theMsg->printf(QString("Saving %1").arg(outputFile));
     }
 }
@@ -11,6 +11,9 @@
 
 /**
  * @brief The HxAdjustWindowLevelOfAmiraMesh class adjusts window level of input (.am) files.
+ * Only the DataWindow parameter in the header of each file is rewritten, the data section
+ * is copied unchanged. The files are processed in parallel. Files with a header that cannot
+ * be patched are loaded and saved completely.
 */
 class HXFILOPODIA_API HxAdjustWindowLevelOfAmiraMesh : public HxCompModule {
 
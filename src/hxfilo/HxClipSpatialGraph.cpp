@@ -5,6 +5,9 @@
 #include <mclib/McException.h>
 
 #include "ConvertVectorAndMcDArray.h"
+#include "ParallelFor.h"
+
+#include <atomic>
 
 HX_INIT_CLASS(HxClipSpatialGraph,HxCompModule)
 
@@ -19,65 +22,200 @@ HxClipSpatialGraph::~HxClipSpatialGraph()
 {
 }
 
-bool hasPointOnSurface(HxSpatialGraph* graph,
-                       FaceOctree<HxSurface>& octree,
-                       SpatialGraphPoint& pointOnSurface)
+namespace
+{
+
+// Calls function(i, octree) for all i in [0, numItems) on all cores. Each thread builds
+// its own octree of the surface, so that no query state is shared between threads.
+template <typename Function>
+void sweepInParallel(const int numItems,
+                     HxSurface* surface,
+                     Function function)
+{
+    std::atomic<int> next(0);
+    ParallelFor::runThreads(ParallelFor::getNumThreads(numItems), [&](const int) {
+        FaceOctree<HxSurface> octree;
+        octree.insertAllTriangles(surface, surface->getBoundingBox(), &surface->normals[0]);
+        for (int i = next++; i < numItems; i = next++) {
+            function(i, octree);
+        }
+    });
+}
+
+
+std::vector<std::vector<McVec3f> > getAllEdgePoints(const HxSpatialGraph* graph)
 {
-    McDArray<int> intersectedTriangles;
-    std::vector<McVec3f> intersectionPoints;
+    std::vector<std::vector<McVec3f> > edgePoints(graph->getNumEdges());
     for (int e=0; e<graph->getNumEdges(); ++e) {
-        const std::vector<McVec3f> points = graph->getEdgePoints(e);
-        for (int p=1; p<points.size()-1; ++p) {
+        edgePoints[e] = graph->getEdgePoints(e);
+    }
+    return edgePoints;
+}
+
+
+// Returns the indices of the inner points of each edge that lie on the surface.
+std::vector<std::vector<int> > findPointsOnSurface(const HxSpatialGraph* graph,
+                                                   HxSurface* surface)
+{
+    const std::vector<std::vector<McVec3f> > edgePoints = getAllEdgePoints(graph);
+    std::vector<std::vector<int> > pointsOnSurface(edgePoints.size());
+
+    sweepInParallel(edgePoints.size(), surface, [&](const int e, FaceOctree<HxSurface>& octree) {
+        McDArray<int> intersectedTriangles;
+        std::vector<McVec3f> intersectionPoints;
+        const std::vector<McVec3f>& points = edgePoints[e];
+        for (int p=1; p<int(points.size())-1; ++p) {
             if (octree.lineIntersectsFaces(points[p], points[p], intersectedTriangles, intersectionPoints)) {
-                pointOnSurface = SpatialGraphPoint(e, p);
-                return true;
+                pointsOnSurface[e].push_back(p);
             }
         }
-    }
-    return false;
+    });
+    return pointsOnSurface;
 }
 
 
-bool hasIntersection(HxSpatialGraph* graph,
-                     FaceOctree<HxSurface>& octree,
-                     SpatialGraphPoint& pointAfterIntersection,
-                     McVec3f& intersectionPoint)
+struct Intersection {
+    int pointAfterIntersection;
+    McVec3f point;
+};
+
+
+// Returns the intersections of each edge with the surface, ordered along the edge.
+// Intersections close to the first or last point of an edge (i.e. a node) are ignored.
+std::vector<std::vector<Intersection> > findIntersections(const HxSpatialGraph* graph,
+                                                          HxSurface* surface)
 {
     const float eps = 0.001f;
-    McDArray<int> intersectedTriangles;
-    std::vector<McVec3f> intersectionPoints;
+    const std::vector<std::vector<McVec3f> > edgePoints = getAllEdgePoints(graph);
+    std::vector<std::vector<Intersection> > intersections(edgePoints.size());
 
-    for (int e=0; e<graph->getNumEdges(); ++e) {
-        const std::vector<McVec3f> points = graph->getEdgePoints(e);
+    sweepInParallel(edgePoints.size(), surface, [&](const int e, FaceOctree<HxSurface>& octree) {
+        McDArray<int> intersectedTriangles;
+        std::vector<McVec3f> intersectionPoints;
+        const std::vector<McVec3f>& points = edgePoints[e];
         for (int p=1; p<points.size(); ++p) {
-            if (octree.lineIntersectsFaces(points[p-1], points[p], intersectedTriangles, intersectionPoints, true)) {
-                pointAfterIntersection = SpatialGraphPoint(e, p);
-                intersectionPoint = intersectionPoints[0];
+            intersectionPoints.clear();
+            if (!octree.lineIntersectsFaces(points[p-1], points[p], intersectedTriangles, intersectionPoints, true)) {
+                continue;
+            }
 
-                // Do not add point when intersection is close to first/last point on edge (i.e. a node)
+            std::vector<McVec3f> segmentPoints = intersectionPoints;
+            std::sort(segmentPoints.begin(), segmentPoints.end(), [&](const McVec3f& a, const McVec3f& b) {
+                return (a-points[p-1]).length() < (b-points[p-1]).length();
+            });
+
+            for (int i=0; i<segmentPoints.size(); ++i) {
+                const McVec3f& intersectionPoint = segmentPoints[i];
                 if (p==1 && (points[p-1]-intersectionPoint).length()<eps) {
-                    return false;
+                    continue;
                 }
                 if (p==points.size()-1 && (points[p]-intersectionPoint).length()<eps) {
-                    return false;
+                    continue;
+                }
+                if (!intersections[e].empty() &&
+                    intersections[e].back().pointAfterIntersection == p &&
+                    (intersections[e].back().point-intersectionPoint).length()<eps) {
+                    continue; // Same intersection with adjacent triangles
                 }
-                return true;
+                Intersection intersection;
+                intersection.pointAfterIntersection = p;
+                intersection.point = intersectionPoint;
+                intersections[e].push_back(intersection);
             }
         }
+    });
+    return intersections;
+}
+
+
+// Converts the given inner points of an edge, in ascending order, to nodes. The points
+// are converted from last to first, so that the remaining points keep their indices on
+// the part of the edge before the new node, which is one of the edges of the new node.
+// A conversion removes the edge and appends its parts, which does not change the
+// numbers of edges before it. Therefore, edges are processed in descending order.
+void convertPointsToNodes(HxSpatialGraph* graph,
+                          const int edge,
+                          const std::vector<int>& pointNums)
+{
+    std::vector<McVec3f> coords(pointNums.size());
+    for (int i=0; i<pointNums.size(); ++i) {
+        coords[i] = graph->getEdgePoint(edge, pointNums[i]);
+    }
+
+    SpatialGraphPoint point(edge, pointNums.back());
+    for (int i=int(pointNums.size())-1; i>=0; --i) {
+        SpatialGraphSelection convertSel(graph);
+        convertSel.selectPoint(point);
+        PointToVertexOperation convertOp(graph, convertSel, SpatialGraphSelection(graph));
+        convertOp.exec();
+
+        if (i == 0) {
+            break;
+        }
+
+        // Find the next point on the part before the new node, in either direction
+        const int newNode = convertOp.getNewVertexNum();
+        const int numPoints = pointNums[i]+1;
+        const int next = pointNums[i-1];
+        point = SpatialGraphPoint(-1, -1);
+        const IncidenceList incidentEdges = graph->getIncidentEdges(newNode);
+        for (int k=0; k<incidentEdges.size() && point.edgeNum<0; ++k) {
+            const int e = incidentEdges[k];
+            if (graph->getNumEdgePoints(e) != numPoints) {
+                continue;
+            }
+            if (graph->getEdgeTarget(e) == newNode && graph->getEdgePoint(e, next).equals(coords[i-1])) {
+                point = SpatialGraphPoint(e, next);
+            }
+            else if (graph->getEdgeSource(e) == newNode && graph->getEdgePoint(e, numPoints-1-next).equals(coords[i-1])) {
+                point = SpatialGraphPoint(e, numPoints-1-next);
+            }
+        }
+        if (point.edgeNum < 0) {
+            theMsg->printf("Warning: could not convert %d points to nodes", i);
+            break;
+        }
     }
-    return false;
 }
 
 
-void insertNode(HxSpatialGraph* graph,
-                const SpatialGraphPoint& pointAfterIntersection,
-                const McVec3f& intersectionPoint)
+// Inserts the intersection points into their edges and converts them to nodes.
+// Returns the number of inserted nodes.
+int insertIntersectionNodes(HxSpatialGraph* graph,
+                            const std::vector<std::vector<Intersection> >& intersections)
 {
-    std::vector<McVec3f> points(1);
-    points[0] = intersectionPoint;
+    int numInserted = 0;
+    for (int e=int(intersections.size())-1; e>=0; --e) {
+        const std::vector<Intersection>& edgeIntersections = intersections[e];
+        if (edgeIntersections.empty()) {
+            continue;
+        }
+
+        // Insert in reverse point order, so that the points before each insertion keep their indices
+        int last = edgeIntersections.size();
+        while (last > 0) {
+            const int pointNum = edgeIntersections[last-1].pointAfterIntersection;
+            int first = last-1;
+            while (first > 0 && edgeIntersections[first-1].pointAfterIntersection == pointNum) {
+                --first;
+            }
+            std::vector<McVec3f> points;
+            for (int i=first; i<last; ++i) {
+                points.push_back(edgeIntersections[i].point);
+            }
+            graph->insertEdgePoints(e, pointNum, points);
+            last = first;
+        }
 
-    graph->insertEdgePoints(pointAfterIntersection.edgeNum, pointAfterIntersection.pointNum, points);
-    FilopodiaFunctions::convertPointToNode(graph, pointAfterIntersection);
+        // Indices of the inserted points after all insertions
+        std::vector<int> pointNums(edgeIntersections.size());
+        for (int i=0; i<edgeIntersections.size(); ++i) {
+            pointNums[i] = edgeIntersections[i].pointAfterIntersection + i;
+        }
+        convertPointsToNodes(graph, e, pointNums);
+        numInserted += pointNums.size();
+    }
+    return numInserted;
 }
 
 
@@ -102,38 +240,46 @@ bool isPointInsideSurface(const McVec3f& point,
 }
 
 
-bool isSegmentInsideSurface(const HxSpatialGraph* graph,
-                            const int segmentNum,
-                            const HxSurface* surface,
-                            FaceOctree<HxSurface>& octree)
+McVec3f getSegmentTestPoint(const HxSpatialGraph* graph,
+                            const int segmentNum)
 {
     const std::vector<McVec3f> points = graph->getEdgePoints(segmentNum);
     if (points.size() == 2) {
-        const McVec3f center = (points[0] + points[1]) * 0.5f;
-        return isPointInsideSurface(center, surface, octree);
+        return (points[0] + points[1]) * 0.5f;
     }
     else {
         const int centerIdx = points.size()/2;
-        return isPointInsideSurface(points[centerIdx], surface, octree);
+        return points[centerIdx];
     }
 }
 
 
 void removeGraphInsideSurface(HxSpatialGraph* graph,
-                              const HxSurface* surface,
-                              FaceOctree<HxSurface>& octree)
+                              HxSurface* surface)
 {
-    SpatialGraphSelection insideSelection(graph);
+    // Vertex coordinates followed by one point per segment
+    const int numVertices = graph->getNumVertices();
+    std::vector<McVec3f> testPoints(numVertices + graph->getNumEdges());
+    for (int v=0; v<numVertices; ++v) {
+        testPoints[v] = graph->getVertexCoords(v);
+    }
+    for (int e=0; e<graph->getNumEdges(); ++e) {
+        testPoints[numVertices + e] = getSegmentTestPoint(graph, e);
+    }
+
+    std::vector<char> isInside(testPoints.size(), 0);
+    sweepInParallel(testPoints.size(), surface, [&](const int i, FaceOctree<HxSurface>& octree) {
+        isInside[i] = isPointInsideSurface(testPoints[i], surface, octree);
+    });
 
-    for (int v=0; v<graph->getNumVertices(); ++v) {
-        const McVec3f coords = graph->getVertexCoords(v);
-        if (isPointInsideSurface(coords, surface, octree)) {
+    SpatialGraphSelection insideSelection(graph);
+    for (int v=0; v<numVertices; ++v) {
+        if (isInside[v]) {
             insideSelection.selectVertex(v);
         }
     }
-
     for (int e=0; e<graph->getNumEdges(); ++e) {
-        if (isSegmentInsideSurface(graph, e, surface, octree)) {
+        if (isInside[numVertices + e]) {
             insideSelection.selectEdge(e);
         }
     }
@@ -148,32 +294,29 @@ void removeGraphInsideSurface(HxSpatialGraph* graph,
 void clipSpatialGraphWithSurface(HxSpatialGraph* graph, const HxSurface* surface) {
     McHandle<HxSurface> surf = dynamic_cast<HxSurface*>(surface->duplicate());
     surf->computeNormalsPerTriangle();
-    FaceOctree<HxSurface> octree;
-    octree.insertAllTriangles(surf, surf->getBoundingBox(), &surf->normals[0]);
 
     theMsg->printf("Checking points on surface ...");
-    SpatialGraphPoint pointOnSurface;
+    const std::vector<std::vector<int> > pointsOnSurface = findPointsOnSurface(graph, surf);
     int numConversions = 0;
-    while (hasPointOnSurface(graph, octree, pointOnSurface)) {
-        FilopodiaFunctions::convertPointToNode(graph, pointOnSurface);
-        ++numConversions;
+    for (int e=int(pointsOnSurface.size())-1; e>=0; --e) {
+        if (!pointsOnSurface[e].empty()) {
+            convertPointsToNodes(graph, e, pointsOnSurface[e]);
+            numConversions += pointsOnSurface[e].size();
+        }
     }
     theMsg->printf("Converted %d points on surface to nodes", numConversions);
 
     theMsg->printf("Checking intersection points ...");
-    SpatialGraphPoint pointAfterIntersection;
-    McVec3f intersectionPoint;
-    int numIntersections = 0;
-    while (hasIntersection(graph, octree, pointAfterIntersection, intersectionPoint)) {
-        insertNode(graph, pointAfterIntersection, intersectionPoint);
-        ++numIntersections;
-    }
+    const int numIntersections = insertIntersectionNodes(graph, findIntersections(graph, surf));
     theMsg->printf("Inserted %d intersection nodes", numIntersections);
 
-    removeGraphInsideSurface(graph, surface, octree);
+    removeGraphInsideSurface(graph, surf);
 }
 
 
+} // namespace
+
+
 void HxClipSpatialGraph::compute()
 {
     if (portAction.wasHit()) {
@@ -1,5 +1,6 @@
 #include "HxConvertTif2AmiraMesh.h"
 #include "FilopodiaFunctions.h"
+#include "ParallelFor.h"
 #include <QDirIterator>
 #include <hxcore/HxResource.h>
 #include <hxcore/HxObjectPool.h>
@@ -7,6 +8,12 @@
 #include <hxfield/HxField3.h>
 #include <mclib/McException.h>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <algorithm>
+#include <vector>
 
 HX_INIT_CLASS(HxConvertTif2AmiraMesh, HxCompModule);
 
@@ -83,6 +90,325 @@ loadSingleTifFile(QString fileName)
     return imageField;
 }
 
+// Layout of an uncompressed grayscale TIFF stack with one slice per page.
+struct TiffStackLayout
+{
+    bool bigEndian;
+    int width;
+    int height;
+    int bytesPerSample;
+    bool isSigned;
+    std::vector<int> rowsPerStrip;
+    std::vector<std::vector<quint32> > stripOffsets;
+};
+
+quint32
+getTiffValue(const uchar* data, const int numBytes, const bool bigEndian)
+{
+    quint32 value = 0;
+    for (int b = 0; b < numBytes; ++b)
+    {
+        const int shift = bigEndian ? 8 * (numBytes - 1 - b) : 8 * b;
+        value |= quint32(data[b]) << shift;
+    }
+    return value;
+}
+
+// Reads the values of an IFD entry of type SHORT or LONG.
+bool
+readTiffEntryValues(QFile& file, const uchar* entry, const bool bigEndian, std::vector<quint32>& values)
+{
+    const int type = getTiffValue(entry + 2, 2, bigEndian);
+    const quint32 count = getTiffValue(entry + 4, 4, bigEndian);
+    const int size = (type == 3) ? 2 : (type == 4) ? 4 : 0;
+    if (size == 0 || count == 0 || count > quint32(file.size() / size))
+        return false;
+
+    QByteArray buffer;
+    const uchar* data = entry + 8;
+    if (count * size > 4)
+    {
+        const qint64 filePos = file.pos();
+        if (!file.seek(getTiffValue(entry + 8, 4, bigEndian)))
+            return false;
+        buffer = file.read(count * size);
+        if (!file.seek(filePos) || buffer.size() != int(count * size))
+            return false;
+        data = reinterpret_cast<const uchar*>(buffer.constData());
+    }
+
+    values.resize(count);
+    for (quint32 i = 0; i < count; ++i)
+        values[i] = getTiffValue(data + i * size, size, bigEndian);
+
+    return true;
+}
+
+// Reads the page layout of a TIFF stack. Returns false if the file is not an uncompressed
+// 8 or 16 bit grayscale TIFF with strips and pages of the same size and type.
+bool
+readTiffStackLayout(QFile& file, TiffStackLayout& layout)
+{
+    const QByteArray fileHeader = file.read(8);
+    if (fileHeader.size() != 8)
+        return false;
+
+    if (fileHeader.startsWith("II"))
+        layout.bigEndian = false;
+    else if (fileHeader.startsWith("MM"))
+        layout.bigEndian = true;
+    else
+        return false;
+
+    const uchar* headerData = reinterpret_cast<const uchar*>(fileHeader.constData());
+    if (getTiffValue(headerData + 2, 2, layout.bigEndian) != 42)
+        return false;
+
+    quint32 ifdOffset = getTiffValue(headerData + 4, 4, layout.bigEndian);
+    const qint64 maxNumPages = file.size() / 12;
+
+    while (ifdOffset != 0)
+    {
+        if (qint64(layout.stripOffsets.size()) >= maxNumPages || !file.seek(ifdOffset))
+            return false;
+
+        const QByteArray countData = file.read(2);
+        if (countData.size() != 2)
+            return false;
+        const int numEntries = getTiffValue(reinterpret_cast<const uchar*>(countData.constData()), 2, layout.bigEndian);
+
+        const QByteArray entries = file.read(12 * numEntries + 4);
+        if (entries.size() != 12 * numEntries + 4)
+            return false;
+
+        int width = 0, height = 0, bitsPerSample = 1, compression = 1, photometric = -1;
+        int samplesPerPixel = 1, sampleFormat = 1;
+        quint32 rowsPerStrip = 0xFFFFFFFF;
+        std::vector<quint32> stripOffsets, stripByteCounts, values;
+
+        for (int e = 0; e < numEntries; ++e)
+        {
+            const uchar* entry = reinterpret_cast<const uchar*>(entries.constData()) + 12 * e;
+            const int tag = getTiffValue(entry, 2, layout.bigEndian);
+
+            switch (tag)
+            {
+                case 256: // ImageWidth
+                case 257: // ImageLength
+                case 258: // BitsPerSample
+                case 259: // Compression
+                case 262: // PhotometricInterpretation
+                case 277: // SamplesPerPixel
+                case 278: // RowsPerStrip
+                case 339: // SampleFormat
+                    if (!readTiffEntryValues(file, entry, layout.bigEndian, values))
+                        return false;
+                    if (tag == 256) width = values[0];
+                    if (tag == 257) height = values[0];
+                    if (tag == 258) bitsPerSample = values[0];
+                    if (tag == 259) compression = values[0];
+                    if (tag == 262) photometric = values[0];
+                    if (tag == 277) samplesPerPixel = values[0];
+                    if (tag == 278) rowsPerStrip = values[0];
+                    if (tag == 339) sampleFormat = values[0];
+                    break;
+                case 273: // StripOffsets
+                    if (!readTiffEntryValues(file, entry, layout.bigEndian, stripOffsets))
+                        return false;
+                    break;
+                case 279: // StripByteCounts
+                    if (!readTiffEntryValues(file, entry, layout.bigEndian, stripByteCounts))
+                        return false;
+                    break;
+                case 322: // TileWidth
+                    return false;
+            }
+        }
+
+        if (width <= 0 || height <= 0 || compression != 1 || photometric != 1 || samplesPerPixel != 1)
+            return false;
+        if (!(bitsPerSample == 8 && sampleFormat == 1) && !(bitsPerSample == 16 && (sampleFormat == 1 || sampleFormat == 2)))
+            return false;
+
+        rowsPerStrip = std::min(rowsPerStrip, quint32(height));
+        const int numStrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+        const int bytesPerSample = bitsPerSample / 8;
+        if (int(stripOffsets.size()) != numStrips || int(stripByteCounts.size()) != numStrips)
+            return false;
+
+        for (int s = 0; s < numStrips; ++s)
+        {
+            const int numRows = std::min(int(rowsPerStrip), height - s * int(rowsPerStrip));
+            if (stripByteCounts[s] < quint32(numRows) * width * bytesPerSample ||
+                qint64(stripOffsets[s]) + qint64(numRows) * width * bytesPerSample > file.size())
+                return false;
+        }
+
+        if (layout.stripOffsets.empty())
+        {
+            layout.width = width;
+            layout.height = height;
+            layout.bytesPerSample = bytesPerSample;
+            layout.isSigned = (sampleFormat == 2);
+        }
+        else if (width != layout.width || height != layout.height || bytesPerSample != layout.bytesPerSample ||
+                 (sampleFormat == 2) != layout.isSigned)
+        {
+            return false;
+        }
+
+        layout.rowsPerStrip.push_back(rowsPerStrip);
+        layout.stripOffsets.push_back(stripOffsets);
+
+        ifdOffset = getTiffValue(reinterpret_cast<const uchar*>(entries.constData()) + 12 * numEntries, 4, layout.bigEndian);
+    }
+
+    return !layout.stripOffsets.empty();
+}
+
+// Reads one page of the TIFF stack into slice, in the row order and byte order of an
+// AmiraMesh lattice, i.e. the top row of the image is the last row of the slice.
+bool
+readTiffPage(QFile& file, const TiffStackLayout& layout, const int page, char* slice)
+{
+    const int rowSize = layout.width * layout.bytesPerSample;
+    const int rowsPerStrip = layout.rowsPerStrip[page];
+    const std::vector<quint32>& stripOffsets = layout.stripOffsets[page];
+
+    for (int s = 0; s < int(stripOffsets.size()); ++s)
+    {
+        if (!file.seek(stripOffsets[s]))
+            return false;
+
+        const int firstRow = s * rowsPerStrip;
+        const int numRows = std::min(rowsPerStrip, layout.height - firstRow);
+        for (int r = firstRow; r < firstRow + numRows; ++r)
+        {
+            char* row = slice + qint64(layout.height - 1 - r) * rowSize;
+            if (file.read(row, rowSize) != rowSize)
+                return false;
+        }
+    }
+
+    if (layout.bigEndian && layout.bytesPerSample == 2)
+    {
+        const qint64 numSamples = qint64(layout.width) * layout.height;
+        for (qint64 i = 0; i < numSamples; ++i)
+            std::swap(slice[2 * i], slice[2 * i + 1]);
+    }
+
+    return true;
+}
+
+// Returns a key that is equal for TIFF stacks with the same sample type, byte order
+// and dimensions, or an empty string if the file cannot be converted directly.
+QString
+getTiffLayoutKey(const QString& fileName)
+{
+    QFile file(fileName);
+    TiffStackLayout layout;
+    if (!file.open(QIODevice::ReadOnly) || !readTiffStackLayout(file, layout))
+        return QString();
+
+    return QString("%1 %2 %3 %4x%5x%6")
+        .arg(layout.bytesPerSample)
+        .arg(int(layout.isSigned))
+        .arg(int(layout.bigEndian))
+        .arg(layout.width)
+        .arg(layout.height)
+        .arg(int(layout.stripOffsets.size()));
+}
+
+QByteArray
+getAmiraMeshHeader(const TiffStackLayout& layout, const McVec3f& voxelSize,
+                   const bool setDataWindow, const float dataWindowMin, const float dataWindowMax)
+{
+    const int nz = layout.stripOffsets.size();
+    const QString type = (layout.bytesPerSample == 1) ? "byte" : (layout.isSigned ? "short" : "ushort");
+    const float bboxMax[3] = { float(layout.width - 1) * voxelSize[0],
+                               float(layout.height - 1) * voxelSize[1],
+                               float(nz - 1) * voxelSize[2] };
+
+    QString header("# AmiraMesh BINARY-LITTLE-ENDIAN 2.1\n\n\n");
+    header += QString("define Lattice %1 %2 %3\n\n").arg(layout.width).arg(layout.height).arg(nz);
+    header += "Parameters {\n";
+    if (setDataWindow)
+        header += QString("    DataWindow %1 %2,\n").arg(dataWindowMin).arg(dataWindowMax);
+    header += QString("    Content \"%1x%2x%3 %4, uniform coordinates\",\n").arg(layout.width).arg(layout.height).arg(nz).arg(type);
+    header += QString("    BoundingBox 0 %1 0 %2 0 %3,\n").arg(bboxMax[0]).arg(bboxMax[1]).arg(bboxMax[2]);
+    header += "    CoordType \"uniform\"\n";
+    header += "}\n\n";
+    header += QString("Lattice { %1 Data } @1\n\n").arg(type);
+    header += "# Data section follows\n@1\n";
+
+    return header.toLatin1();
+}
+
+// Converts a TIFF stack to an AmiraMesh file without loading it into the object pool.
+// The volume is written slice by slice, so only one slice is held in memory.
+// Returns false if the TIFF file is not supported or cannot be converted.
+bool
+convertTifToAmiraMesh(const QString& inputFileName, const QString& outputFileName, const McVec3f& voxelSize,
+                      const bool setDataWindow, const float dataWindowMin, const float dataWindowMax)
+{
+    QFile input(inputFileName);
+    if (!input.open(QIODevice::ReadOnly))
+        return false;
+
+    TiffStackLayout layout;
+    if (!readTiffStackLayout(input, layout))
+        return false;
+
+    QSaveFile output(outputFileName);
+    if (!output.open(QIODevice::WriteOnly))
+        return false;
+
+    const QByteArray header = getAmiraMeshHeader(layout, voxelSize, setDataWindow, dataWindowMin, dataWindowMax);
+    if (output.write(header) != header.size())
+    {
+        output.cancelWriting();
+        return false;
+    }
+
+    const qint64 sliceSize = qint64(layout.width) * layout.height * layout.bytesPerSample;
+    std::vector<char> slice(sliceSize);
+    for (int z = 0; z < int(layout.stripOffsets.size()); ++z)
+    {
+        if (!readTiffPage(input, layout, z, &slice[0]) || output.write(&slice[0], sliceSize) != sliceSize)
+        {
+            output.cancelWriting();
+            return false;
+        }
+    }
+
+    if (output.write("\n", 1) != 1)
+    {
+        output.cancelWriting();
+        return false;
+    }
+
+    return output.commit();
+}
+
+bool
+haveSameContents(const QString& fileName1, const QString& fileName2)
+{
+    QFile file1(fileName1);
+    QFile file2(fileName2);
+    if (!file1.open(QIODevice::ReadOnly) || !file2.open(QIODevice::ReadOnly) || file1.size() != file2.size())
+        return false;
+
+    while (!file1.atEnd())
+    {
+        const QByteArray data1 = file1.read(4 * 1024 * 1024);
+        const QByteArray data2 = file2.read(4 * 1024 * 1024);
+        if (data1.isEmpty() || data1 != data2)
+            return false;
+    }
+
+    return true;
+}
+
 McHandle<HxUniformScalarField3>
 setVoxelSize(McHandle<HxUniformScalarField3> image, const McVec3f voxelSize)
 {
@@ -132,6 +458,16 @@ HxConvertTif2AmiraMesh::setWindowMinMax(HxUniformScalarField3* image, float& dat
     image->setDataWindow(dataWindowMin, dataWindowMax);
 }
 
+void
+HxConvertTif2AmiraMesh::convertSingleFile(const QString& fileName, const QString& outputFile, const McVec3f& voxelSize)
+{
+    McHandle<HxUniformScalarField3> image = loadSingleTifFile(fileName);
+    image = setVoxelSize(image, voxelSize);
+    if (adjustWindowSize.getValue())
+        setWindowMinMax(image, windowMin, windowMax);
+    image->writeAmiraMeshBinary(qPrintable(outputFile));
+}
+
 void
 HxConvertTif2AmiraMesh::compute()
 {
@@ -185,17 +521,87 @@ HxConvertTif2AmiraMesh::compute()
         }
     }
 
-    for (int f = 0; f < files.size(); ++f)
+    QElapsedTimer timer;
+    timer.start();
+
+    const int numFiles = files.size();
+    const bool setDataWindow = adjustWindowSize.getValue();
+    const float dataWindowMin = windowMin;
+    const float dataWindowMax = windowMax;
+
+    // The direct conversion is validated once for each TIFF layout with several files: the first
+    // file of a layout is converted directly and with the standard reader. The other files of the
+    // layout are converted directly in parallel, if this reproduces the output of the standard reader.
+    std::vector<QString> layoutKeys(numFiles);
+    ParallelFor::forEach(numFiles, [&](const int f)
+    {
+        layoutKeys[f] = getTiffLayoutKey(files.at(f));
+    });
+
+    QHash<QString, int> numFilesPerLayout;
+    for (int f = 0; f < numFiles; ++f)
+        ++numFilesPerLayout[layoutKeys[f]];
+
+    std::vector<char> isConverted(numFiles, 0);
+    QHash<QString, bool> isValidLayout;
+    for (int f = 0; f < numFiles; ++f)
+    {
+        if (layoutKeys[f].isEmpty() || numFilesPerLayout[layoutKeys[f]] < 2 || isValidLayout.contains(layoutKeys[f]))
+            continue;
+
+        const QString outputFile = FilopodiaFunctions::getOutputFileName(files[f], outputDir);
+        const QString standardFile = outputFile + ".standard";
+        convertSingleFile(files[f], standardFile, voxelSize);
+
+        const bool isValid = convertTifToAmiraMesh(files[f], outputFile, voxelSize, setDataWindow, dataWindowMin, dataWindowMax) &&
+                             haveSameContents(outputFile, standardFile);
+        if (isValid)
+        {
+            QFile::remove(standardFile);
+        }
+        else
+        {
+            theMsg->printf(QString("Files like %1 are converted with the standard reader").arg(files[f]));
+            QFile::remove(outputFile);
+            if (!QFile::rename(standardFile, outputFile))
+                throw McException(QString("Could not write %1").arg(outputFile));
+        }
+
+        isValidLayout.insert(layoutKeys[f], isValid);
+        isConverted[f] = 1;
+    }
+
+    std::vector<char> useDirectConversion(numFiles, 0);
+    for (int f = 0; f < numFiles; ++f)
+        useDirectConversion[f] = !isConverted[f] && isValidLayout.value(layoutKeys[f], false);
+
+    ParallelFor::forEach(numFiles, [&](const int f)
+    {
+        if (!useDirectConversion[f])
+            return;
+        const QString outputFile = FilopodiaFunctions::getOutputFileName(files.at(f), outputDir);
+        isConverted[f] = convertTifToAmiraMesh(files.at(f), outputFile, voxelSize, setDataWindow, dataWindowMin, dataWindowMax);
+    });
+
+    // Files that could not be read directly are loaded with the standard reader.
+    qint64 numBytes = 0;
+    for (int f = 0; f < numFiles; ++f)
     {
         QString fileName = files[f];
-        McHandle<HxUniformScalarField3> image = loadSingleTifFile(fileName);
-        image = setVoxelSize(image, voxelSize);
-        if (adjustWindowSize.getValue())
-            setWindowMinMax(image, windowMin, windowMax);
         QString outputFile = FilopodiaFunctions::getOutputFileName(fileName, outputDir);
-        image->writeAmiraMeshBinary(qPrintable(outputFile));
+        if (!isConverted[f])
+            convertSingleFile(fileName, outputFile, voxelSize);
+        numBytes += QFileInfo(outputFile).size();
         theMsg->printf(QString("Saving %1").arg(outputFile));
     }
+
+    const double seconds = std::max(timer.elapsed(), qint64(1)) / 1000.0;
+    const double megaBytes = numBytes / (1024.0 * 1024.0);
+    theMsg->printf(QString("Converted %1 files (%2 MB) in %3 s, %4 MB/s")
+                       .arg(numFiles)
+                       .arg(megaBytes, 0, 'f', 1)
+                       .arg(seconds, 0, 'f', 1)
+                       .arg(megaBytes / seconds, 0, 'f', 1));
 }
 
 void
@@ -14,6 +14,9 @@
     @brief The HxConvertTif2AmiraMesh class creates an object in the object pool that is used
            to convert .tif files to .am files that can be processed in Amira. Module also
            includes functionality of adjusting window lavel of the images you want to convert.
+           Uncompressed grayscale tif stacks are read directly, page by page, and several files
+           are converted in parallel. The first file is always converted with the standard reader
+           and the direct conversion is only used if it reproduces this file exactly.
 */
 
 class HXFILOPODIA_API HxConvertTif2AmiraMesh : public HxCompModule
@@ -43,6 +46,9 @@ private:
     bool isInputDirectoryValid();
 
     McHandle<HxUniformScalarField3> getSingleFile();
+
+    // Function converts a file with the standard reader, which loads it into the object pool
+    void convertSingleFile(const QString& fileName, const QString& outputFile, const McVec3f& voxelSize);
 };
 
 #endif
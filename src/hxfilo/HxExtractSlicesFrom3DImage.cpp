@@ -1,48 +1,232 @@
 #include "HxExtractSlicesFrom3DImage.h"
+#include "ParallelFor.h"
 #include <hxcore/HxObjectPool.h>
 #include <hxfield/HxUniformScalarField3.h>
 #include <hxcore/HxProgressInterface.h>
 #include <hxcore/HxMessage.h>
-#include <vector>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QSaveFile>
+#include <cstring>
+#include <vector>
 
 HX_INIT_CLASS(HxExtractSlicesFrom3DImage, HxCompModule);
 
 HxExtractSlicesFrom3DImage::HxExtractSlicesFrom3DImage()
     : HxCompModule(HxUniformScalarField3::getClassTypeId())
     , z_step(this, "Z_step", tr("Slice step:"))
+    , portFromFile(this, "FromFile", tr("Stream from file"))
+    , portInputFile(this, "InputFile", tr("Input File"), HxPortFilename::ANY_FILE)
+    , portOutputDir(this, "OutputDirectory", tr("Output Directory"), HxPortFilename::SAVE_DIRECTORY)
     , portAction(this, "action", tr("Action"))
 {
     z_step.setValue(0,3);
+    portFromFile.setValue(false);
+    portInputFile.setValue("Please select");
+    portOutputDir.setValue("Please select");
+    portInputFile.hide();
+    portOutputDir.hide();
 }
 
 HxExtractSlicesFrom3DImage::~HxExtractSlicesFrom3DImage(){}
 
-template <typename T>
-void sliceData(T* inputData, T* outputData, McDim3l dims, int s, int step){
-    int i = 0;
-    for(int z = 0; z < dims.nz; z++){
-        if((z+s)%step != 0) continue;
-        for(int y = 0; y < dims.ny; y++){
-            for(int x = 0; x < dims.nx; x++){
-                auto idx = x + y*dims.nx + z*dims.nx*dims.ny;
-                outputData[i] = inputData[idx];
-                i++;
-            }
+void HxExtractSlicesFrom3DImage::update(){
+    if (portFromFile.isNew()){
+        portInputFile.setVisible(portFromFile.getValue());
+        portOutputDir.setVisible(portFromFile.getValue());
+    }
+}
+
+namespace
+{
+
+// Returns the channel of slice z, i.e. channel s gets the slices with (z+s)%step == 0.
+int getChannelOfSlice(const int z, const int step){
+    return (step - z%step)%step;
+}
+
+// Copies each xy-plane of the input as a whole to its channel, in parallel over the slices.
+void splitSlices(const char* inputData, const std::vector<char*>& outputData, const McDim3l& dims, const int step, const size_t valueSize){
+    const size_t sliceSize = size_t(dims.nx)*dims.ny*valueSize;
+    const int numSlices = int(dims.nz);
+
+    ParallelFor::forEach(numSlices, [&](const int z){
+        char* outputSlice = outputData[getChannelOfSlice(z, step)] + size_t(z/step)*sliceSize;
+        memcpy(outputSlice, inputData + size_t(z)*sliceSize, sliceSize);
+    });
+}
+
+// Layout of a binary AmiraMesh file with one uncompressed data section.
+struct AmiraMeshLayout {
+    QByteArray header; // Up to and including the data section marker line
+    McDim3l dims;
+    int valueSize;
+};
+
+// Reads the header of an AmiraMesh file. Returns false if the data cannot be streamed,
+// e.g. for ASCII, big endian or compressed files or files with several data sections.
+bool readAmiraMeshLayout(QFile& file, AmiraMeshLayout& layout){
+    const qint64 maxHeaderSize = 1024*1024;
+    layout.header.clear();
+    while (!file.atEnd() && layout.header.size() < maxHeaderSize){
+        const QByteArray line = file.readLine();
+        layout.header += line;
+        if (line.startsWith("# Data section follows"))
+            break;
+    }
+    // Files written by Avizo start with "# Avizo" instead of "# AmiraMesh".
+    const QByteArray firstLine = layout.header.left(layout.header.indexOf('\n'));
+    const bool isAmiraMesh = firstLine.startsWith("# AmiraMesh ") || firstLine.startsWith("# Avizo ");
+    if (!isAmiraMesh || !firstLine.contains(" BINARY-LITTLE-ENDIAN") || !layout.header.contains("# Data section follows"))
+        return false;
+
+    const QString header = QString::fromLatin1(layout.header);
+    QRegExp latticeDef("define Lattice\\s+(\\d+)\\s+(\\d+)\\s+(\\d+)");
+    if (latticeDef.indexIn(header) < 0)
+        return false;
+    layout.dims = McDim3l(latticeDef.cap(1).toLongLong(), latticeDef.cap(2).toLongLong(), latticeDef.cap(3).toLongLong());
+
+    QRegExp dataDef("\\n\\s*Lattice\\s*\\{\\s*(\\w+)\\s+\\w+\\s*\\}\\s*(@\\d+)\\s*\\n");
+    if (dataDef.indexIn(header) < 0 || header.count(QRegExp("\\}\\s*@\\d+")) != 1)
+        return false;
+
+    const QString type = dataDef.cap(1);
+    if (type == "byte") layout.valueSize = 1;
+    else if (type == "short" || type == "ushort") layout.valueSize = 2;
+    else if (type == "int" || type == "float") layout.valueSize = 4;
+    else if (type == "double") layout.valueSize = 8;
+    else return false;
+
+    const QByteArray marker = file.readLine();
+    if (marker.trimmed() != dataDef.cap(2).toLatin1())
+        return false;
+    layout.header += marker;
+
+    const qint64 dataSize = layout.dims.nbVoxel()*layout.valueSize;
+    return file.size() - file.pos() >= dataSize;
+}
+
+// Returns the header of a channel with nz/step slices. Other parameters of the input are kept.
+QByteArray getChannelHeader(const AmiraMeshLayout& layout, const int step){
+    QString header = QString::fromLatin1(layout.header);
+    const qint64 nz = layout.dims.nz/step;
+
+    QRegExp latticeDef("define Lattice\\s+(\\d+)\\s+(\\d+)\\s+(\\d+)");
+    latticeDef.indexIn(header);
+    header.replace(latticeDef.pos(0), latticeDef.matchedLength(),
+                   QString("define Lattice %1 %2 %3").arg(latticeDef.cap(1)).arg(latticeDef.cap(2)).arg(nz));
+
+    QRegExp content("Content \"(\\d+)x(\\d+)x(\\d+)");
+    if (content.indexIn(header) >= 0)
+        header.replace(content.pos(0), content.matchedLength(),
+                       QString("Content \"%1x%2x%3").arg(content.cap(1)).arg(content.cap(2)).arg(nz));
+
+    // Same bounding box as for fields in memory
+    QRegExp bbox("BoundingBox\\s+(\\S+)\\s+(\\S+)\\s+(\\S+)\\s+(\\S+)\\s+(\\S+)\\s+([^,\\s]+)");
+    if (bbox.indexIn(header) >= 0){
+        const float z1 = bbox.cap(5).toFloat();
+        const float z2 = bbox.cap(6).toFloat();
+        const float z_new = (z2-z1+1)/step+z1-1;
+        header.replace(bbox.pos(0), bbox.matchedLength(),
+                       QString("BoundingBox %1 %2 %3 %4 %5 %6").arg(bbox.cap(1)).arg(bbox.cap(2)).arg(bbox.cap(3))
+                       .arg(bbox.cap(4)).arg(bbox.cap(5)).arg(z_new));
+    }
+
+    return header.toLatin1();
+}
+
+} // namespace
+
+// Splits an AmiraMesh file into one file per channel without loading it. The slices are
+// read in order and appended to the file of their channel, so only step slices are held
+// in memory and stacks larger than the main memory can be split.
+void HxExtractSlicesFrom3DImage::splitFile(const int step){
+    const QString inputFileName = portInputFile.getFilename();
+    const QString outputDir = portOutputDir.getFilename();
+    if (!QFileInfo(inputFileName).isFile()){
+        theMsg->warning(QString("Please select an input file."));
+        return;
+    }
+    if (!QDir(outputDir).exists()){
+        theMsg->warning(QString("Please select an existing output directory."));
+        return;
+    }
+
+    QFile input(inputFileName);
+    AmiraMeshLayout layout;
+    if (!input.open(QIODevice::ReadOnly) || !readAmiraMeshLayout(input, layout)){
+        theMsg->warning(QString("%1 is not an uncompressed binary little endian AmiraMesh file with a single data section.").arg(inputFileName));
+        return;
+    }
+    if (layout.dims.nz%step != 0){
+        theMsg->warning(QString("Number of slices in z is not divisible by step number."));
+        return;
+    }
+
+    theProgress->startWorkingNoStop("Splitting file...");
+
+    const QByteArray header = getChannelHeader(layout, step);
+    const QString baseName = QDir(outputDir).filePath(QFileInfo(inputFileName).baseName());
+    std::vector<QSaveFile*> outputs(step);
+    bool ok = true;
+    for (int i = 0; i < step; i++){
+        outputs[i] = new QSaveFile(baseName + "_CH" + QString::number(i+1) + ".am");
+        ok = ok && outputs[i]->open(QIODevice::WriteOnly) && outputs[i]->write(header) == header.size();
+    }
+
+    const qint64 sliceSize = qint64(layout.dims.nx)*layout.dims.ny*layout.valueSize;
+    std::vector<char> slices(step*sliceSize);
+    for (int z0 = 0; ok && z0 < layout.dims.nz; z0 += step){
+        ok = input.read(&slices[0], step*sliceSize) == step*sliceSize;
+        for (int z = z0; ok && z < z0+step; z++){
+            ok = outputs[getChannelOfSlice(z, step)]->write(&slices[(z-z0)*sliceSize], sliceSize) == sliceSize;
         }
     }
+
+    for (int i = 0; i < step; i++){
+        if (ok){
+            ok = outputs[i]->write("\n", 1) == 1 && outputs[i]->commit();
+        }
+        else {
+            outputs[i]->cancelWriting();
+        }
+        delete outputs[i];
+    }
+
+    theProgress->stopWorking();
+
+    if (!ok){
+        theMsg->warning(QString("Could not split %1.").arg(inputFileName));
+        return;
+    }
+    theMsg->printf("Split %s into %d files in %s", qPrintable(inputFileName), step, qPrintable(outputDir));
 }
 
 void HxExtractSlicesFrom3DImage::compute()
 {
     if (!portAction.wasHit()) return;
 
+    int step = z_step.getValue();
+
+    if (step < 1)
+    {
+        theMsg->warning(QString("Slice step must be at least 1."));
+        return;
+    }
+
+    if (portFromFile.getValue())
+    {
+        splitFile(step);
+        return;
+    }
+
     HxUniformScalarField3* inputField = hxconnection_cast<HxUniformScalarField3>(portData);
 
     if (inputField == nullptr) return;
 
-    int step = z_step.getValue();
-
     const McDim3l dims = inputField->lattice().getDims();
     const McDim3l dims_new(dims.nx, dims.ny, dims.nz/step);
 
@@ -74,117 +258,22 @@ void HxExtractSlicesFrom3DImage::compute()
     z_new = (z2-z1+1)/step+z1-1;
     bbox.setValue(x1, x2, y1, y2, z1, z_new);
 
-    void* inputData;
-    std::vector<void*> outputData(step);
-
-    inputData = inputField->lattice().dataPtr();
+    const char* inputData = static_cast<const char*>(inputField->lattice().dataPtr());
+    std::vector<char*> outputData(step);
 
     for (int i = 0; i< step; i++){
         out[i]->lattice().setBoundingBox(bbox);
-        outputData[i] = out[i]->lattice().dataPtr();
+        outputData[i] = static_cast<char*>(out[i]->lattice().dataPtr());
     }
 
-    auto dataType = inputField->lattice().primType();
-
-    switch(dataType){
-        case McPrimType::Type::MC_UNKNOWN:
-        {
-            theMsg->warning(QString("Unknow type of input data."));
-            theProgress->stopWorking();
-            return;
-        }
-        case McPrimType::Type::MC_UINT8:
-        {
-            mcuint8* inputDataCasted = static_cast<mcuint8*>(inputData);
-            std::vector<mcuint8*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcuint8*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
-        case McPrimType::Type::MC_INT16:
-        {
-            mcint16* inputDataCasted = static_cast<mcint16*>(inputData);
-            std::vector<mcint16*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcint16*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
-        case McPrimType::Type::MC_INT32:
-        {
-            mcint32* inputDataCasted = static_cast<mcint32*>(inputData);
-            std::vector<mcint32*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcint32*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
-        case McPrimType::Type::MC_FLOAT:
-        {
-            float* inputDataCasted = static_cast<float*>(inputData);
-            std::vector<float*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<float*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
-        case McPrimType::Type::MC_STRING:
-        {
-            mcstring* inputDataCasted = static_cast<mcstring*>(inputData);
-            std::vector<mcstring*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcstring*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-            }
-        case McPrimType::Type::MC_UINT16:
-        {
-            mcuint16* inputDataCasted = static_cast<mcuint16*>(inputData);
-            std::vector<mcuint16*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcuint16*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
-        case McPrimType::Type::MC_UINT32:
-        {
-            mcuint32* inputDataCasted = static_cast<mcuint32*>(inputData);
-            std::vector<mcuint32*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcuint32*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
-        case McPrimType::Type::MC_INT64:
-        {
-            mcint64* inputDataCasted = static_cast<mcint64*>(inputData);
-            std::vector<mcint64*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcint64*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
-        case McPrimType::Type::MC_UINT64:
-        {
-            mcuint64* inputDataCasted = static_cast<mcuint64*>(inputData);
-            std::vector<mcuint64*> outputDataCasted(step);
-            for (int i = 0; i < step; i++){
-                outputDataCasted[i] = static_cast<mcuint64*>(outputData[i]);
-                sliceData(inputDataCasted, outputDataCasted[i], dims, i, step);
-            }
-            break;
-        }
+    if (inputField->lattice().primType() == McPrimType::Type::MC_UNKNOWN){
+        theMsg->warning(QString("Unknow type of input data."));
+        theProgress->stopWorking();
+        return;
     }
 
+    splitSlices(inputData, outputData, dims, step, inputField->lattice().primType().size());
+
     QStringList oldName = inputField->getLabel().split(".");
     for (int i = 0; i < step; i++){
         out[i]->setLabel(oldName[0] + "_CH" + QString::number(i+1) + "." + oldName[1]);
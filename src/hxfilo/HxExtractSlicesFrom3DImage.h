@@ -5,6 +5,8 @@
 #include <hxcore/HxCompModule.h>
 #include <hxcore/HxPortIntTextN.h>
 #include <hxcore/HxPortDoIt.h>
+#include <hxcore/HxPortOnOff.h>
+#include <hxcore/HxPortFilename.h>
 #include <mclib/McDim3l.h>
 
 class HXFILOPODIA_API HxExtractSlicesFrom3DImage : public HxCompModule {
@@ -13,9 +15,15 @@ class HXFILOPODIA_API HxExtractSlicesFrom3DImage : public HxCompModule {
 
 public:
     void compute();
+    void update();
 
 private:
+    void splitFile(const int step);
+
     HxPortIntTextN z_step;
+    HxPortOnOff portFromFile;
+    HxPortFilename portInputFile;
+    HxPortFilename portOutputDir;
     HxPortDoIt portAction;
 };
 
@@ -1,6 +1,6 @@
 #include "HxLabelPSFCorrection.h"
+#include "ParallelFor.h"
 #include <mclib/McException.h>
-#include <mclib/internal/McAssert.h>
 
 HX_INIT_CLASS(HxLabelPSFCorrection,HxCompModule)
 
@@ -18,64 +18,49 @@ HxLabelPSFCorrection::~HxLabelPSFCorrection()
 {
 }
 
-mclong getIndexFromXYZ(const McVec3i& pos, const McDim3l& dims) {
-    return pos[2]*dims[0]*dims[1] + pos[1]*dims[0] + pos[0];
-}
-
-
-bool isObjectVoxel(const McVec3i& pos, HxLabelLattice3* labelLat) {
-    const unsigned char* ptr = labelLat->getLabels();
-    const McDim3l dims = labelLat->getDims();
-
-    if (pos[0] < 0 || pos[0] >= dims[0]) return false;
-    if (pos[1] < 0 || pos[1] >= dims[1]) return false;
-    if (pos[2] < 0 || pos[2] >= dims[2]) return false;
-
-    const mclong index = getIndexFromXYZ(pos, dims);
-    return ptr[index] >= 1;
-}
-
-
-bool isObjectTopBoundary(const McVec3i& pos, HxLabelLattice3* labelLat) {
-    const McVec3i neighborAbovePos(pos[0], pos[1], pos[2]-1);
-    const McVec3i neighborBelowPos(pos[0], pos[1], pos[2]+1);
-    return isObjectVoxel(pos, labelLat) &&
-           isObjectVoxel(neighborBelowPos, labelLat) &&
-           !isObjectVoxel(neighborAbovePos, labelLat);
-}
-
-
-bool isObjectBottomBoundary(const McVec3i& pos, HxLabelLattice3* labelLat) {
-    const McVec3i neighborAbovePos(pos[0], pos[1], pos[2]-1);
-    const McVec3i neighborBelowPos(pos[0], pos[1], pos[2]+1);
-    return isObjectVoxel(pos, labelLat) &&
-           !isObjectVoxel(neighborBelowPos, labelLat) &&
-           isObjectVoxel(neighborAbovePos, labelLat);
-}
-
-
-bool neighborHasHigherIntensity(const McVec3i& pos,
-                                const McVec3i& neighborPos,
-                                HxLattice3* imageLat)
+// Applies numIter iterations of the correction to one z-column. An object voxel
+// on the top boundary of a run of object voxels is removed if the voxel below is
+// brighter, one on the bottom boundary if the voxel above is brighter. The runs
+// of a column shrink independently, and once neither end of a run is removed, it
+// does not change in later iterations either.
+void HxLabelPSFCorrection::correctColumn(unsigned char* labels,
+                                         const unsigned char* intensities,
+                                         const mclong nz,
+                                         const mclong stride,
+                                         const int numIter)
 {
-    float val, neighborVal;
-    imageLat->eval(pos[0], pos[1], pos[2], &val);
-    imageLat->eval(neighborPos[0], neighborPos[1], neighborPos[2], &neighborVal);
-    return neighborVal > val;
-}
-
-
-bool hasHigherIntensityBelow(const McVec3i& pos, HxLattice3* imageLat) {
-    const McVec3i neighborBelowPos(pos[0], pos[1], pos[2]+1);
-    mcassert(neighborBelowPos[2] != imageLat->getDims()[2]);
-    return neighborHasHigherIntensity(pos, neighborBelowPos, imageLat);
-}
+    mclong z = 0;
+    while (z < nz) {
+        if (labels[z*stride] < 1) {
+            ++z;
+            continue;
+        }
 
+        const mclong runBegin = z;
+        while (z < nz && labels[z*stride] >= 1)
+            ++z;
+        const mclong runEnd = z - 1;
+
+        // Both boundaries are updated from the state of the previous iteration.
+        // A run of length 2 can lose at most one voxel.
+        mclong top = runBegin;
+        mclong bottom = runEnd;
+        for (int iter=0; iter<numIter && top < bottom; ++iter) {
+            const bool removeTop = intensities[(top+1)*stride] > intensities[top*stride];
+            const bool removeBottom = intensities[(bottom-1)*stride] > intensities[bottom*stride];
+            if (!removeTop && !removeBottom)
+                break;
+            if (removeTop)
+                ++top;
+            if (removeBottom)
+                --bottom;
+        }
 
-bool hasHigherIntensityAbove(const McVec3i& pos, HxLattice3* imageLat) {
-    const McVec3i neighborAbovePos(pos[0], pos[1], pos[2]-1);
-    mcassert(neighborAbovePos[2] != 0);
-    return neighborHasHigherIntensity(pos, neighborAbovePos, imageLat);
+        for (mclong i=runBegin; i<top; ++i)
+            labels[i*stride] = 0;
+        for (mclong i=bottom+1; i<=runEnd; ++i)
+            labels[i*stride] = 0;
+    }
 }
 
 
@@ -92,6 +77,10 @@ void HxLabelPSFCorrection::compute() {
             throw McException(QString("No image of type unsigned char provided"));
         }
 
+        if (image->lattice().getDims() != input->lattice().getDims()) {
+            throw McException(QString("Image and label field must have the same dimensions"));
+        }
+
         McHandle<HxUniformLabelField3> output = dynamic_cast<HxUniformLabelField3*>(getResult());
         if (output) {
             const HxLattice3& inLat = input->lattice();
@@ -104,34 +93,18 @@ void HxLabelPSFCorrection::compute() {
             setResult(output);
         }
 
-        HxLattice3* imageLat = dynamic_cast<HxLattice3*>(image->getInterface(HxLattice3::getClassTypeId()));
-        HxLabelLattice3* outputLat = dynamic_cast<HxLabelLattice3*>(output->getInterface(HxLabelLattice3::getClassTypeId()));
-
+        // Every column is corrected independently, in parallel over the y rows.
+        const McDim3l& dims = output->lattice().getDims();
+        const mclong stride = dims[0]*dims[1];
+        unsigned char* labels = (unsigned char*)output->lattice().dataPtr();
+        const unsigned char* intensities = (const unsigned char*)image->lattice().dataPtr();
         const int numIter = portNumIterations.getValue();
-        const float zero = 0.0f;
-
-        for (int iter=0; iter<numIter; ++iter) {
-            McHandle<HxUniformLabelField3> tmpLabels = output->duplicate();
-            HxLabelLattice3* inputLat = dynamic_cast<HxLabelLattice3*>(tmpLabels->getInterface(HxLabelLattice3::getClassTypeId()));
-            const McDim3l& dims = inputLat->getDims();
-            for (int z=0; z<dims[2]; ++z) {
-                for (int y=0; y<dims[1]; ++y) {
-                    for (int x=0; x<dims[0]; ++x) {
-                        McVec3i pos(x, y, z);
-                        if (isObjectTopBoundary(pos, inputLat)) {
-                            if (hasHigherIntensityBelow(pos, imageLat)) {
-                                outputLat->set(x, y, z, &zero);
-                            }
-                        }
-                        else if (isObjectBottomBoundary(pos, inputLat)) {
-                            if (hasHigherIntensityAbove(pos, imageLat)) {
-                                outputLat->set(x, y, z, &zero);
-                            }
-                        }
-                    }
-                }
+
+        ParallelFor::forEach(int(dims[1]), [&](const int y) {
+            for (int x=0; x<dims[0]; ++x) {
+                const mclong offset = y*dims[0] + x;
+                correctColumn(labels + offset, intensities + offset, dims[2], stride, numIter);
             }
-        }
+        });
     }
 }
-
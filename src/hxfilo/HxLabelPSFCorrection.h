@@ -16,6 +16,14 @@ class HXFILOPODIA_API HxLabelPSFCorrection : public HxCompModule {
 
     virtual void compute();
 
+    /** Applies numIter iterations of the correction to one z-column of nz
+        voxels, which are stride elements apart in labels and intensities. */
+    static void correctColumn(unsigned char* labels,
+                              const unsigned char* intensities,
+                              const mclong nz,
+                              const mclong stride,
+                              const int numIter);
+
     HxConnection portImage;
     HxPortIntTextN portNumIterations;
     HxPortDoIt portDoIt;
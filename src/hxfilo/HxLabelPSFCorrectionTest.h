@@ -0,0 +1,113 @@
+#include "HxLabelPSFCorrection.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// The iterative rules of the correction on a single column: in each iteration,
+// an object voxel with an object voxel below and none above (top boundary) is
+// removed if the voxel below is brighter, and one with an object voxel above and
+// none below (bottom boundary) if the voxel above is brighter. All voxels are
+// classified on the labels of the previous iteration.
+void correctColumnIteratively(std::vector<unsigned char>& labels,
+                              const std::vector<unsigned char>& intensities,
+                              const int numIter)
+{
+    const int nz = int(labels.size());
+    for (int iter = 0; iter < numIter; ++iter)
+    {
+        const std::vector<unsigned char> previous = labels;
+        for (int z = 0; z < nz; ++z)
+        {
+            const bool isObject = previous[z] >= 1;
+            const bool isObjectAbove = z > 0 && previous[z - 1] >= 1;
+            const bool isObjectBelow = z < nz - 1 && previous[z + 1] >= 1;
+
+            if (isObject && isObjectBelow && !isObjectAbove)
+            {
+                if (intensities[z + 1] > intensities[z])
+                    labels[z] = 0;
+            }
+            else if (isObject && !isObjectBelow && isObjectAbove)
+            {
+                if (intensities[z - 1] > intensities[z])
+                    labels[z] = 0;
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(HxLabelPSFCorrectionTest, ShortRuns)
+{
+    // A single voxel is never removed.
+    std::vector<unsigned char> labels = {0, 1, 0};
+    std::vector<unsigned char> intensities = {9, 1, 9};
+    HxLabelPSFCorrection::correctColumn(labels.data(), intensities.data(), 3, 1, 5);
+    EXPECT_EQ(labels, std::vector<unsigned char>({0, 1, 0}));
+
+    // A run of two voxels loses the darker one and then stays.
+    labels = {1, 1, 0};
+    intensities = {2, 5, 0};
+    HxLabelPSFCorrection::correctColumn(labels.data(), intensities.data(), 3, 1, 5);
+    EXPECT_EQ(labels, std::vector<unsigned char>({0, 1, 0}));
+
+    // Equal intensities do not remove a voxel.
+    labels = {0, 1, 1};
+    intensities = {0, 4, 4};
+    HxLabelPSFCorrection::correctColumn(labels.data(), intensities.data(), 3, 1, 5);
+    EXPECT_EQ(labels, std::vector<unsigned char>({0, 1, 1}));
+}
+
+TEST(HxLabelPSFCorrectionTest, RandomColumnsMatchIterativeRules)
+{
+    std::mt19937 generator(12345);
+    std::uniform_int_distribution<int> length(1, 20);
+    std::uniform_int_distribution<int> intensity(0, 3);
+    std::uniform_int_distribution<int> label(0, 2);
+    std::uniform_int_distribution<int> iterations(0, 6);
+
+    for (int c = 0; c < 20000; ++c)
+    {
+        const int nz = length(generator);
+        const int numIter = iterations(generator);
+
+        // Few intensity values, so that ties occur, and mostly object voxels,
+        // so that runs of all lengths including 1 and 2 occur.
+        std::vector<unsigned char> labels(nz);
+        std::vector<unsigned char> intensities(nz);
+        for (int z = 0; z < nz; ++z)
+        {
+            labels[z] = label(generator) > 0 ? 1 : 0;
+            intensities[z] = intensity(generator);
+        }
+
+        std::vector<unsigned char> expected = labels;
+        correctColumnIteratively(expected, intensities, numIter);
+
+        // Interleave the column with a second one, as columns are interleaved
+        // in the label field.
+        const int stride = 2;
+        std::vector<unsigned char> interleavedLabels(nz * stride, 7);
+        std::vector<unsigned char> interleavedIntensities(nz * stride, 0);
+        for (int z = 0; z < nz; ++z)
+        {
+            interleavedLabels[z * stride] = labels[z];
+            interleavedIntensities[z * stride] = intensities[z];
+        }
+
+        HxLabelPSFCorrection::correctColumn(labels.data(), intensities.data(), nz, 1, numIter);
+        HxLabelPSFCorrection::correctColumn(interleavedLabels.data(), interleavedIntensities.data(), nz, stride, numIter);
+
+        ASSERT_EQ(labels, expected) << "column " << c << ", " << numIter << " iterations";
+        for (int z = 0; z < nz; ++z)
+        {
+            ASSERT_EQ(interleavedLabels[z * stride], expected[z]) << "column " << c << ", z " << z;
+            ASSERT_EQ(interleavedLabels[z * stride + 1], 7) << "column " << c << ", z " << z;
+        }
+    }
+}
@@ -1,9 +1,13 @@
 #include "HxLandweberDeconvolution.h"
-#include <hxitk/HxItkImageImporter.h>
-#include <hxitk/HxItkImageExporter.h>
-#include <hxitk/HxItkProgressObserver.h>
-#include <itkProjectedLandweberDeconvolutionImageFilter.h>
+#include "ProjectedLandweberDeconvolution.h"
+#include "FilopodiaFunctions.h"
+#include <hxcore/HxMessage.h>
+#include <hxcore/HxObjectPool.h>
+#include <hxcore/HxProgressInterface.h>
+#include <hxfield/HxUniformScalarField3.h>
 #include <mclib/McException.h>
+#include <QDir>
+#include <vector>
 
 
 HX_INIT_CLASS(HxLandweberDeconvolution, HxCompModule)
@@ -12,26 +16,121 @@ HxLandweberDeconvolution::HxLandweberDeconvolution():
     HxCompModule(HxUniformScalarField3::getClassTypeId()),
     portTemplate(this, "Template", tr("Template"), HxUniformScalarField3::getClassTypeId()),
     portIterations(this, "Iterations", tr("Iterations"), 1),
+    portMinRelativeChange(this, "MinRelativeChange", tr("Min relative change"), 1),
+    portBatch(this, "Batch", tr("Process directory")),
+    portInputDir(this, "InputDirectory", tr("Input Directory"), HxPortFilename::LOAD_DIRECTORY),
+    portOutputDir(this, "OutputDirectory", tr("Output Directory"), HxPortFilename::SAVE_DIRECTORY),
     portAction(this, "action", tr("Action"))
 {
     portIterations.setValue(0,1);
+    portMinRelativeChange.setValue(0, 0.0f);
+    portBatch.setValue(false);
+    portInputDir.setValue("Please select");
+    portOutputDir.setValue("Please select");
+    portInputDir.hide();
+    portOutputDir.hide();
 }
 
 HxLandweberDeconvolution::~HxLandweberDeconvolution()
 {
 }
 
-void HxLandweberDeconvolution::compute() {
-    if (portAction.wasHit()) {
-        McHandle<HxUniformScalarField3> inputField = hxconnection_cast<HxUniformScalarField3>(portData);
-        if (!inputField) {
-            return;
+void HxLandweberDeconvolution::update() {
+    if (portBatch.isNew()) {
+        portInputDir.setVisible(portBatch.getValue());
+        portOutputDir.setVisible(portBatch.getValue());
+    }
+}
+
+template <typename T>
+void copyToFloat(const T* values, const mclong numValues, std::vector<float>& data) {
+    data.assign(values, values + numValues);
+}
+
+void getFloatData(const HxUniformScalarField3* field, std::vector<float>& data) {
+    const void* values = field->lattice().dataPtr();
+    const mclong numValues = field->lattice().getDims().nbVoxel();
+
+    switch (field->lattice().primType()) {
+        case McPrimType::MC_UINT8:
+            copyToFloat((const mcuint8*)values, numValues, data);
+            break;
+        case McPrimType::MC_UINT16:
+            copyToFloat((const mcuint16*)values, numValues, data);
+            break;
+        case McPrimType::MC_FLOAT:
+            copyToFloat((const float*)values, numValues, data);
+            break;
+        default:
+            throw McException(QString("Input must be scalar field with unsigned chars, unsigned shorts or floats"));
+    }
+}
+
+void HxLandweberDeconvolution::deconvolveDirectory(ProjectedLandweberDeconvolution& deconvolution) {
+    if (portInputDir.getFilename().isEmpty() || portInputDir.getFilename() == "Please select") {
+        throw McException(QString("Specify input directory!"));
+    }
+    if (portOutputDir.getFilename().isEmpty() || portOutputDir.getFilename() == "Please select") {
+        throw McException(QString("Specify output directory!"));
+    }
+
+    const QString inputDir(portInputDir.getFilename());
+    const QString outputDir(portOutputDir.getFilename());
+
+    if (!QDir(inputDir).exists()) {
+        throw McException(QString("Input directory does not exist. \nPlease select valid input directory containing am files."));
+    }
+    if (!QDir(outputDir).exists()) {
+        throw McException(QString("Output directory does not exist. \nPlease select valid output directory."));
+    }
+
+    const QStringList files = FilopodiaFunctions::getFileListFromDirectory(inputDir, "AM");
+    if (files.size() == 0) {
+        throw McException(QString("No .am files in directory!"));
+    }
+
+    if (FilopodiaFunctions::getFileListFromDirectory(outputDir, "AM").size() > 0) {
+        const int answer = HxMessage::warning("Output directory is not empty. Files may be overwritten. \nContinue?", "Continue", "Cancel");
+        if (answer == 1) return;
+    }
+
+    const int maxNumIterations = portIterations.getValue();
+    const float minRelativeChange = portMinRelativeChange.getValue(0);
+
+    std::vector<float> data;
+    for (int f=0; f<files.size(); ++f) {
+        McHandle<HxUniformScalarField3> image = FilopodiaFunctions::loadUniformScalarField3(files[f]);
+        if (!image) {
+            throw McException(QString("Could not load image %1").arg(files[f]));
         }
-        if (inputField->lattice().primType() != McPrimType::MC_UINT8)
-        {
-            throw McException(QString("Input must be scalar field with unsigned chars"));
+
+        // The loaded image is registered in the object pool and has to be removed
+        // again, also if it cannot be deconvolved.
+        McHandle<HxUniformScalarField3> result;
+        int numIterations = 0;
+        try {
+            getFloatData(image, data);
+
+            const McDim3l& dims = image->lattice().getDims();
+            result = new HxUniformScalarField3(dims, McPrimType::MC_FLOAT);
+            numIterations = deconvolution.deconvolve(&data[0], dims, (float*)result->lattice().dataPtr(),
+                                                     maxNumIterations, minRelativeChange);
+            result->lattice().setBoundingBox(image->getBoundingBox());
         }
+        catch (...) {
+            theObjectPool->removeObject(image);
+            throw;
+        }
+        theObjectPool->removeObject(image);
+
+        const QString outputFile = FilopodiaFunctions::getOutputFileName(files[f], outputDir);
+        result->writeAmiraMeshBinary(qPrintable(outputFile));
+        theMsg->printf(QString("Saving %1 (%2 iterations)").arg(outputFile).arg(numIterations));
+    }
+}
 
+void HxLandweberDeconvolution::compute() {
+    if (portAction.wasHit()) {
         McHandle<HxUniformScalarField3> templateField = hxconnection_cast<HxUniformScalarField3>(portTemplate);
         if (!templateField) {
             return;
@@ -48,6 +147,20 @@ void HxLandweberDeconvolution::compute() {
             }
         }
 
+        ProjectedLandweberDeconvolution deconvolution((const float*)templateField->lattice().dataPtr(), templateDims);
+
+        if (portBatch.getValue()) {
+            deconvolveDirectory(deconvolution);
+            return;
+        }
+
+        McHandle<HxUniformScalarField3> inputField = hxconnection_cast<HxUniformScalarField3>(portData);
+        if (!inputField) {
+            return;
+        }
+
+        std::vector<float> data;
+        getFloatData(inputField, data);
 
         const McDim3l& inDims = inputField->lattice().getDims();
 
@@ -58,7 +171,7 @@ void HxLandweberDeconvolution::compute() {
         if (resultField) {
             const McDim3l& outdims = resultField->lattice().getDims();
             if (inDims[0]!=outdims[0] || inDims[1]!=outdims[1] || inDims[2]!=outdims[2] ||
-                inputField->primType() != McPrimType::MC_FLOAT)
+                resultField->primType() != McPrimType::MC_FLOAT)
             {
                 resultField=0;
             }
@@ -69,36 +182,15 @@ void HxLandweberDeconvolution::compute() {
         }
         resultField->composeLabel(inputField->getLabel(), "correlation");
 
-        const unsigned int Dimension = 3;
-        typedef itk::Image<unsigned char, Dimension> InputImageType;
-        typedef itk::Image<float, Dimension>         TemplateImageType;
-        typedef itk::Image<float, Dimension>         OutputImageType;
+        theProgress->startWorkingNoStop("Applying deconvolution filter...");
+        const int numIterations = deconvolution.deconvolve(&data[0], inDims, (float*)resultField->lattice().dataPtr(),
+                                                           portIterations.getValue(), portMinRelativeChange.getValue(0));
+        theProgress->stopWorking();
 
-        HxItkImageImporter<unsigned char> importer(inputField);
-        HxItkImageImporter<float> templateImporter(templateField);
-
-        typedef itk::ProjectedLandweberDeconvolutionImageFilter<InputImageType, TemplateImageType, OutputImageType> DeconvolutionFilterType;
-        DeconvolutionFilterType::Pointer deconvolutionFilter = DeconvolutionFilterType::New();
-        deconvolutionFilter->SetInput(importer.GetOutput());
-        deconvolutionFilter->SetKernelImage(templateImporter.GetOutput());
-        deconvolutionFilter->NormalizeOn();
-        deconvolutionFilter->SetNumberOfIterations(portIterations.getValue());
-        
-        HxItkImageExporter<OutputImageType> exporter(deconvolutionFilter->GetOutput(), resultField.ptr());
-
-        HxItkProgressObserver progress;
-        progress.setProgressMessage("Applying deconvolution filter...");
-        progress.startObservingProcessObject(deconvolutionFilter);
-        
-        deconvolutionFilter->Update();
-
-        progress.stopObservingProcessObject();
-
-        resultField = exporter.getResult();
         const McBox3f& box = inputField->getBoundingBox();
         resultField->lattice().setBoundingBox(box);
 
         setResult(resultField);
+        theMsg->printf(QString("Deconvolution finished after %1 iterations").arg(numIterations));
     }
 }
-
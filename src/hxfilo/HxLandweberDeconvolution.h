@@ -6,8 +6,20 @@
 #include <hxcore/HxCompModule.h>
 #include <hxcore/HxPortDoIt.h>
 #include <hxcore/HxPortIntTextN.h>
-
-
+#include <hxcore/HxPortFloatTextN.h>
+#include <hxcore/HxPortOnOff.h>
+#include <hxcore/HxPortFilename.h>
+
+class ProjectedLandweberDeconvolution;
+
+/**
+    Projected Landweber deconvolution of the input field with the template as point
+    spread function. The iterations stop early if the relative change of the estimate
+    falls below the given minimum (0 disables early stopping).
+    In batch mode, all .am files of the input directory are deconvolved with the same
+    template and saved as float fields in the output directory. The transform of the
+    template is computed only once for all files of the same size.
+*/
 class HXFILOPODIA_API HxLandweberDeconvolution : public HxCompModule
 {
     HX_HEADER(HxLandweberDeconvolution);
@@ -15,10 +27,18 @@ class HXFILOPODIA_API HxLandweberDeconvolution : public HxCompModule
     public:
 
         virtual void compute();
+        virtual void update();
 
         HxConnection portTemplate;
         HxPortIntTextN portIterations;
+        HxPortFloatTextN portMinRelativeChange;
+        HxPortOnOff portBatch;
+        HxPortFilename portInputDir;
+        HxPortFilename portOutputDir;
         HxPortDoIt   portAction;
+
+    private:
+        void deconvolveDirectory(ProjectedLandweberDeconvolution& deconvolution);
 };
 
 #endif
@@ -1,8 +1,10 @@
 #include "HxMergeGrowthConeCenters.h"
+#include "FilopodiaFunctions.h"
 #include <hxspatialgraph/internal/HxSpatialGraph.h>
 #include <hxspatialgraph/internal/HierarchicalLabels.h>
 #include <mclib/McException.h>
 #include <hxcore/HxMessage.h>
+#include <vector>
 
 #include "ConvertVectorAndMcDArray.h"
 
@@ -11,20 +13,98 @@ HX_INIT_CLASS(HxMergeGrowthConeCenters,HxCompModule)
 HxMergeGrowthConeCenters::HxMergeGrowthConeCenters() :
     HxCompModule(HxSpatialGraph::getClassTypeId()),
     portColormap(this, tr("Colormap"), tr("Colormap")),
+    portMergeDirectory(this, tr("MergeDirectory"), tr("Merge directory")),
+    portInputDir(this, tr("InputDirectory"), tr("Input directory"), HxPortFilename::LOAD_DIRECTORY),
     portAction(this, tr("action"), tr("Action")),
     mTimeStep(0)
 {
+    portMergeDirectory.setValue(false);
+    portInputDir.setValue("Please select");
+    portInputDir.hide();
 }
 
 HxMergeGrowthConeCenters::~HxMergeGrowthConeCenters()
 {
 }
 
+void HxMergeGrowthConeCenters::update()
+{
+    if (portMergeDirectory.isNew()) {
+        portInputDir.setVisible(portMergeDirectory.getValue());
+        portData.setVisible(!portMergeDirectory.getValue());
+    }
+}
+
+void HxMergeGrowthConeCenters::mergeDirectory(HxSpatialGraph* output)
+{
+    const char* timeStepAttributeName = FilopodiaFunctions::getTimeStepAttributeName();
+
+    if (portInputDir.getFilename().isEmpty() || portInputDir.getFilename() == "Please select") {
+        throw McException(QString("Specify input directory!"));
+    }
+
+    // One time step per file, in the order of the file names
+    QStringList files = FilopodiaFunctions::getFileListFromDirectory(portInputDir.getFilename(), "AM");
+    if (files.size() == 0) {
+        throw McException(QString("No am files in directory!"));
+    }
+    files.sort();
+
+    std::vector<McHandle<HxSpatialGraph> > graphs = FilopodiaFunctions::readSpatialGraphs(files);
+
+    // Merging appends the vertices, so the vertices of each time step are a
+    // contiguous range in the output, and the time ids are set after merging.
+    std::vector<int> numVertices(graphs.size());
+    for (int t=0; t<graphs.size(); ++t) {
+        numVertices[t] = graphs[t]->getNumVertices();
+    }
+
+    FilopodiaFunctions::mergeSpatialGraphs(graphs, output);
+
+    HierarchicalLabels* labels = output->addNewLabelGroup(timeStepAttributeName, false, true, false);
+    EdgeVertexAttribute* timeStepAtt = output->findVertexAttribute(timeStepAttributeName);
+    int v = 0;
+    for (int t=0; t<graphs.size(); ++t) {
+        const int labelId = labels->addLabel(0, McString().printf("T_%03d", t), SbColor());
+        for (int i=0; i<numVertices[t]; ++i, ++v) {
+            timeStepAtt->setIntDataAtIdx(v, labelId);
+        }
+    }
+    mTimeStep = files.size();
+
+    theMsg->printf(QString("MergeGrowthConeCenters: merged %1 timesteps (total: %2 nodes)")
+                   .arg(files.size()).arg(output->getNumVertices()));
+}
+
+void HxMergeGrowthConeCenters::setTimeStepColors(HxSpatialGraph* output)
+{
+    HierarchicalLabels* labels = output->getLabelGroup(FilopodiaFunctions::getTimeStepAttributeName());
+    const int maxLabel = labels->getMaxLabelId();
+    portColormap.setMinMax(1, maxLabel);
+    McDArray<int> childLabelIds = labels->getChildIds(0);
+    for (int i=0; i<childLabelIds.size(); ++i) {
+        const SbColor c = portColormap.getColor(float(childLabelIds[i]));
+        const McColor color(c[0], c[1], c[2]);
+        labels->setLabelColor(childLabelIds[i], color);
+    }
+    labels->setLabelColor(0, McColor(0.0f, 0.0f, 0.0f));
+}
+
 void HxMergeGrowthConeCenters::compute()
 {
     const char* timeStepAttributeName = "TimeStep";
 
-    if (portAction.wasHit()) {
+    if (portAction.wasHit() && portMergeDirectory.getValue()) {
+        McHandle<HxSpatialGraph> output = dynamic_cast<HxSpatialGraph*>(getResult());
+        if (!output) {
+            output = HxSpatialGraph::createInstance();
+            output->setLabel("MergedGrowthConeCenters");
+        }
+        mergeDirectory(output);
+        setTimeStepColors(output);
+        setResult(output);
+    }
+    else if (portAction.wasHit()) {
         HxSpatialGraph* input = hxconnection_cast<HxSpatialGraph> (portData);
         if (!input) {
             throw McException(QString("No input graph"));
@@ -61,16 +141,7 @@ void HxMergeGrowthConeCenters::compute()
                            .arg(mTimeStep).arg(input->getNumVertices()).arg(output->getNumVertices()));
         }
 
-        HierarchicalLabels* labels = output->getLabelGroup(timeStepAttributeName);
-        const int maxLabel = labels->getMaxLabelId();
-        portColormap.setMinMax(1, maxLabel);
-        McDArray<int> childLabelIds = labels->getChildIds(0);
-        for (int i=0; i<childLabelIds.size(); ++i) {
-            const SbColor c = portColormap.getColor(float(childLabelIds[i]));
-            const McColor color(c[0], c[1], c[2]);
-            labels->setLabelColor(childLabelIds[i], color);
-        }
-        labels->setLabelColor(0, McColor(0.0f, 0.0f, 0.0f));
+        setTimeStepColors(output);
 
         setResult(output);
 
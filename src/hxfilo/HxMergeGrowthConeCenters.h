@@ -3,8 +3,12 @@
 #include "api.h"
 #include <hxcore/HxCompModule.h>
 #include <hxcore/HxPortDoIt.h>
+#include <hxcore/HxPortOnOff.h>
+#include <hxcore/HxPortFilename.h>
 #include <hxcolor/HxPortColormap.h>
 
+class HxSpatialGraph;
+
 class HXFILOPODIA_API HxMergeGrowthConeCenters : public HxCompModule
 {
     HX_HEADER(HxMergeGrowthConeCenters);
@@ -12,10 +16,16 @@ class HXFILOPODIA_API HxMergeGrowthConeCenters : public HxCompModule
  public:
 
     virtual void compute();
+    virtual void update();
 
     HxPortColormap   portColormap;
+    HxPortOnOff      portMergeDirectory;
+    HxPortFilename   portInputDir;
     HxPortDoIt       portAction;
 
   private:
+    void mergeDirectory(HxSpatialGraph* output);
+    void setTimeStepColors(HxSpatialGraph* output);
+
     int mTimeStep;
 };
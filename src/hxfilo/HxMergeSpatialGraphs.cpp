@@ -3,6 +3,7 @@
 #include <hxspatialgraph/internal/HxSpatialGraph.h>
 #include <mclib/McException.h>
 #include <QDir>
+#include <vector>
 
 
 typedef QMap<int, QFileInfo> FileInfoMap; /// Key is time step
@@ -45,33 +46,31 @@ void mergeGraphs(HxSpatialGraph* mergedGraph, const QStringList files) {
         throw McException(QString("Missing %1 input labels fields").arg(missing));
     }
 
+    QStringList sortedFiles;
     for (FileInfoMap::const_iterator it=map.begin(); it!=map.end(); ++it) {
-        const int time = it.key();
-
-        McHandle<HxSpatialGraph> graph = FilopodiaFunctions::readSpatialGraph(it.value().absoluteFilePath());
-        FilopodiaFunctions::addTimeLabelAttribute(graph, tMinMax);
-
-        SpatialGraphSelection addedSel;
+        sortedFiles.append(it.value().absoluteFilePath());
+    }
 
-        if (it == map.begin()) {
-            mergedGraph->copyFrom(graph);
-            addedSel = SpatialGraphSelection(mergedGraph);
-            addedSel.selectAllVerticesAndEdges();
-        }
-        else {
-            addedSel = mergedGraph->merge(graph);
-        }
+    std::vector<McHandle<HxSpatialGraph> > graphs = FilopodiaFunctions::readSpatialGraphs(sortedFiles);
 
-        int labelId = FilopodiaFunctions::getTimeIdFromTimeStep(mergedGraph, time);
+    // All graphs get the same time labels, so the time ids can be set before merging
+    int f = 0;
+    for (FileInfoMap::const_iterator it=map.begin(); it!=map.end(); ++it, ++f) {
+        HxSpatialGraph* graph = graphs[f];
+        FilopodiaFunctions::addTimeLabelAttribute(graph, tMinMax);
 
-        SpatialGraphSelection::Iterator iter(addedSel);
-        for (int v=iter.vertices.nextSelected(); v!=-1; v=iter.vertices.nextSelected()) {
-            FilopodiaFunctions::setTimeIdOfNode(mergedGraph, v, labelId);
+        const int labelId = FilopodiaFunctions::getTimeIdFromTimeStep(graph, it.key());
+        EdgeVertexAttribute* vertexTimeAtt = graph->findVertexAttribute(FilopodiaFunctions::getTimeStepAttributeName());
+        EdgeVertexAttribute* edgeTimeAtt = graph->findEdgeAttribute(FilopodiaFunctions::getTimeStepAttributeName());
+        for (int v=0; v<graph->getNumVertices(); ++v) {
+            vertexTimeAtt->setIntDataAtIdx(v, labelId);
         }
-        for (int e=iter.edges.nextSelected(); e!=-1; e=iter.edges.nextSelected()) {
-            FilopodiaFunctions::setTimeIdOfEdge(mergedGraph, e, labelId);
+        for (int e=0; e<graph->getNumEdges(); ++e) {
+            edgeTimeAtt->setIntDataAtIdx(e, labelId);
         }
     }
+
+    FilopodiaFunctions::mergeSpatialGraphs(graphs, mergedGraph);
 }
 
 
@@ -1,10 +1,15 @@
 #include "HxNodeAtRegionMaximum.h"
+#include "ParallelFor.h"
 #include <hxfield/HxUniformLabelField3.h>
 #include <hxspatialgraph/internal/HxSpatialGraph.h>
 #include <mclib/McException.h>
 #include <hxcore/HxMessage.h>
 #include <qdebug.h>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 
 HX_INIT_CLASS(HxNodeAtRegionMaximum,HxCompModule)
 
@@ -38,6 +43,137 @@ bool isBoundaryIndex(const McVec3i& idx, const McDim3l& dims) {
 }
 
 
+/// Maximum value and the voxels at which it is attained, per label.
+struct RegionMaxima {
+    std::vector<float> maxValuePerLabel;
+    std::vector<std::vector<McVec3i> > pointsPerLabel;
+
+    void init(const int numLabels) {
+        // Values not above std::numeric_limits<float>::min() are never a maximum
+        maxValuePerLabel.assign(numLabels, std::numeric_limits<float>::min());
+        pointsPerLabel.assign(numLabels, std::vector<McVec3i>());
+    }
+
+    void add(const int label, const float value, const McVec3i& point) {
+        if (value > maxValuePerLabel[label]) {
+            maxValuePerLabel[label] = value;
+            pointsPerLabel[label].clear();
+            pointsPerLabel[label].push_back(point);
+        } else if (value == maxValuePerLabel[label]) {
+            pointsPerLabel[label].push_back(point);
+        }
+    }
+
+    /// Merges the maxima of the voxels following the voxels of this object.
+    void merge(const RegionMaxima& next) {
+        for (int l=0; l<int(maxValuePerLabel.size()); ++l) {
+            if (next.pointsPerLabel[l].empty()) continue;
+
+            if (next.maxValuePerLabel[l] > maxValuePerLabel[l]) {
+                maxValuePerLabel[l] = next.maxValuePerLabel[l];
+                pointsPerLabel[l] = next.pointsPerLabel[l];
+            } else if (next.maxValuePerLabel[l] == maxValuePerLabel[l]) {
+                pointsPerLabel[l].insert(pointsPerLabel[l].end(), next.pointsPerLabel[l].begin(), next.pointsPerLabel[l].end());
+            }
+        }
+    }
+};
+
+
+/// Computes the maxima in the slices zBegin to zEnd-1. If labels is 0, all voxels
+/// have label 0, otherwise voxels with label 0 and labels out of range are skipped.
+template <typename S, typename L>
+void computeRegionMaximaInSlab(const S* scalars,
+                               const L* labels,
+                               const McDim3l& dims,
+                               const int zBegin,
+                               const int zEnd,
+                               const bool removeBoundaryNodes,
+                               RegionMaxima& maxima)
+{
+    const int numLabels = maxima.maxValuePerLabel.size();
+
+    for (int z=zBegin; z<zEnd; ++z) {
+        for (int y=0; y<dims[1]; ++y) {
+            const mclong offset = (mclong(z)*dims[1] + y)*dims[0];
+            const S* scalarRow = scalars + offset;
+            const L* labelRow = labels ? labels + offset : 0;
+
+            for (int x=0; x<dims[0]; ++x) {
+                int label = 0;
+                if (labelRow) {
+                    label = int(labelRow[x]);
+                    if (label <= 0 || label >= numLabels) continue;    // Skip background label
+                }
+
+                if (removeBoundaryNodes && isBoundaryIndex(McVec3i(x, y, z), dims)) continue;
+
+                maxima.add(label, float(scalarRow[x]), McVec3i(x, y, z));
+            }
+        }
+    }
+}
+
+
+/// Splits the volume into one slab of slices per thread and merges the maxima
+/// of the slabs in slice order, so that the points are in the same order as
+/// in a sequential scan.
+template <typename S, typename L>
+void computeRegionMaxima(const S* scalars,
+                         const L* labels,
+                         const McDim3l& dims,
+                         const bool removeBoundaryNodes,
+                         const int numLabels,
+                         RegionMaxima& maxima)
+{
+    const int numSlabs = ParallelFor::getNumThreads(int(dims[2]));
+
+    std::vector<RegionMaxima> maximaPerSlab(numSlabs);
+    ParallelFor::runThreads(numSlabs, [&](const int s) {
+        maximaPerSlab[s].init(numLabels);
+        const int zBegin = int(mclong(dims[2])*s/numSlabs);
+        const int zEnd = int(mclong(dims[2])*(s+1)/numSlabs);
+        computeRegionMaximaInSlab(scalars, labels, dims, zBegin, zEnd, removeBoundaryNodes, maximaPerSlab[s]);
+    });
+
+    maxima = maximaPerSlab[0];
+    for (int s=1; s<numSlabs; ++s) {
+        maxima.merge(maximaPerSlab[s]);
+    }
+}
+
+
+template <typename S>
+void computeRegionMaxima(const S* scalars,
+                         const HxUniformLabelField3* labelField,
+                         const McDim3l& dims,
+                         const bool removeBoundaryNodes,
+                         const int numLabels,
+                         RegionMaxima& maxima)
+{
+    if (!labelField) {
+        computeRegionMaxima(scalars, (const mcuint8*)0, dims, removeBoundaryNodes, numLabels, maxima);
+        return;
+    }
+
+    const void* labels = labelField->lattice().dataPtr();
+
+    switch (labelField->lattice().primType()) {
+        case McPrimType::MC_UINT8:
+            computeRegionMaxima(scalars, (const mcuint8*)labels, dims, removeBoundaryNodes, numLabels, maxima);
+            break;
+        case McPrimType::MC_UINT16:
+            computeRegionMaxima(scalars, (const mcuint16*)labels, dims, removeBoundaryNodes, numLabels, maxima);
+            break;
+        case McPrimType::MC_INT32:
+            computeRegionMaxima(scalars, (const mcint32*)labels, dims, removeBoundaryNodes, numLabels, maxima);
+            break;
+        default:
+            throw McException(QString("Only 8-bit, 16-bit and 32-bit label fields supported"));
+    }
+}
+
+
 void getNodesAtRegionMaximum(const HxUniformScalarField3* scalarField,
                              HxSpatialGraph* graph,
                              const bool removeBoundaryNodes,
@@ -49,8 +185,9 @@ void getNodesAtRegionMaximum(const HxUniformScalarField3* scalarField,
     int maxLabels = 1;
     if (labelField) {
 
-        if(labelField->lattice().primType() != McPrimType::MC_UINT8) {
-            throw McException(QString("Only 8-bit label fields supported"));
+        const McPrimType labelType = labelField->lattice().primType();
+        if (labelType != McPrimType::MC_UINT8 && labelType != McPrimType::MC_UINT16 && labelType != McPrimType::MC_INT32) {
+            throw McException(QString("Only 8-bit, 16-bit and 32-bit label fields supported"));
         }
 
         const McDim3l& dimsLabel = labelField->lattice().getDims();
@@ -61,38 +198,45 @@ void getNodesAtRegionMaximum(const HxUniformScalarField3* scalarField,
 
         float minVal, maxVal;
         labelField->getRange(minVal, maxVal);
-        maxLabels = int(maxVal + 0.5) + 1;
+        maxLabels = std::max(int(maxVal + 0.5) + 1, 1);
     }
 
-    std::vector<std::vector<McVec3i> > pointsPerLabel(maxLabels);
-    std::vector<float> maxValuePerLabel(maxLabels);
-    std::fill(maxValuePerLabel.begin(), maxValuePerLabel.end(), std::numeric_limits<float>::min());
-
-    float scalarVal;
-    int label = 0;
-
-    for (int z=0; z<dims[2]; ++z) {
-        for (int y=0; y<dims[1]; ++y) {
-            for (int x=0; x<dims[0]; ++x) {
-                scalarField->lattice().eval(x, y, z, &scalarVal);
-                if (labelField) {
-                    labelField->lattice().evalNative(x, y, z, &label);
-                    if (label == 0) continue;                           // Scip background label
-                }
+    RegionMaxima maxima;
+    const void* scalars = scalarField->lattice().dataPtr();
 
-                if (scalarVal > maxValuePerLabel[label]) {
-                    if (!removeBoundaryNodes || !isBoundaryIndex(McVec3i(x, y, z), dims)) {
-                        maxValuePerLabel[label] = scalarVal;
-                        pointsPerLabel[label].clear();
-                        pointsPerLabel[label].push_back(McVec3i(x,y,z));
-                    }
-                } else if (scalarVal == maxValuePerLabel[label]) {
-                    if (!removeBoundaryNodes || !isBoundaryIndex(McVec3i(x, y, z), dims)) {
-                        pointsPerLabel[label].push_back(McVec3i(x,y,z));
-                    }
-                }
-            }
-        }
+    switch (scalarField->lattice().primType()) {
+        case McPrimType::MC_INT8:
+            computeRegionMaxima((const mcint8*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_UINT8:
+            computeRegionMaxima((const mcuint8*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_INT16:
+            computeRegionMaxima((const mcint16*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_UINT16:
+            computeRegionMaxima((const mcuint16*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_INT32:
+            computeRegionMaxima((const mcint32*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_UINT32:
+            computeRegionMaxima((const mcuint32*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_INT64:
+            computeRegionMaxima((const mcint64*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_UINT64:
+            computeRegionMaxima((const mcuint64*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_FLOAT:
+            computeRegionMaxima((const float*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        case McPrimType::MC_DOUBLE:
+            computeRegionMaxima((const double*)scalars, labelField, dims, removeBoundaryNodes, maxLabels, maxima);
+            break;
+        default:
+            throw McException(QString("Unsupported data type of input field"));
     }
 
     graph->clear();
@@ -100,9 +244,9 @@ void getNodesAtRegionMaximum(const HxUniformScalarField3* scalarField,
 
     McHandle<HxCoord3> coords = scalarField->lattice().coords();
     for (int l=0; l<maxLabels; ++l) {
-        float maxValue = maxValuePerLabel[l];
-        for (int i=0; i<pointsPerLabel[l].size(); ++i) {
-            McVec3f pos = coords->pos(pointsPerLabel[l][i]);
+        float maxValue = maxima.maxValuePerLabel[l];
+        for (int i=0; i<maxima.pointsPerLabel[l].size(); ++i) {
+            McVec3f pos = coords->pos(maxima.pointsPerLabel[l][i]);
             const int vertexId = graph->addVertex(McVec3f(pos[0], pos[1], pos[2]));
             vAtt->setFloatDataAtIdx(vertexId, maxValue);
         }
@@ -248,6 +248,15 @@ void HxShortestPathToPointMap::computeDijkstraMap(const HxUniformScalarField3 *i
     dijkstraMap->set(rootIdxCrop[0], rootIdxCrop[1], rootIdxCrop[2], FilopodiaFunctions::vectorToDirection(McVec3i(0, 0, 0)));
     distanceMap->set(rootIdxCrop[0],rootIdxCrop[1],rootIdxCrop[2], 0.0f);
 
+    // Store root voxel, crop origin and parameters, so that the root need not be searched in the map
+    const int rootVoxel[3] = { rootIdxCrop[0], rootIdxCrop[1], rootIdxCrop[2] };
+    const int cropOrigin[3] = { startVec[0], startVec[1], startVec[2] };
+    dijkstraMap->parameters.set("DijkstraRootVoxel", 3, rootVoxel);
+    dijkstraMap->parameters.set("DijkstraCropOrigin", 3, cropOrigin);
+    dijkstraMap->parameters.set("DijkstraIntensityWeight", intensityWeight);
+    dijkstraMap->parameters.set("DijkstraIntensityPower", intensityPower);
+    dijkstraMap->parameters.set("DijkstraTopBrightness", topBrightness);
+
     const mclong totalVoxels = outDims.nx * outDims.ny * outDims.nz;
     int processedVoxels = 0;
 
@@ -322,6 +331,30 @@ void HxShortestPathToPointMap::computeDijkstraMap(const HxUniformScalarField3 *i
 
 }
 
+bool HxShortestPathToPointMap::getRootVoxel(const HxUniformScalarField3* dijkstraMap, McVec3i& rootVoxel)
+{
+    int values[3];
+    if (!dijkstraMap->parameters.findNum("DijkstraRootVoxel", 3, values)) {
+        return false;
+    }
+
+    // The map may have been cropped or edited after it was computed
+    const McDim3l& dims = dijkstraMap->lattice().getDims();
+    if (values[0] < 0 || values[0] >= dims.nx ||
+        values[1] < 0 || values[1] >= dims.ny ||
+        values[2] < 0 || values[2] >= dims.nz)
+    {
+        return false;
+    }
+    const int rootDirection = FilopodiaFunctions::vectorToDirection(McVec3i(0, 0, 0));
+    if (int(dijkstraMap->evalReg(values[0], values[1], values[2])) != rootDirection) {
+        return false;
+    }
+
+    rootVoxel = McVec3i(values[0], values[1], values[2]);
+    return true;
+}
+
 void
 HxShortestPathToPointMap::update()
 {
@@ -54,6 +54,11 @@ class HXFILOPODIA_API HxShortestPathToPointMap : public HxCompModule
                                    HxUniformScalarField3* distanceMap = 0,
                                    const float intensityPower = 1.0);
 
+    /// Returns the voxel of the root point in a map written by computeDijkstraMap,
+    /// as stored in the parameters of the map. Returns false for maps without this
+    /// information, e.g. maps computed by older versions.
+    static bool getRootVoxel(const HxUniformScalarField3* dijkstraMap, McVec3i& rootVoxel);
+
   protected:
 
   private:
@@ -1,9 +1,17 @@
 #include "HxSplitLabelField.h"
+#include "ParallelFor.h"
 #include <hxspatialgraph/internal/HxSpatialGraph.h>
 #include <hxfield/HxUniformLabelField3.h>
+#include <hxfield/HxUniformScalarField3.h>
 #include <hxfield/HxLoc3Regular.h>
 #include <hxcore/HxMessage.h>
+#include <mclib/McException.h>
+#include <Inventor/SbLinear.h>
 #include <QSetIterator>
+#include <QHash>
+
+#include <cstring>
+#include <vector>
 
 HX_INIT_CLASS(HxSplitLabelField, HxCompModule)
 
@@ -47,55 +55,100 @@ HxSplitLabelField::getIntensityPolicy()
     return static_cast<IntensityPolicy>(portImageBackground.getValue());
 }
 
-void
-crop(HxLabelLattice3* lat, HxLattice3* imageLat, const int boundarySize)
+// Bounding box of the voxels of one label, empty if max < min.
+struct LabelBox
 {
-    const McDim3l& dims = lat->getDims();
+    McVec3i min;
+    McVec3i max;
+};
+
+// Returns the bounding box of the voxels from cropMin to cropMax of a uniform field,
+// in the coordinates of the field as for a cropped lattice.
+template <typename Field>
+McBox3f
+getCroppedBoundingBox(const Field* field, const McVec3i& cropMin, const McVec3i& cropMax)
+{
+    const McVec3f voxelSize = field->getVoxelSize();
+    const McVec3f bboxMin = field->getBoundingBox().getMin();
 
-    McVec3i min(dims[0] - 1, dims[1] - 1, dims[2] - 1);
-    McVec3i max(0, 0, 0);
+    McVec3f outBBoxMin, outBBoxMax;
+    for (int d = 0; d < 3; ++d)
+    {
+        outBBoxMin[d] = bboxMin[d] + voxelSize[d] * cropMin[d];
+        outBBoxMax[d] = bboxMin[d] + voxelSize[d] * cropMax[d];
+    }
+    return McBox3f(outBBoxMin, outBBoxMax);
+}
 
-    float val;
-    for (int z = 0; z < dims[2]; ++z)
+// Computes the bounding boxes of all labels in one pass over the label field.
+// boxes[i] is the bounding box of the label labels[i].
+template <typename T>
+std::vector<LabelBox>
+computeLabelBoxes(const McDim3l& dims, const T* ptr, const std::vector<T>& labels)
+{
+    QHash<T, int> labelIndex;
+    for (int i = 0; i < int(labels.size()); ++i)
+    {
+        labelIndex.insert(labels[i], i);
+    }
+
+    LabelBox emptyBox;
+    emptyBox.min = McVec3i(int(dims.nx), int(dims.ny), int(dims.nz));
+    emptyBox.max = McVec3i(-1, -1, -1);
+
+    // Each slice is scanned by one thread into a bounding box per slice.
+    std::vector<std::vector<LabelBox> > boxesPerSlice(dims.nz);
+    ParallelFor::forEach(int(dims.nz), [&](const int z)
     {
-        for (int y = 0; y < dims[1]; ++y)
+        std::vector<LabelBox>& boxes = boxesPerSlice[z];
+        boxes.assign(labels.size(), emptyBox);
+
+        T lastValue = 0;
+        int lastIndex = -1;
+        const T* slice = ptr + mclong(z) * dims.nx * dims.ny;
+        for (int y = 0; y < dims.ny; ++y)
         {
-            for (int x = 0; x < dims[0]; ++x)
+            const T* row = slice + mclong(y) * dims.nx;
+            for (int x = 0; x < dims.nx; ++x)
             {
-                lat->eval(x, y, z, &val);
-                if (val > 0.0f)
+                const T value = row[x];
+                if (value == 0)
+                    continue;
+
+                if (value != lastValue)
                 {
-                    if (x < min[0])
-                        min[0] = x;
-                    if (y < min[1])
-                        min[1] = y;
-                    if (z < min[2])
-                        min[2] = z;
-
-                    if (x > max[0])
-                        max[0] = x;
-                    if (y > max[1])
-                        max[1] = y;
-                    if (z > max[2])
-                        max[2] = z;
+                    lastValue = value;
+                    lastIndex = labelIndex.value(value, -1);
                 }
+                if (lastIndex < 0)
+                    continue;
+
+                LabelBox& box = boxes[lastIndex];
+                box.min[0] = MC_MIN2(box.min[0], x);
+                box.min[1] = MC_MIN2(box.min[1], y);
+                box.min[2] = MC_MIN2(box.min[2], z);
+                box.max[0] = MC_MAX2(box.max[0], x);
+                box.max[1] = MC_MAX2(box.max[1], y);
+                box.max[2] = MC_MAX2(box.max[2], z);
             }
         }
-    }
-
-    min[0] = MC_MAX2(0, min[0] - boundarySize);
-    min[1] = MC_MAX2(0, min[1] - boundarySize);
-    min[2] = MC_MAX2(0, min[2] - boundarySize);
-
-    max[0] = MC_MIN2(dims[0] - 1, max[0] + boundarySize);
-    max[1] = MC_MIN2(dims[1] - 1, max[1] + boundarySize);
-    max[2] = MC_MIN2(dims[2] - 1, max[2] + boundarySize);
+    });
 
-    lat->crop(&min[0], &max[0], NULL);
-    if (imageLat)
+    std::vector<LabelBox> boxes(labels.size(), emptyBox);
+    for (int z = 0; z < dims.nz; ++z)
     {
-        imageLat->crop(&min[0], &max[0], NULL);
+        for (int i = 0; i < int(labels.size()); ++i)
+        {
+            const LabelBox& sliceBox = boxesPerSlice[z][i];
+            for (int d = 0; d < 3; ++d)
+            {
+                boxes[i].min[d] = MC_MIN2(boxes[i].min[d], sliceBox.min[d]);
+                boxes[i].max[d] = MC_MAX2(boxes[i].max[d], sliceBox.max[d]);
+            }
+        }
     }
+
+    return boxes;
 }
 
 template <typename T>
@@ -156,66 +209,132 @@ createFieldPerLabel(const McDim3l dims,
                     const HxSplitLabelField::IntensityPolicy intensityPolicy,
                     const int boundarySize)
 {
+    HxLabelLattice3* inputLabelLat = (HxLabelLattice3*)inputLabels->getInterface(HxLabelLattice3::getClassTypeId());
+    const T* inputPtr = (const T*)inputLabelLat->getLabels();
+
+    std::vector<T> labels;
     QSetIterator<T> it(labelsToKeep);
+    while (it.hasNext())
+    {
+        labels.push_back(it.next());
+    }
 
-    const float zero = 0.0f;
-    const mcint64 numVoxels = dims.nbVoxel();
+    const std::vector<LabelBox> boxes = computeLabelBoxes(dims, inputPtr, labels);
+    const int numLabels = int(labels.size());
 
-    std::vector<HxData*> results;
+    // The outputs keep the transformations of the inputs, as duplicates would.
+    SbMatrix labelTransform, imageTransform;
+    inputLabels->getTransform(labelTransform);
+    if (inputImage)
+    {
+        inputImage->getTransform(imageTransform);
+    }
 
-    while (it.hasNext())
+    // Create the output fields, cropped to the bounding box of the label plus
+    // the boundary. Labels without a material are not cropped.
+    std::vector<McVec3i> cropMin(numLabels);
+    std::vector<McVec3i> cropMax(numLabels);
+    std::vector<HxUniformLabelField3*> outputLabels(numLabels);
+    std::vector<HxUniformScalarField3*> outputImages(numLabels, 0);
+
+    HxParamBundle* materials = inputLabelLat->materials(0);
+
+    for (int i = 0; i < numLabels; ++i)
     {
-        const T label = it.next();
+        cropMin[i] = McVec3i(0, 0, 0);
+        cropMax[i] = McVec3i(int(dims.nx) - 1, int(dims.ny) - 1, int(dims.nz) - 1);
 
-        HxUniformLabelField3* outputLabels = inputLabels->duplicate();
-        HxLabelLattice3* outputLabelLat = (HxLabelLattice3*)outputLabels->getInterface(HxLabelLattice3::getClassTypeId());
-        T* ptr = (T*)outputLabelLat->getLabels();
+        HxParamBundle* material = materials ? materials->getBundle(int(labels[i])) : 0;
+        if (material)
+        {
+            for (int d = 0; d < 3; ++d)
+            {
+                cropMin[i][d] = MC_MAX2(0, boxes[i].min[d] - boundarySize);
+                cropMax[i][d] = MC_MIN2(int(dims[d]) - 1, boxes[i].max[d] + boundarySize);
+            }
+        }
+
+        const McDim3l outDims(cropMax[i][0] - cropMin[i][0] + 1,
+                              cropMax[i][1] - cropMin[i][1] + 1,
+                              cropMax[i][2] - cropMin[i][2] + 1);
 
-        HxUniformScalarField3* outputImage = 0;
-        HxLattice3* outputImageLat = 0;
+        outputLabels[i] = new HxUniformLabelField3(outDims, inputLabelLat->primType());
+        outputLabels[i]->parameters = inputLabels->parameters;
+        outputLabels[i]->setBoundingBox(getCroppedBoundingBox(inputLabels, cropMin[i], cropMax[i]));
+        outputLabels[i]->setTransform(labelTransform);
+        outputLabels[i]->setLabel(inputLabels->getLabel());
 
         if (inputImage)
         {
-            outputImage = inputImage->duplicate();
-            outputImageLat = &(outputImage->lattice());
+            outputImages[i] = new HxUniformScalarField3(outDims, inputImage->lattice().primType());
+            outputImages[i]->parameters = inputImage->parameters;
+            outputImages[i]->setBoundingBox(getCroppedBoundingBox(inputImage, cropMin[i], cropMax[i]));
+            outputImages[i]->setTransform(imageTransform);
+            outputImages[i]->setLabel(inputImage->getLabel());
         }
 
-        for (mcint64 i = 0; i < numVoxels; ++i)
+        if (material)
         {
-            if (ptr[i] != label)
+            const int idx = material->getName().remove("Material").toInt();
+            const QString nameLabel = QString("Object%1.Label").arg(idx);
+            outputLabels[i]->composeLabel(inputLabels->getLabel(), nameLabel);
+            if (outputImages[i])
             {
-                ptr[i] = 0;
-                if (outputImage && intensityPolicy == HxSplitLabelField::SET_TO_BACKGROUND)
-                {
-                    outputImageLat->set(i, &zero);
-                }
+                const QString nameImage = QString("Object%1.Image").arg(idx);
+                outputImages[i]->composeLabel(inputImage->getLabel(), nameImage);
             }
+            theMsg->printf(QString("Cropping object%1").arg(idx));
         }
+    }
+
+    // Copy the cropped data in parallel, clearing all other labels.
+    const char* inputImagePtr = inputImage ? (const char*)inputImage->lattice().dataPtr() : 0;
+    const int valueSize = inputImage ? inputImage->lattice().primType().size() : 0;
+    const bool clearImage = (intensityPolicy == HxSplitLabelField::SET_TO_BACKGROUND);
 
-        HxParamBundle* materials = outputLabelLat->materials(0);
-        if (materials)
+    ParallelFor::forEach(numLabels, [&](const int i)
+    {
+        const T label = labels[i];
+        T* labelPtr = (T*)outputLabels[i]->lattice().dataPtr();
+        char* imagePtr = outputImages[i] ? (char*)outputImages[i]->lattice().dataPtr() : 0;
+        const int rowLength = cropMax[i][0] - cropMin[i][0] + 1;
+
+        for (int z = cropMin[i][2]; z <= cropMax[i][2]; ++z)
         {
-            const int bundleNum = int(label);
-            HxParamBundle* material = materials->getBundle(bundleNum);
-            if (material)
+            for (int y = cropMin[i][1]; y <= cropMax[i][1]; ++y)
             {
-                const int idx = material->getName().remove("Material").toInt();
-                const QString nameLabel = QString("Object%1.Label").arg(idx);
-                outputLabels->composeLabel(inputLabels->getLabel(), nameLabel);
-                if (outputImage)
+                const mclong inputOffset = (mclong(z) * dims.ny + y) * dims.nx + cropMin[i][0];
+                const T* inputRow = inputPtr + inputOffset;
+                for (int x = 0; x < rowLength; ++x)
+                {
+                    labelPtr[x] = (inputRow[x] == label) ? label : 0;
+                }
+
+                if (imagePtr)
                 {
-                    const QString nameImage = QString("Object%1.Image").arg(idx);
-                    outputImage->composeLabel(inputImage->getLabel(), nameImage);
+                    memcpy(imagePtr, inputImagePtr + inputOffset * valueSize, mclong(rowLength) * valueSize);
+                    if (clearImage)
+                    {
+                        for (int x = 0; x < rowLength; ++x)
+                        {
+                            if (inputRow[x] != label)
+                                memset(imagePtr + mclong(x) * valueSize, 0, valueSize);
+                        }
+                    }
+                    imagePtr += mclong(rowLength) * valueSize;
                 }
-                theMsg->printf(QString("Cropping object%1").arg(idx));
-                crop(outputLabelLat, outputImageLat, boundarySize);
+                labelPtr += rowLength;
             }
         }
+    });
 
-        results.push_back(outputLabels);
-        if (outputImage)
+    std::vector<HxData*> results;
+    for (int i = 0; i < numLabels; ++i)
+    {
+        results.push_back(outputLabels[i]);
+        if (outputImages[i])
         {
-            results.push_back(outputImage);
+            results.push_back(outputImages[i]);
         }
     }
 
@@ -238,6 +357,10 @@ HxSplitLabelField::compute()
     const McDim3l dims = inputLabelLat->getDims();
 
     const HxUniformScalarField3* inputImage = hxconnection_cast<HxUniformScalarField3>(portImage);
+    if (inputImage && inputImage->lattice().getDims() != dims)
+    {
+        throw McException(QString("Image and label field must have the same dimensions"));
+    }
 
     const HxSpatialGraph* seeds = hxconnection_cast<HxSpatialGraph>(portSeeds);
 
@@ -1,10 +1,12 @@
 #include "HxTraceDijkstraMap.h"
+#include "HxShortestPathToPointMap.h"
 #include "FilopodiaFunctions.h"
 #include <hxfield/HxUniformScalarField3.h>
 #include <mclib/McException.h>
 #include <hxcore/HxObjectPool.h>
 
 #include "ConvertVectorAndMcDArray.h"
+#include "ParallelFor.h"
 
 HX_INIT_CLASS(HxTraceDijkstraMap,HxCompModule)
 
@@ -20,6 +22,9 @@ HxTraceDijkstraMap::~HxTraceDijkstraMap()
 {
 }
 
+namespace
+{
+
 HxSpatialGraph* getNodesOfGraphInTime(const HxSpatialGraph* graph, const int time=-1) {
 
     // Returns graph with all nodes
@@ -44,30 +49,81 @@ HxSpatialGraph* getNodesOfGraphInTime(const HxSpatialGraph* graph, const int tim
 
 }
 
-int getCenterNode(HxSpatialGraph* graph,
-                  const McHandle<HxUniformScalarField3> priorMap)
+// Returns whether voxel a comes after voxel b in an x-outer, z-inner scan.
+bool isScannedAfter(const McVec3i& a, const McVec3i& b)
 {
-    // Find voxel in prior map with prior = (0,0,0)
-    // This is the location of the point the shortest path was traced to
-
-    McHandle<HxCoord3> coords = priorMap->lattice().coords();
+    if (a.i != b.i) return a.i > b.i;
+    if (a.j != b.j) return a.j > b.j;
+    return a.k > b.k;
+}
 
-    unsigned char centerDirection = FilopodiaFunctions::vectorToDirection(McVec3i(0,0,0));
-    const McDim3l& dims = priorMap->lattice().getDims();
-    McVec3i centerPos = McVec3i(-1,-1,-1);
-
-    for (int x=0; x<dims.nx; ++x) {
-        for (int y=0; y<dims.ny; ++y) {
-            for (int z=0; z<dims.nz; ++z) {
-                int value;
-                priorMap->lattice().evalNative(x, y, z, &value);
-                if (value == centerDirection) {
-                    centerPos = McVec3i(x,y,z);
+// Returns the voxel with the given value in a field with x fastest layout. If there are
+// several, the one found last by an x-outer, z-inner scan is returned, as in older versions.
+template <typename T>
+McVec3i findVoxelWithValue(const T* data,
+                           const McDim3l& dims,
+                           const T value)
+{
+    const int numSlices = int(dims.nz);
+    const int numThreads = ParallelFor::getNumThreads(numSlices);
+    std::vector<McVec3i> found(numThreads, McVec3i(-1, -1, -1));
+
+    ParallelFor::runThreads(numThreads, [&](const int t) {
+        McVec3i& pos = found[t];
+        for (int z = numSlices * t / numThreads; z < numSlices * (t + 1) / numThreads; ++z) {
+            const T* slice = data + mclong(z) * dims.nx * dims.ny;
+            for (mclong i = 0; i < dims.nx * dims.ny; ++i) {
+                if (slice[i] == value) {
+                    const McVec3i candidate(int(i % dims.nx), int(i / dims.nx), z);
+                    if (pos.i < 0 || isScannedAfter(candidate, pos)) {
+                        pos = candidate;
+                    }
                 }
             }
         }
+    });
+
+    McVec3i centerPos(-1, -1, -1);
+    for (int t = 0; t < numThreads; ++t) {
+        if (found[t].i >= 0 && (centerPos.i < 0 || isScannedAfter(found[t], centerPos))) {
+            centerPos = found[t];
+        }
+    }
+    return centerPos;
+}
+
+McVec3i findCenterVoxel(const HxUniformScalarField3* priorMap)
+{
+    // The location of the point the shortest path was traced to is stored in the parameters of the map.
+    // Older maps are searched for the voxel with prior = (0,0,0).
+    McVec3i centerPos;
+    if (HxShortestPathToPointMap::getRootVoxel(priorMap, centerPos)) {
+        return centerPos;
     }
 
+    const int centerDirection = FilopodiaFunctions::vectorToDirection(McVec3i(0,0,0));
+    const McDim3l& dims = priorMap->lattice().getDims();
+    const void* data = priorMap->lattice().dataPtr();
+
+    switch (priorMap->primType()) {
+        case McPrimType::MC_UINT8:
+            return findVoxelWithValue((const mcuint8*)data, dims, mcuint8(centerDirection));
+        case McPrimType::MC_UINT16:
+            return findVoxelWithValue((const mcuint16*)data, dims, mcuint16(centerDirection));
+        case McPrimType::MC_INT32:
+            return findVoxelWithValue((const mcint32*)data, dims, mcint32(centerDirection));
+        default:
+            throw McException("Tracing error: unsupported data type of prior map.");
+    }
+}
+
+int getCenterNode(HxSpatialGraph* graph,
+                  const McHandle<HxUniformScalarField3> priorMap)
+{
+    McHandle<HxCoord3> coords = priorMap->lattice().coords();
+
+    const McVec3i centerPos = findCenterVoxel(priorMap);
+
     if (centerPos == McVec3i(-1,-1,-1)) {
         throw McException("Tracing error: center position not found.");
     }
@@ -157,6 +213,8 @@ void traceEndnodesToRoot(const McHandle<HxUniformScalarField3> priorMap,
     }
 }
 
+} // namespace
+
 void HxTraceDijkstraMap::compute() {
 
     if (!portAction.wasHit())
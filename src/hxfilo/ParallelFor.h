@@ -0,0 +1,94 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ParallelFor
+{
+    // Returns the number of threads for numItems independent work items:
+    // one per core, but at most one per item and at least one.
+    inline int
+    getNumThreads(const int numItems)
+    {
+        return std::max(1, std::min(int(std::thread::hardware_concurrency()), numItems));
+    }
+
+    // Calls function(t) for all t in [0, numThreads), each call on its own thread.
+    // The calling thread runs t = 0. Returns when all calls have finished and
+    // rethrows the first exception thrown by any of them.
+    template <typename Function>
+    void
+    runThreads(const int numThreads, Function function)
+    {
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto run = [&](const int t)
+        {
+            try
+            {
+                function(t);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 1; t < numThreads; ++t)
+            threads.push_back(std::thread(run, t));
+        run(0);
+        for (int t = 0; t < int(threads.size()); ++t)
+            threads[t].join();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // Calls function(i) for all i in [0, numItems) on getNumThreads(numItems) threads.
+    // The items are handed out one at a time, so they may take different times.
+    template <typename Function>
+    void
+    forEach(const int numItems, Function function)
+    {
+        std::atomic<int> nextItem(0);
+        runThreads(getNumThreads(numItems), [&](const int)
+        {
+            for (int i = nextItem++; i < numItems; i = nextItem++)
+                function(i);
+        });
+    }
+
+    // Returns the first item of range t of [0, numItems) split into numThreads
+    // contiguous ranges of almost equal size. Range t ends where range t + 1 begins.
+    template <typename Index>
+    Index
+    getRangeBegin(const Index numItems, const int numThreads, const int t)
+    {
+        return Index(static_cast<long long>(numItems) * t / numThreads);
+    }
+
+    // Calls function(begin, end) for one contiguous range of [0, numItems) per thread,
+    // on getNumThreads(numItems) threads. For items which all take the same time.
+    template <typename Index, typename Function>
+    void
+    forRanges(const Index numItems, Function function)
+    {
+        const int numThreads = getNumThreads(int(std::min(static_cast<long long>(numItems),
+                                                          static_cast<long long>(std::numeric_limits<int>::max()))));
+        runThreads(numThreads, [&](const int t)
+        {
+            function(getRangeBegin(numItems, numThreads, t), getRangeBegin(numItems, numThreads, t + 1));
+        });
+    }
+}
+
+#endif // PARALLELFOR_H
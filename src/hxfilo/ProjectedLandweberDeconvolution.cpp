@@ -0,0 +1,347 @@
+#include "ProjectedLandweberDeconvolution.h"
+#include "ParallelFor.h"
+#include <mclib/McException.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+void
+FFTPlan::init(const int n)
+{
+    mN = n;
+
+    // Pairs (p, m) of the radix p and the remaining length m of each stage
+    mFactors.clear();
+    int m = n;
+    const int radices[3] = { 2, 3, 5 };
+    for (int r = 0; r < 3; ++r)
+    {
+        while (m % radices[r] == 0)
+        {
+            m /= radices[r];
+            mFactors.push_back(radices[r]);
+            mFactors.push_back(m);
+        }
+    }
+    if (m != 1 || n < 1)
+    {
+        throw McException(QString("Invalid FFT size %1").arg(n));
+    }
+    if (n == 1)
+    {
+        mFactors.push_back(1);
+        mFactors.push_back(1);
+    }
+
+    mTwiddles.resize(n);
+    for (int k = 0; k < n; ++k)
+    {
+        const double phase = -2.0 * M_PI * double(k) / double(n);
+        mTwiddles[k] = Complex(float(cos(phase)), float(sin(phase)));
+    }
+}
+
+int
+FFTPlan::getFFTSize(const int minSize)
+{
+    for (int n = std::max(minSize, 1);; ++n)
+    {
+        int m = n;
+        while (m % 2 == 0)
+            m /= 2;
+        while (m % 3 == 0)
+            m /= 3;
+        while (m % 5 == 0)
+            m /= 5;
+        if (m == 1)
+            return n;
+    }
+}
+
+void
+FFTPlan::transform(const Complex* in, Complex* out) const
+{
+    work(out, in, 1, &mFactors[0]);
+}
+
+// Mixed radix decimation in time: the p interleaved subsequences of length m are
+// transformed recursively and then combined by a butterfly of radix p.
+void
+FFTPlan::work(Complex* out, const Complex* in, const int inStride, const int* factors) const
+{
+    const int p = factors[0];
+    const int m = factors[1];
+
+    if (m == 1)
+    {
+        for (int q = 0; q < p; ++q)
+        {
+            out[q] = in[q * inStride];
+        }
+    }
+    else
+    {
+        for (int q = 0; q < p; ++q)
+        {
+            work(out + q * m, in + q * inStride, inStride * p, factors + 2);
+        }
+    }
+
+    butterfly(out, inStride, m, p);
+}
+
+void
+FFTPlan::butterfly(Complex* out, const int fstride, const int m, const int p) const
+{
+    Complex scratch[5];
+
+    for (int u = 0; u < m; ++u)
+    {
+        for (int q = 0; q < p; ++q)
+        {
+            scratch[q] = out[u + q * m];
+        }
+
+        for (int q1 = 0; q1 < p; ++q1)
+        {
+            const int k = u + q1 * m;
+            Complex sum = scratch[0];
+            int twiddleIdx = 0;
+            for (int q = 1; q < p; ++q)
+            {
+                twiddleIdx += fstride * k;
+                twiddleIdx %= mN;
+                sum += scratch[q] * mTwiddles[twiddleIdx];
+            }
+            out[k] = sum;
+        }
+    }
+}
+
+
+ProjectedLandweberDeconvolution::ProjectedLandweberDeconvolution(const float* kernel,
+                                                                 const McDim3l& kernelDims,
+                                                                 const float alpha)
+    : mKernel(kernel, kernel + kernelDims.nbVoxel())
+    , mKernelDims(kernelDims)
+    , mAlpha(alpha)
+    , mImageDims(0, 0, 0)
+    , mPaddedDims(0, 0, 0)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < mKernel.size(); ++i)
+    {
+        sum += mKernel[i];
+    }
+    if (sum == 0.0)
+    {
+        throw McException(QString("Template must not sum up to zero"));
+    }
+    for (size_t i = 0; i < mKernel.size(); ++i)
+    {
+        mKernel[i] = float(mKernel[i] / sum);
+    }
+}
+
+// Computes the FFT plans and the transfer function of the kernel for images of the given size.
+void
+ProjectedLandweberDeconvolution::prepare(const McDim3l& dims)
+{
+    if (dims == mImageDims)
+    {
+        return;
+    }
+
+    mImageDims = dims;
+    int paddedDims[3];
+    for (int d = 0; d < 3; ++d)
+    {
+        const int radius = int(mKernelDims[d]) / 2;
+        paddedDims[d] = FFTPlan::getFFTSize(int(dims[d]) + 2 * radius);
+        mPlans[d].init(paddedDims[d]);
+    }
+    mPaddedDims = McDim3l(paddedDims[0], paddedDims[1], paddedDims[2]);
+
+    // The kernel center is moved to the origin, with cyclic wrap around.
+    mTransferFunction.assign(mPaddedDims.nbVoxel(), Complex(0.0f, 0.0f));
+    for (int z = 0; z < mKernelDims[2]; ++z)
+    {
+        for (int y = 0; y < mKernelDims[1]; ++y)
+        {
+            for (int x = 0; x < mKernelDims[0]; ++x)
+            {
+                const mclong px = (x - mKernelDims[0] / 2 + mPaddedDims[0]) % mPaddedDims[0];
+                const mclong py = (y - mKernelDims[1] / 2 + mPaddedDims[1]) % mPaddedDims[1];
+                const mclong pz = (z - mKernelDims[2] / 2 + mPaddedDims[2]) % mPaddedDims[2];
+                const mclong kernelIdx = (mclong(z) * mKernelDims[1] + y) * mKernelDims[0] + x;
+                mTransferFunction[(pz * mPaddedDims[1] + py) * mPaddedDims[0] + px] = mKernel[kernelIdx];
+            }
+        }
+    }
+    transform3D(&mTransferFunction[0], false);
+}
+
+// Transforms the padded volume along x, y and z. The inverse transform is not normalized.
+void
+ProjectedLandweberDeconvolution::transform3D(Complex* data, const bool inverse) const
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const FFTPlan& plan = mPlans[axis];
+        const mclong n = mPaddedDims[axis];
+        const mclong stride = (axis == 0) ? 1 : (axis == 1) ? mPaddedDims[0] : mPaddedDims[0] * mPaddedDims[1];
+        const mclong numGroups = mPaddedDims.nbVoxel() / (n * stride);
+
+        // Lines with consecutive start voxels are transformed together to access memory in blocks.
+        const mclong blockSize = (stride == 1) ? 1 : 16;
+        const mclong blocksPerGroup = (stride + blockSize - 1) / blockSize;
+
+        ParallelFor::forRanges(numGroups * blocksPerGroup, [&](const mclong begin, const mclong end)
+        {
+            std::vector<Complex> lines(blockSize * n);
+            std::vector<Complex> transformed(n);
+
+            for (mclong block = begin; block < end; ++block)
+            {
+                const mclong group = block / blocksPerGroup;
+                const mclong first = (block % blocksPerGroup) * blockSize;
+                const mclong numLines = std::min(blockSize, stride - first);
+                Complex* base = data + group * n * stride + first;
+
+                for (mclong k = 0; k < n; ++k)
+                {
+                    for (mclong j = 0; j < numLines; ++j)
+                    {
+                        const Complex value = base[k * stride + j];
+                        lines[j * n + k] = inverse ? std::conj(value) : value;
+                    }
+                }
+
+                for (mclong j = 0; j < numLines; ++j)
+                {
+                    plan.transform(&lines[j * n], &transformed[0]);
+                    for (mclong k = 0; k < n; ++k)
+                    {
+                        base[k * stride + j] = inverse ? std::conj(transformed[k]) : transformed[k];
+                    }
+                }
+            }
+        });
+    }
+}
+
+int
+ProjectedLandweberDeconvolution::deconvolve(const float* image,
+                                            const McDim3l& dims,
+                                            float* result,
+                                            const int maxNumIterations,
+                                            const float minRelativeChange)
+{
+    prepare(dims);
+
+    const mclong numPadded = mPaddedDims.nbVoxel();
+    const mclong offset[3] = { mKernelDims[0] / 2, mKernelDims[1] / 2, mKernelDims[2] / 2 };
+
+    // Pad the image with zero flux Neumann boundary conditions, i.e. by repeating the
+    // voxels at the border. The estimate starts with the padded image.
+    std::vector<float> estimate(numPadded);
+    ParallelFor::forRanges(mPaddedDims[1] * mPaddedDims[2], [&](const mclong begin, const mclong end)
+    {
+        for (mclong line = begin; line < end; ++line)
+        {
+            const mclong py = line % mPaddedDims[1];
+            const mclong pz = line / mPaddedDims[1];
+            const mclong y = std::min(std::max(py - offset[1], mclong(0)), mclong(dims[1]) - 1);
+            const mclong z = std::min(std::max(pz - offset[2], mclong(0)), mclong(dims[2]) - 1);
+            const float* row = image + (z * dims[1] + y) * dims[0];
+            float* paddedRow = &estimate[line * mPaddedDims[0]];
+            for (mclong px = 0; px < mPaddedDims[0]; ++px)
+            {
+                const mclong x = std::min(std::max(px - offset[0], mclong(0)), mclong(dims[0]) - 1);
+                paddedRow[px] = row[x];
+            }
+        }
+    });
+
+    std::vector<Complex> imageTransform(numPadded);
+    ParallelFor::forRanges(numPadded, [&](const mclong begin, const mclong end)
+    {
+        for (mclong i = begin; i < end; ++i)
+            imageTransform[i] = estimate[i];
+    });
+    transform3D(&imageTransform[0], false);
+
+    std::vector<Complex> work(numPadded);
+    const float scale = mAlpha / float(numPadded);
+
+    int iter = 0;
+    while (iter < maxNumIterations)
+    {
+        ParallelFor::forRanges(numPadded, [&](const mclong begin, const mclong end)
+        {
+            for (mclong i = begin; i < end; ++i)
+                work[i] = estimate[i];
+        });
+        transform3D(&work[0], false);
+
+        ParallelFor::forRanges(numPadded, [&](const mclong begin, const mclong end)
+        {
+            for (mclong i = begin; i < end; ++i)
+            {
+                const Complex& h = mTransferFunction[i];
+                work[i] = std::conj(h) * (imageTransform[i] - h * work[i]);
+            }
+        });
+        transform3D(&work[0], true);
+
+        // Each thread sums up its own range, the partial sums are added in a fixed order.
+        const int numThreads = ParallelFor::getNumThreads(int(std::min(numPadded, mclong(std::numeric_limits<int>::max()))));
+        std::vector<double> threadChange(numThreads, 0.0);
+        std::vector<double> threadNorm(numThreads, 0.0);
+        ParallelFor::runThreads(numThreads, [&](const int t)
+        {
+            const mclong begin = ParallelFor::getRangeBegin(numPadded, numThreads, t);
+            const mclong end = ParallelFor::getRangeBegin(numPadded, numThreads, t + 1);
+            double change = 0.0;
+            double norm = 0.0;
+            for (mclong i = begin; i < end; ++i)
+            {
+                const float oldValue = estimate[i];
+                const float newValue = std::max(oldValue + scale * work[i].real(), 0.0f);
+                change += double(newValue - oldValue) * double(newValue - oldValue);
+                norm += double(oldValue) * double(oldValue);
+                estimate[i] = newValue;
+            }
+            threadChange[t] = change;
+            threadNorm[t] = norm;
+        });
+
+        double change = 0.0;
+        double norm = 0.0;
+        for (int t = 0; t < numThreads; ++t)
+        {
+            change += threadChange[t];
+            norm += threadNorm[t];
+        }
+
+        ++iter;
+
+        if (minRelativeChange > 0.0f && (norm == 0.0 || std::sqrt(change / norm) < minRelativeChange))
+        {
+            break;
+        }
+    }
+
+    for (mclong z = 0; z < dims[2]; ++z)
+    {
+        for (mclong y = 0; y < dims[1]; ++y)
+        {
+            const float* paddedRow = &estimate[((z + offset[2]) * mPaddedDims[1] + y + offset[1]) * mPaddedDims[0] + offset[0]];
+            std::copy(paddedRow, paddedRow + dims[0], result + (z * dims[1] + y) * dims[0]);
+        }
+    }
+
+    return iter;
+}
@@ -0,0 +1,70 @@
+#ifndef PROJECTEDLANDWEBERDECONVOLUTION_H
+#define PROJECTEDLANDWEBERDECONVOLUTION_H
+
+#include <mclib/McDim3l.h>
+#include <complex>
+#include <vector>
+
+/* FFT of a fixed length, with factors 2, 3 and 5 only.
+ * The twiddle factors are computed once and reused for every transform.
+ */
+class FFTPlan {
+public:
+    typedef std::complex<float> Complex;
+
+    void init(const int n);
+    int size() const { return mN; }
+
+    // Computes the unnormalized forward transform of the n values in into out.
+    void transform(const Complex* in, Complex* out) const;
+
+    // Returns the smallest n >= minSize with factors 2, 3 and 5 only.
+    static int getFFTSize(const int minSize);
+
+private:
+    void work(Complex* out, const Complex* in, const int inStride, const int* factors) const;
+    void butterfly(Complex* out, const int fstride, const int m, const int p) const;
+
+    int mN;
+    std::vector<int> mFactors;
+    std::vector<Complex> mTwiddles;
+};
+
+
+/* Projected Landweber deconvolution of float images with a fixed point spread function,
+ * with the same model as ITK's ProjectedLandweberDeconvolutionImageFilter: the kernel is
+ * normalized, the image is padded by the kernel radius with zero flux Neumann boundary
+ * conditions, the estimate starts with the image and is clamped to non-negative values
+ * after each iteration.
+ *
+ * The FFT plans and the transform of the kernel are computed for the padded image size
+ * and reused for all images of the same size, e.g. all time steps of a movie.
+ * The FFTs and all voxel-wise operations use all cores.
+ */
+class ProjectedLandweberDeconvolution {
+public:
+    typedef std::complex<float> Complex;
+
+    ProjectedLandweberDeconvolution(const float* kernel, const McDim3l& kernelDims, const float alpha = 0.1f);
+
+    // Deconvolves image and writes the result to result, which must have the size of image.
+    // Stops after maxNumIterations or as soon as the relative change of the estimate in an
+    // iteration is below minRelativeChange. Returns the number of iterations done.
+    int deconvolve(const float* image, const McDim3l& dims, float* result,
+                   const int maxNumIterations, const float minRelativeChange);
+
+private:
+    void prepare(const McDim3l& dims);
+    void transform3D(Complex* data, const bool inverse) const;
+
+    std::vector<float> mKernel;
+    McDim3l mKernelDims;
+    float mAlpha;
+
+    McDim3l mImageDims;
+    McDim3l mPaddedDims;
+    FFTPlan mPlans[3];
+    std::vector<Complex> mTransferFunction;
+};
+
+#endif
@@ -3,10 +3,10 @@
 #include "HxFilopodiaTrack.h"
 #include "HxFilopodiaStats.h"
 #include "HxShortestPathToPointMap.h"
-#include "HxSplitLabelField.h"
 #include "hxcontourtree/HxContourTreeSegmentation.h"
 #include <hxspreadsheet/internal/HxSpreadSheet.h>
 #include <hxfield/HxLoc3Uniform.h>
+#include <hxfield/HxLoc3Regular.h>
 #include "FilopodiaFunctions.h"
 #include "hxneuroneditor/internal/HxMPRViewer.h"
 #include <hxcore/HxObjectPool.h>
@@ -1204,7 +1204,197 @@ QxFilopodiaTool::boxSpinBoxChanged()
     updateBoxDragger();
 }
 
+template <typename T>
+void
+computeLabelBoundingBoxes(const T* labels,
+                          const McDim3l& dims,
+                          std::vector<McVec3i>& boxMin,
+                          std::vector<McVec3i>& boxMax)
+{
+    const McVec3i emptyMin(int(dims.nx), int(dims.ny), int(dims.nz));
+    const McVec3i emptyMax(-1, -1, -1);
+
+    mculong i = 0;
+    for (int z = 0; z < dims.nz; ++z)
+    {
+        for (int y = 0; y < dims.ny; ++y)
+        {
+            for (int x = 0; x < dims.nx; ++x, ++i)
+            {
+                if (labels[i] <= 0)
+                {
+                    continue;
+                }
+
+                const size_t label = size_t(labels[i]);
+                if (label >= boxMin.size())
+                {
+                    boxMin.resize(label + 1, emptyMin);
+                    boxMax.resize(label + 1, emptyMax);
+                }
+
+                McVec3i& min = boxMin[label];
+                McVec3i& max = boxMax[label];
+                min.i = MC_MIN2(min.i, x);
+                min.j = MC_MIN2(min.j, y);
+                min.k = MC_MIN2(min.k, z);
+                max.i = MC_MAX2(max.i, x);
+                max.j = MC_MAX2(max.j, y);
+                max.k = MC_MAX2(max.k, z);
+            }
+        }
+    }
+}
+
 // CTS - contour tree segmentation
+// Computes the segmentation of a time step and the bounding boxes of all its labels in one pass.
+TimeStepSegmentation
+computeTimeStepSegmentation(HxUniformScalarField3* image,
+                            const int threshold,
+                            const int persistence)
+{
+    TimeStepSegmentation segmentation;
+    segmentation.image = image;
+    segmentation.threshold = threshold;
+    segmentation.persistence = persistence;
+
+    McHandle<HxContourTreeSegmentation> contourTreeSegmentation = HxContourTreeSegmentation::createInstance();
+    contourTreeSegmentation->portData.connect(image);
+    contourTreeSegmentation->portAutoSetValues.setValue(0, false);
+    contourTreeSegmentation->fire();
+    contourTreeSegmentation->portThreshold.setMinMax(0, 255);
+    contourTreeSegmentation->portThreshold.setValue(threshold);
+    contourTreeSegmentation->portPersistenceValue.setValue(persistence);
+    contourTreeSegmentation->portMinimalSegmentSize.setValue(1000);
+    contourTreeSegmentation->fire();
+    contourTreeSegmentation->portDoIt.hit();
+    contourTreeSegmentation->fire();
+
+    segmentation.labels = dynamic_cast<HxUniformLabelField3*>(contourTreeSegmentation->getResult());
+    if (!segmentation.labels)
+    {
+        return segmentation;
+    }
+
+    segmentation.labels->setLabel("Segmentation");
+
+    HxLabelLattice3* labelLat = (HxLabelLattice3*)segmentation.labels->getInterface(HxLabelLattice3::getClassTypeId());
+    const McDim3l dims = labelLat->getDims();
+
+    if (labelLat->primType() == McPrimType::MC_UINT8)
+    {
+        computeLabelBoundingBoxes(labelLat->getLabels(), dims, segmentation.labelBoxMin, segmentation.labelBoxMax);
+    }
+    else if (labelLat->primType() == McPrimType::MC_INT32)
+    {
+        computeLabelBoundingBoxes((const int*)labelLat->getLabels(), dims, segmentation.labelBoxMin, segmentation.labelBoxMax);
+    }
+
+    return segmentation;
+}
+
+// Returns the label of the segmentation at the seed, or 0 if the seed is outside or in the exterior.
+int
+getLabelAtSeed(const TimeStepSegmentation& segmentation,
+               const McVec3f& seedCoords)
+{
+    HxLabelLattice3* labelLat = (HxLabelLattice3*)segmentation.labels->getInterface(HxLabelLattice3::getClassTypeId());
+    const McDim3l dims = labelLat->getDims();
+
+    HxLoc3Regular* location = labelLat->coords()->createLocation();
+    location->move(seedCoords);
+    const McVec3i gridCoords(location->getIx(), location->getIy(), location->getIz());
+    delete location;
+
+    if (gridCoords.i < 0 || gridCoords.i >= dims.nx ||
+        gridCoords.j < 0 || gridCoords.j >= dims.ny ||
+        gridCoords.k < 0 || gridCoords.k >= dims.nz)
+    {
+        return 0;
+    }
+
+    const mclong index = dims.nx * dims.ny * gridCoords.k + dims.nx * gridCoords.j + gridCoords.i;
+
+    if (labelLat->primType() == McPrimType::MC_UINT8)
+    {
+        return labelLat->getLabels()[index];
+    }
+    else if (labelLat->primType() == McPrimType::MC_INT32)
+    {
+        return ((const int*)labelLat->getLabels())[index];
+    }
+
+    return 0;
+}
+
+// Returns false if there is no voxel with this label.
+bool
+getCropBoxOfLabel(const TimeStepSegmentation& segmentation,
+                  const int label,
+                  const int boundarySize,
+                  McVec3i& cropMin,
+                  McVec3i& cropMax)
+{
+    if (label <= 0 || label >= int(segmentation.labelBoxMin.size()))
+    {
+        return false;
+    }
+
+    const McVec3i& boxMin = segmentation.labelBoxMin[label];
+    const McVec3i& boxMax = segmentation.labelBoxMax[label];
+    if (boxMin.i > boxMax.i)
+    {
+        return false;
+    }
+
+    const McDim3l dims = segmentation.labels->lattice().getDims();
+    for (int i = 0; i <= 2; ++i)
+    {
+        cropMin[i] = MC_MAX2(0, boxMin[i] - boundarySize);
+        cropMax[i] = MC_MIN2(int(dims[i]) - 1, boxMax[i] + boundarySize);
+    }
+
+    return true;
+}
+
+template <typename T>
+void
+clearOtherLabels(T* labels, const mculong numVoxels, const T label)
+{
+    for (mculong i = 0; i < numVoxels; ++i)
+    {
+        if (labels[i] != label)
+        {
+            labels[i] = 0;
+        }
+    }
+}
+
+// Crops the segmentation to the bounding box of a label and clears all other labels.
+McHandle<HxUniformLabelField3>
+cropLabel(const TimeStepSegmentation& segmentation,
+          const int label,
+          McVec3i cropMin,
+          McVec3i cropMax)
+{
+    McHandle<HxUniformLabelField3> croppedLabels = segmentation.labels->duplicate();
+    HxLabelLattice3* croppedLabelLat = (HxLabelLattice3*)croppedLabels->getInterface(HxLabelLattice3::getClassTypeId());
+    croppedLabelLat->crop(&cropMin[0], &cropMax[0], NULL);
+
+    const mculong numVoxels = croppedLabelLat->getDims().nbVoxel();
+
+    if (croppedLabelLat->primType() == McPrimType::MC_UINT8)
+    {
+        clearOtherLabels(croppedLabelLat->getLabels(), numVoxels, (unsigned char)label);
+    }
+    else if (croppedLabelLat->primType() == McPrimType::MC_INT32)
+    {
+        clearOtherLabels((int*)croppedLabelLat->getLabels(), numVoxels, label);
+    }
+
+    return croppedLabels;
+}
+
 void
 QxFilopodiaTool::autoEstimateBoundingBoxes()
 {
@@ -1221,6 +1411,17 @@ QxFilopodiaTool::autoEstimateBoundingBoxes()
     const int threshold = getThreshold();
     const int persistence = getPersistence();
 
+    if (!mSegmentation.isComputedFor(mImage, threshold, persistence))
+    {
+        mSegmentation = computeTimeStepSegmentation(mImage, threshold, persistence);
+    }
+
+    if (!mSegmentation.labels)
+    {
+        HxMessage::warning(QString("Cannot create segmentation in time step %1.").arg(mCurrentTime), "ok");
+        return;
+    }
+
     const int numberOfGrowthCones = FilopodiaFunctions::getNumberOfGrowthCones(rootNodesGraph);
 
     for (int n = 0; n < numberOfGrowthCones; ++n)
@@ -1236,42 +1437,11 @@ QxFilopodiaTool::autoEstimateBoundingBoxes()
             continue;
         }
 
-        McHandle<HxContourTreeSegmentation> contourTreeSegmentation = HxContourTreeSegmentation::createInstance();
-        contourTreeSegmentation->portData.connect(mImage);
-        contourTreeSegmentation->portAutoSetValues.setValue(0, false);
-        contourTreeSegmentation->fire();
-        contourTreeSegmentation->portThreshold.setMinMax(0, 255);
-        contourTreeSegmentation->portThreshold.setValue(threshold);
-        contourTreeSegmentation->portPersistenceValue.setValue(persistence);
-        contourTreeSegmentation->portMinimalSegmentSize.setValue(1000);
-        contourTreeSegmentation->fire();
-        contourTreeSegmentation->portDoIt.hit();
-        contourTreeSegmentation->fire();
-
-        McHandle<HxUniformLabelField3> labels = dynamic_cast<HxUniformLabelField3*>(contourTreeSegmentation->getResult());
-        if (!labels)
-        {
-            HxMessage::warning(QString("Cannot create segmentation for growth cone %1 in time step %2.").arg(growthConeId).arg(mCurrentTime), "ok");
-            continue;
-        }
-
-        labels->setLabel("Labels");
-
-        SpatialGraphSelection singleRootSel(rootNodesGraph);
-        singleRootSel.selectVertex(v);
-        McHandle<HxSpatialGraph> singleRootGraph = rootNodesGraph->getSubgraph(singleRootSel);
-
-        McHandle<HxSplitLabelField> splitLabelField = HxSplitLabelField::createInstance();
-        splitLabelField->portData.connect(labels);
-        splitLabelField->portImage.connect(mImage);
-        splitLabelField->portSeeds.connect(singleRootGraph);
-        splitLabelField->portBoundarySize.setValue(10);
-        splitLabelField->fire();
-        splitLabelField->portDoIt.hit();
-        splitLabelField->fire();
+        const McVec3f rootCoords = rootNodesGraph->getVertexCoords(v);
+        const int label = getLabelAtSeed(mSegmentation, rootCoords);
 
-        McHandle<HxUniformLabelField3> croppedLabels = dynamic_cast<HxUniformLabelField3*>(splitLabelField->getResult(0));
-        if (!croppedLabels)
+        McVec3i cropMin, cropMax;
+        if (!getCropBoxOfLabel(mSegmentation, label, 10, cropMin, cropMax))
         {
             HxMessage::warning(QString("Cannot crop growth cone %1 in time step %2: Growth cone center is not in object.\nPlease move seed and redo cropping.\n")
                                    .arg(growthConeId)
@@ -1280,20 +1450,13 @@ QxFilopodiaTool::autoEstimateBoundingBoxes()
             continue;
         }
 
-        croppedLabels->setLabel("CroppedLabels");
-
-        const McDim3l dims = croppedLabels->lattice().getDims();
-        const McVec3f rootCoords = rootNodesGraph->getVertexCoords(v);
         const McDim3l rootVoxel = FilopodiaFunctions::getNearestVoxelCenterFromPointCoords(rootCoords, mImage);
 
-        const McVec3f croppedLabelsBoxMin = croppedLabels->getBoundingBox().getMin();
-        const McDim3l croppedLabelsBoxMinVoxel = FilopodiaFunctions::getNearestVoxelCenterFromPointCoords(croppedLabelsBoxMin, mImage);
-
         BoxSpec spec;
         for (int i = 0; i <= 2; ++i)
         {
-            spec.size[i] = dims[i];
-            spec.offset[i] = croppedLabelsBoxMinVoxel[i] - rootVoxel[i];
+            spec.size[i] = cropMax[i] - cropMin[i] + 1;
+            spec.offset[i] = cropMin[i] - rootVoxel[i];
         }
 
         mBoxSpecs.insert(growthConeId, spec);
@@ -2040,6 +2203,7 @@ QxFilopodiaTool::updateFiles()
 {
     mImages.clear();
     mDijkstras.clear();
+    mSegmentation = TimeStepSegmentation();
 
     try
     {
@@ -2547,7 +2711,8 @@ prepareFilesForOneNode(HxSpatialGraph* graph,
                        QMap<int, McHandle<HxUniformScalarField3> > images,
                        QString outputDir,
                        const int threshold,
-                       const int persistence)
+                       const int persistence,
+                       TimeStepSegmentation& segmentation)
 {
     const int nodeId = nodeSel.getSelectedVertex(0);
 
@@ -2565,38 +2730,17 @@ prepareFilesForOneNode(HxSpatialGraph* graph,
     QString gcFolder = QString(outputDir + "/GrowthCone_%1").arg(gcId);
 
     HxUniformScalarField3* currentImage = images.value(currentTime);
-    McHandle<HxSpatialGraph> seeds = HxSpatialGraph::createInstance();
-    seeds = graph->getSubgraph(nodeSel);
 
-    // Compute segmentation
-    McHandle<HxContourTreeSegmentation> contourTreeSegmentation = HxContourTreeSegmentation::createInstance();
-    contourTreeSegmentation->portData.connect(currentImage);
-    contourTreeSegmentation->portAutoSetValues.setValue(0, false);
-    contourTreeSegmentation->fire();
-    contourTreeSegmentation->portThreshold.setMinMax(0, 255);
-    contourTreeSegmentation->portThreshold.setValue(threshold);
-    contourTreeSegmentation->portPersistenceValue.setValue(persistence);
-    contourTreeSegmentation->portMinimalSegmentSize.setValue(1000);
-    contourTreeSegmentation->fire();
-    contourTreeSegmentation->portDoIt.hit();
-    contourTreeSegmentation->fire();
+    // Compute segmentation, unless a previous node of this time step did
+    if (!segmentation.isComputedFor(currentImage, threshold, persistence))
+    {
+        segmentation = computeTimeStepSegmentation(currentImage, threshold, persistence);
+    }
 
-    McHandle<HxUniformLabelField3> segmentation = dynamic_cast<HxUniformLabelField3*>(contourTreeSegmentation->getResult());
-    if (!segmentation)
+    if (!segmentation.labels)
     {
         throw McException("Could not create contour tree segmentation");
     }
-    segmentation->setLabel("Segmentation");
-
-    // Split data
-    McHandle<HxSplitLabelField> splitLabelField = HxSplitLabelField::createInstance();
-    splitLabelField->portData.connect(segmentation);
-    splitLabelField->portImage.connect(currentImage);
-    splitLabelField->portSeeds.connect(seeds);
-    splitLabelField->portBoundarySize.setValue(10);
-    splitLabelField->fire();
-    splitLabelField->portDoIt.hit();
-    splitLabelField->fire();
 
     QString labelName;
     QString grayName;
@@ -2624,22 +2768,23 @@ prepareFilesForOneNode(HxSpatialGraph* graph,
         QDir().mkdir(grayFolder);
     }
 
-    McHandle<HxUniformLabelField3> label = dynamic_cast<HxUniformLabelField3*>(splitLabelField->getResult(0));
-    if (!label)
+    // Crop data
+    const int seedLabel = getLabelAtSeed(segmentation, graph->getVertexCoords(nodeId));
+
+    McVec3i cropMin, cropMax;
+    if (!getCropBoxOfLabel(segmentation, seedLabel, 10, cropMin, cropMax))
     {
         HxMessage::warning(QString("Cannot crop growthcone %1 in time step %2: Growth cone center is not in object.\nPlease move seed and redo cropping.\n").arg(gcId).arg(currentTime), "ok");
         theMsg->printf("Please move node of growth cone %i in time step %i", gcId, currentTime);
         return;
     }
+
+    McHandle<HxUniformLabelField3> label = cropLabel(segmentation, seedLabel, cropMin, cropMax);
     label->setLabel(labelName);
     label->writeAmiraMeshRLE(qPrintable(labelFolder + "/" + labelName));
 
-    McHandle<HxUniformScalarField3> gray = dynamic_cast<HxUniformScalarField3*>(splitLabelField->getResult(1));
-    if (!gray)
-    {
-        HxMessage::warning(QString("Cannot crop growthcone %1 in time step %2: Growth cone center is not in object.\nPlease move seed and redo cropping.\n").arg(gcId).arg(currentTime), "ok");
-        return;
-    }
+    McHandle<HxUniformScalarField3> gray = currentImage->duplicate();
+    gray->lattice().crop(&cropMin[0], &cropMax[0], NULL);
     gray->setLabel(grayName);
     gray->writeAmiraMeshBinary(qPrintable(grayFolder + "/" + grayName));
 }
@@ -2718,15 +2863,26 @@ QxFilopodiaTool::prepareFiles()
     const float intensityWeight = getIntensityWeight();
     const int topBrightness = getTopBrightness();
 
+    // Nodes of the same time step share one segmentation, so they are processed together
+    QMap<int, QList<int> > nodesPerTime;
     for (int i = 0; i < nodeSel.getNumSelectedVertices(); ++i)
     {
-        SpatialGraphSelection centerSel(centerGraph);
-        centerSel.selectVertex(nodeSel.getSelectedVertex(i));
-        prepareFilesForOneNode(centerGraph, centerSel, mImages, mOutputDir, mUi.threshLineEdit->text().toInt(), mUi.persistenceLineEdit->text().toInt());
+        const int v = nodeSel.getSelectedVertex(i);
+        nodesPerTime[FilopodiaFunctions::getTimeOfNode(centerGraph, v)].append(v);
+    }
+
+    for (QMap<int, QList<int> >::const_iterator it = nodesPerTime.constBegin(); it != nodesPerTime.constEnd(); ++it)
+    {
+        for (int i = 0; i < it.value().size(); ++i)
+        {
+            SpatialGraphSelection centerSel(centerGraph);
+            centerSel.selectVertex(it.value()[i]);
+            prepareFilesForOneNode(centerGraph, centerSel, mImages, mOutputDir, mUi.threshLineEdit->text().toInt(), mUi.persistenceLineEdit->text().toInt(), mSegmentation);
 
-        McHandle<HxSpatialGraph> subGraph = HxSpatialGraph::createInstance();
-        subGraph = centerGraph->getSubgraph(centerSel);
-        computeDijkstra(subGraph, mOutputDir, intensityWeight, topBrightness);
+            McHandle<HxSpatialGraph> subGraph = HxSpatialGraph::createInstance();
+            subGraph = centerGraph->getSubgraph(centerSel);
+            computeDijkstra(subGraph, mOutputDir, intensityWeight, topBrightness);
+        }
     }
 }
 
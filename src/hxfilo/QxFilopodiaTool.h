@@ -26,6 +26,25 @@ struct BoxSpec {
     McVec3i size;
 };
 
+// Contour tree segmentation of the image of one time step together with the voxel
+// bounding box of each label. It does not depend on the growth cone, so all growth
+// cones of a time step share it.
+struct TimeStepSegmentation {
+    TimeStepSegmentation() : threshold(-1), persistence(-1) {}
+
+    bool isComputedFor(const HxUniformScalarField3* img, const int thresh, const int pers) const {
+        return labels && (image == img) && (threshold == thresh) && (persistence == pers);
+    }
+
+    McHandle<HxUniformScalarField3> image;
+    int threshold;
+    int persistence;
+
+    McHandle<HxUniformLabelField3> labels;
+    std::vector<McVec3i> labelBoxMin; // Indexed by label; min > max for unused labels
+    std::vector<McVec3i> labelBoxMax;
+};
+
 
 class HXFILOPODIA_API QxFilopodiaTool  : public QObject, public QxNeuronEditorToolBox {
     
@@ -110,6 +129,7 @@ private:
 
         McHandle<SoTabBoxDraggerVR>     mBoxDragger;
         QMap<int, BoxSpec>              mBoxSpecs;
+        TimeStepSegmentation            mSegmentation;
 
         void updateFiles();
         void updateTimeMinMax();
@@ -9,6 +9,10 @@
 
 
 
+template <typename T>
+struct IndexValueAbstractBaseComparator;
+
+
 template <typename T>
 class IndexValueComparator
 {
@@ -52,7 +56,7 @@ struct IndexValueAbstractBaseComparator
 
 
 template <typename T>
-struct IndexValueSmallerComparator : IndexValueAbstractBaseComparator<T>
+struct IndexValueSmallerComparator final : IndexValueAbstractBaseComparator<T>
 {
     inline bool operator ()(const std::pair<size_t, T>& a, const std::pair<size_t, T>& b) const override
     {
@@ -67,7 +71,7 @@ struct IndexValueSmallerComparator : IndexValueAbstractBaseComparator<T>
 
 
 template <typename T>
-struct IndexValueGreaterComparator : IndexValueAbstractBaseComparator<T>
+struct IndexValueGreaterComparator final : IndexValueAbstractBaseComparator<T>
 {
     inline bool operator ()(const std::pair<size_t, T>& a, const std::pair<size_t, T>& b) const override
     {
@@ -83,6 +87,24 @@ struct IndexValueGreaterComparator : IndexValueAbstractBaseComparator<T>
 
 
 
+// Inverts a comparator policy that is passed as template parameter, e.g. for sorting neighbours in the
+// merge tree sweep. Unlike IndexValueInvertedComparator, the calls are not dispatched through the vtable.
+template <typename T, typename Comparator>
+class IndexValueInvertedPolicyComparator
+{
+public:
+    IndexValueInvertedPolicyComparator(const Comparator& comparator) : m_comparator(comparator) {}
+
+    inline bool operator ()(const std::pair<size_t, T>& a, const std::pair<size_t, T>& b) const { return m_comparator(b, a); }
+    inline bool operator ()(const T a, const T b) const { return m_comparator(b, a); }
+
+private:
+    const Comparator& m_comparator;
+};
+
+
+
+
 template <typename T>
 class OutOfRangeChecker
 {
@@ -16,12 +16,15 @@
 #include <hxplot/PzMarkerline.h>
 #include <hxplot/PzCurve.h>
 
+#include <hxspreadsheet/internal/HxSpreadSheet.h>
+
 #include <hxcontourtree/AugmentedContourTree.h>
 
 #include "HxContourTreeSegmentation.h"
 #include "SimplicialMesh3DForHexahedralMesh.h"
 
 #include <algorithm>
+#include <cmath>
 
 template <typename T>
 int
@@ -54,6 +57,43 @@ enum PersModes
     PERS_ADAPTIVE
 };
 
+HxContourTreeSegmentation::PersistencePair
+createPersistencePair(const float maxValueOfComponent,
+                      const float mergeValue,
+                      const float totalMin,
+                      const bool localRelative,
+                      const bool mergedBecauseOfSize)
+{
+    HxContourTreeSegmentation::PersistencePair pair;
+    pair.birth = maxValueOfComponent;
+    pair.death = mergeValue;
+    if (localRelative)
+        pair.persistence = (maxValueOfComponent - mergeValue) / (maxValueOfComponent - totalMin);
+    else
+        pair.persistence = (maxValueOfComponent - mergeValue);
+    pair.mergedBecauseOfSize = mergedBecauseOfSize;
+    return pair;
+}
+
+// Pairs merged because of their size first, then by increasing persistence.
+// The relative persistence of a component whose maximum is the total minimum
+// is NaN. The segmentation never merges such a component by persistence, so
+// these pairs come last.
+bool
+comparePersistencePairs(const HxContourTreeSegmentation::PersistencePair& a,
+                        const HxContourTreeSegmentation::PersistencePair& b)
+{
+    if (a.mergedBecauseOfSize != b.mergedBecauseOfSize)
+        return a.mergedBecauseOfSize;
+
+    const bool aIsNaN = std::isnan(a.persistence);
+    const bool bIsNaN = std::isnan(b.persistence);
+    if (aIsNaN || bIsNaN)
+        return !aIsNaN && bIsNaN;
+
+    return a.persistence < b.persistence;
+}
+
 HX_INIT_CLASS(HxContourTreeSegmentation, HxCompModule);
 
 HxContourTreeSegmentation::HxContourTreeSegmentation()
@@ -97,6 +137,9 @@ HxContourTreeSegmentation::HxContourTreeSegmentation()
     m_recomputeHistogram = true;
     m_plotParametersChanged = true;
     m_needFastSegmentationInitialization = true;
+    m_needMergeSweepInitialization = true;
+    m_mergeSweepSortByValue = false;
+    m_mergeSweepTotalMin = 0.f;
 
     m_inputField = 0;
     m_contourTree = 0;
@@ -114,6 +157,7 @@ HxContourTreeSegmentation::update()
     {
         m_recomputeHistogram = true;
         m_plotParametersChanged = true;
+        m_needMergeSweepInitialization = true;
 
         m_inputField = hxconnection_cast<HxUniformScalarField3>(portData);
         if (m_inputField)
@@ -170,11 +214,13 @@ HxContourTreeSegmentation::update()
     {
         m_plotParametersChanged = true;
         m_needFastSegmentationInitialization = true;
+        m_needMergeSweepInitialization = true;
     }
 
     if (portSortNeighborsBy.isNew())
     {
         m_plotParametersChanged = true;
+        m_needMergeSweepInitialization = true;
     }
 }
 
@@ -256,11 +302,15 @@ HxContourTreeSegmentation::compute()
         }
         else
         {
-            // Normal segmentation: iterate over whole data set
+            // Normal segmentation: iterate over whole data set.
+            // Sorting and neighborhood queries only depend on the threshold,
+            // so they are done once and replayed for every new persistence value.
             float persistenceValue = getPersistenceValue();
             const mculong minNumberVoxels = (mculong)portMinimalSegmentSize.getValue();
+            if (m_needMergeSweepInitialization && !initMergeSweep())
+                return;
             initOutputLabelField();
-            computeSegmentation(persistenceValue, minNumberVoxels);
+            computeSegmentationFromMergeSweep(persistenceValue, minNumberVoxels);
         }
     }
 
@@ -327,7 +377,9 @@ HxContourTreeSegmentation::initOutputLabelField()
 }
 
 // This plot computation is only working for the standard contour tree segmentation
-// not the fast version
+// not the fast version.
+// The sweep only collects one persistence pair per merge, the curve is then
+// evaluated from the sorted pairs instead of updating all plot points per merge.
 void
 HxContourTreeSegmentation::calculatePlot()
 {
@@ -336,86 +388,74 @@ HxContourTreeSegmentation::calculatePlot()
 
     McWatch watch;
 
-    theWorkArea->startWorking("Initializing data ...");
+    if (m_needMergeSweepInitialization && !initMergeSweep())
+        return;
 
-    m_mesh->setThreshold(portThreshold.getValue());
+    theWorkArea->startWorking("Calculating plot ...");
 
-    std::vector<mculong> sortedNodeIdx;
-    const bool increasingOrder = false;
-    m_mesh->getSortedListOfVertices(increasingOrder, sortedNodeIdx);
+    const mculong numNodes = m_mergeSweepSortedNodeIdx.size();
 
     SetUnionDataStructure setUnion;
-    setUnion.setNumElements(sortedNodeIdx.size());
+    setUnion.setNumElements(numNodes);
 
-    std::vector<float> maxValuesOfComponent(sortedNodeIdx.size());
-    std::vector<mculong> sizeOfComponent(sortedNodeIdx.size());
-    std::vector<mculong> neighbors;
+    std::vector<float> maxValuesOfComponent(numNodes);
+    std::vector<mculong> sizeOfComponent(numNodes);
     std::vector<mculong> sortedNeighborIds;
-    std::vector<float> values;
+    std::vector<mculong> numNeighborsWithEqualLabel;
 
-    std::vector<float> persistanceValues;
-    std::vector<float> numberOfSegments;
-    const float maxPersistanceValue = getPersistenceValue();
-    const mclong numberOfPlotPoints = 10000;
-    persistanceValues.resize(numberOfPlotPoints);
-    numberOfSegments.resize(numberOfPlotPoints);
-    float binSize = maxPersistanceValue / (numberOfPlotPoints - 1);
-    for (int i = 0; i < numberOfPlotPoints; i++)
-    {
-        persistanceValues[i] = i * binSize;
-        numberOfSegments[i] = 0;
-    }
+    std::vector<PersistencePair> persistencePairs;
 
     mclong numberOfMaxima = 0;
 
     const mculong minNumberVoxels = (mculong)portMinimalSegmentSize.getValue();
 
-    bool localRelative = (portPersistenceMode.getValue() == PERS_ADAPTIVE);
-    float totalMin, totalMax;
-    m_inputField->lattice().computeRange(totalMin, totalMax);
+    const bool localRelative = (portPersistenceMode.getValue() == PERS_ADAPTIVE);
+    const float totalMin = m_mergeSweepTotalMin;
 
-    theWorkArea->setProgressInfo("Calculating plot ...");
+    std::vector<mclong> ids;
+    std::vector<float> values;
+    std::vector<mculong> sizes;
+    std::vector<bool> mergedBecauseOfSize;
 
-    for (size_t i = 0; i < sortedNodeIdx.size(); ++i)
+    for (mculong i = 0; i < numNodes; ++i)
     {
         if (i % 100 == 0)
         {
-            theWorkArea->setProgressValue((float)i / (float)sortedNodeIdx.size());
+            theWorkArea->setProgressValue((float)i / (float)numNodes);
 
             if (theWorkArea->wasInterrupted())
                 break;
         }
 
-        const mculong nodeIdx = sortedNodeIdx[i];
-        const mculong component = nodeIdx;
-        setUnion.setSetIdOfElement(nodeIdx, component);
-
-        const mculong meshVertexId = m_mesh->getMeshVertexIdx(nodeIdx);
+        const mculong nodeIdx = m_mergeSweepSortedNodeIdx[i];
+        setUnion.setSetIdOfElement(nodeIdx, nodeIdx);
 
-        float value;
-        m_inputField->lattice().eval(meshVertexId, &value);
+        const float value = m_mergeSweepNodeValues[nodeIdx];
         maxValuesOfComponent[nodeIdx] = value;
         sizeOfComponent[nodeIdx] = 1;
 
-        neighbors.clear();
-        values.clear();
-        m_mesh->getNeighborsOfMeshVertex(increasingOrder, meshVertexId, neighbors, values);
+        const mculong firstNeighbor = m_mergeSweepNeighborOffsets[i];
+        const size_t numNeighbors = m_mergeSweepNeighborOffsets[i + 1] - firstNeighbor;
 
-        sortNeighbors(neighbors, values, sortedNeighborIds, setUnion);
-
-        if (sortedNeighborIds.size() == 0)
+        if (numNeighbors == 0)
         {
             numberOfMaxima++;
+            continue;
         }
 
-        std::vector<mclong> ids;
-        std::vector<float> values;
-        std::vector<mculong> sizes;
-        std::vector<bool> mergedBecauseOfSize;
+        const mculong* neighbors = &m_mergeSweepNeighborNodeIds[firstNeighbor];
+
+        if (!m_mergeSweepSortByValue)
+            sortNodesAccordingToMajorityVote(neighbors, numNeighbors, sortedNeighborIds, numNeighborsWithEqualLabel, setUnion);
+
+        ids.clear();
+        values.clear();
+        sizes.clear();
+        mergedBecauseOfSize.clear();
         size_t numberOfMerges = 0;
-        for (size_t j = 0; j < sortedNeighborIds.size(); ++j)
+        for (size_t j = 0; j < numNeighbors; ++j)
         {
-            const mclong neighbor = m_mesh->getNodeIdx(neighbors[sortedNeighborIds[j]]);
+            const mclong neighbor = m_mergeSweepSortByValue ? neighbors[j] : neighbors[sortedNeighborIds[j]];
             const mclong component = setUnion.findSetId(neighbor);
 
             if (!std::binary_search(ids.begin(), ids.end(), component))
@@ -454,10 +494,7 @@ HxContourTreeSegmentation::calculatePlot()
             {
                 mergedBecauseOfSize[j] = true;
                 numberOfMerges++;
-                for (mclong k = 0; k < numberOfPlotPoints; k++)
-                {
-                    numberOfSegments[k] = numberOfSegments[k] + 1;
-                }
+                persistencePairs.push_back(createPersistencePair(values[j], value, totalMin, localRelative, true));
             }
         }
         // Sort values (and sizes and components in the same way)
@@ -479,26 +516,14 @@ HxContourTreeSegmentation::calculatePlot()
         {
             if ((!mergedBecauseOfSize[j]) && (numberOfMerges < sizes.size() - 1))
             {
-                float persistenceComponent = 0;
-                if (localRelative)
-                {
-                    persistenceComponent = (values[j] - value) / (values[j] - totalMin);
-                }
-                else
-                {
-                    persistenceComponent = (values[j] - value);
-                }
-                for (mclong k = ((int)(persistenceComponent / binSize)) + 1; k < numberOfPlotPoints; k++)
-                {
-                    numberOfSegments[k] = numberOfSegments[k] + 1;
-                }
+                persistencePairs.push_back(createPersistencePair(values[j], value, totalMin, localRelative, false));
                 numberOfMerges++;
             }
         }
 
-        for (size_t j = 0; j < sortedNeighborIds.size(); ++j)
+        for (size_t j = 0; j < numNeighbors; ++j)
         {
-            const mclong neighbor = m_mesh->getNodeIdx(neighbors[sortedNeighborIds[j]]);
+            const mclong neighbor = m_mergeSweepSortByValue ? neighbors[j] : neighbors[sortedNeighborIds[j]];
             const mclong component1 = setUnion.findSetId(nodeIdx);
             const mclong component2 = setUnion.findSetId(neighbor);
 
@@ -517,11 +542,35 @@ HxContourTreeSegmentation::calculatePlot()
         }
     }
 
-    for (mclong i = 0; i < numberOfPlotPoints; ++i)
+    // Pairs merged because of their size come first, they are merged for every persistence value
+    std::sort(persistencePairs.begin(), persistencePairs.end(), comparePersistencePairs);
+
+    std::vector<float> persistanceValues;
+    std::vector<float> numberOfSegments;
+    const float maxPersistanceValue = getPersistenceValue();
+    const mclong numberOfPlotPoints = 10000;
+    persistanceValues.resize(numberOfPlotPoints);
+    numberOfSegments.resize(numberOfPlotPoints);
+    float binSize = maxPersistanceValue / (numberOfPlotPoints - 1);
+
+    // A pair with persistence p has been merged at all plot points k > p / binSize
+    size_t numberOfMergedPairs = 0;
+    for (mclong k = 0; k < numberOfPlotPoints; ++k)
     {
-        numberOfSegments[i] = numberOfMaxima - numberOfSegments[i];
+        while (numberOfMergedPairs < persistencePairs.size())
+        {
+            const PersistencePair& pair = persistencePairs[numberOfMergedPairs];
+            if (!pair.mergedBecauseOfSize && (binSize <= 0.f || std::isnan(pair.persistence) || ((mclong)(pair.persistence / binSize)) + 1 > k))
+                break;
+            ++numberOfMergedPairs;
+        }
+
+        persistanceValues[k] = k * binSize;
+        numberOfSegments[k] = numberOfMaxima - (mclong)numberOfMergedPairs;
     }
 
+    createPersistenceDiagram(persistencePairs);
+
     theWorkArea->stopWorking();
 
     theMsg->printf("plot calculation took %f seconds", watch.stop());
@@ -531,6 +580,31 @@ HxContourTreeSegmentation::calculatePlot()
     m_plotParametersChanged = false;
 }
 
+void
+HxContourTreeSegmentation::createPersistenceDiagram(
+    const std::vector<PersistencePair>& persistencePairs)
+{
+    McHandle<HxSpreadSheet> diagram = HxSpreadSheet::createInstance();
+    diagram->composeLabel(m_inputField->getLabel(), "persistence-diagram");
+
+    diagram->addColumn("Birth", HxSpreadSheet::Column::FLOAT);
+    diagram->addColumn("Death", HxSpreadSheet::Column::FLOAT);
+    diagram->addColumn("Persistence", HxSpreadSheet::Column::FLOAT);
+    diagram->addColumn("Merged By Size", HxSpreadSheet::Column::INT);
+    diagram->setNumRows(persistencePairs.size());
+
+    for (size_t i = 0; i < persistencePairs.size(); ++i)
+    {
+        const PersistencePair& pair = persistencePairs[i];
+        diagram->column(0)->setValue(i, pair.birth);
+        diagram->column(1)->setValue(i, pair.death);
+        diagram->column(2)->setValue(i, pair.persistence);
+        diagram->column(3)->setValue(i, pair.mergedBecauseOfSize ? 1 : 0);
+    }
+
+    setResult(OUTPUT_PERSISTENCE_DIAGRAM, diagram);
+}
+
 void
 HxContourTreeSegmentation::calculatePlotForFastSegmentation()
 {
@@ -744,53 +818,49 @@ HxContourTreeSegmentation::sortNeighborsAccordingToMajorityVote(
     if (neighbors.size() == 0)
         return;
 
-    std::vector<mcuint32> mapToLabel;
-    std::vector<int> labelCounter;
-    std::vector<int> labelIds;
-
+    std::vector<mculong> nodeIds(neighbors.size());
     for (size_t i = 0; i < neighbors.size(); ++i)
-    {
-        const mcuint32 label = (mcuint32)(setUnion.findSetId(m_mesh->getNodeIdx(neighbors[i])) + 1);
+        nodeIds[i] = m_mesh->getNodeIdx(neighbors[i]);
 
-        if (label > 0)
-        {
-            int arrayId = -1;
-            for (size_t j = 0; j < mapToLabel.size(); ++j)
-            {
-                if (mapToLabel[j] == label)
-                {
-                    arrayId = j;
-                    ++labelCounter[j];
-                    break;
-                }
-            }
+    std::vector<mculong> numNeighborsWithEqualLabel;
+    sortNodesAccordingToMajorityVote(&nodeIds[0], nodeIds.size(), sortedNeighborIds, numNeighborsWithEqualLabel, setUnion);
+}
 
-            if (arrayId == -1)
-            {
-                arrayId = mapToLabel.size();
-                mapToLabel.push_back(label);
-                labelCounter.push_back(0);
-            }
+// Sorts the node ids by the number of other nodes that are in the same component.
+// Works on at most 26 neighbors, so the quadratic counting is cheaper than a map.
+void
+HxContourTreeSegmentation::sortNodesAccordingToMajorityVote(
+    const mculong* nodeIds,
+    const size_t numNodes,
+    std::vector<mculong>& sortedNeighborIds,
+    std::vector<mculong>& numNeighborsWithEqualLabel,
+    SetUnionDataStructure& setUnion)
+{
+    sortedNeighborIds.resize(numNodes);
+    numNeighborsWithEqualLabel.assign(numNodes, 0);
 
-            labelIds.push_back(arrayId);
-        }
-        else
+    if (numNodes == 0)
+        return;
+
+    // Reuse sortedNeighborIds to hold the components until the counting is done
+    for (size_t i = 0; i < numNodes; ++i)
+        sortedNeighborIds[i] = setUnion.findSetId(nodeIds[i]);
+
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+        for (size_t j = i + 1; j < numNodes; ++j)
         {
-            labelIds.push_back(-1);
+            if (sortedNeighborIds[i] == sortedNeighborIds[j])
+            {
+                ++numNeighborsWithEqualLabel[i];
+                ++numNeighborsWithEqualLabel[j];
+            }
         }
     }
 
-    std::vector<mculong> numNeighborsWithEqualLabel(neighbors.size());
-    for (size_t i = 0; i < numNeighborsWithEqualLabel.size(); ++i)
-    {
+    for (size_t i = 0; i < numNodes; ++i)
         sortedNeighborIds[i] = i;
 
-        if (labelIds[i] == -1)
-            numNeighborsWithEqualLabel[i] = 0;
-        else
-            numNeighborsWithEqualLabel[i] = labelCounter[labelIds[i]];
-    }
-
     McIndexByValueDescendingComparator<mculong> comp(&numNeighborsWithEqualLabel[0]);
     sort(&sortedNeighborIds[0],
          sortedNeighborIds.size(),
@@ -1066,6 +1136,245 @@ HxContourTreeSegmentation::fastContourTreeSegmentation(const float persistenceVa
     return numberOfSegments;
 }
 
+// Collects everything of the segmentation sweep in computeSegmentation() that does not depend on
+// the persistence value and minimal segment size: the sorted nodes, their values and their larger
+// neighbors as node ids (already sorted if neighbors are sorted by value).
+// Returns false if the initialization was interrupted.
+bool
+HxContourTreeSegmentation::initMergeSweep()
+{
+    if (!m_inputField)
+        return false;
+
+    McWatch watch;
+
+    theWorkArea->startWorking("Initializing segmentation ...");
+
+    m_mesh->setThreshold(portThreshold.getValue());
+
+    const bool increasingOrder = false;
+    m_mesh->getSortedListOfVertices(increasingOrder, m_mergeSweepSortedNodeIdx);
+
+    const mculong numNodes = m_mergeSweepSortedNodeIdx.size();
+
+    m_mergeSweepSortByValue = (portSortNeighborsBy.getValue() == 0);
+    m_mergeSweepNodeValues.resize(numNodes);
+    m_mergeSweepNeighborOffsets.resize(numNodes + 1);
+    m_mergeSweepNeighborOffsets[0] = 0;
+    m_mergeSweepNeighborNodeIds.clear();
+
+    std::vector<mculong> neighbors;
+    std::vector<mculong> sortedNeighborIds;
+    std::vector<float> values;
+
+    theWorkArea->setProgressInfo("Collecting neighbors ...");
+
+    for (mculong i = 0; i < numNodes; ++i)
+    {
+        if (i % 100 == 0)
+        {
+            theWorkArea->setProgressValue((float)i / (float)numNodes);
+
+            if (theWorkArea->wasInterrupted())
+            {
+                theWorkArea->stopWorking();
+                return false;
+            }
+        }
+
+        const mculong nodeIdx = m_mergeSweepSortedNodeIdx[i];
+        const mculong meshVertexId = m_mesh->getMeshVertexIdx(nodeIdx);
+
+        float value;
+        m_inputField->lattice().eval(meshVertexId, &value);
+        m_mergeSweepNodeValues[nodeIdx] = value;
+
+        neighbors.clear();
+        values.clear();
+        m_mesh->getNeighborsOfMeshVertex(increasingOrder, meshVertexId, neighbors, values);
+
+        if (m_mergeSweepSortByValue)
+        {
+            sortNeighborsAccordingToValues(values, sortedNeighborIds);
+        }
+        else
+        {
+            // The majority vote depends on the current segmentation, sort during the sweep
+            sortedNeighborIds.resize(neighbors.size());
+            for (size_t j = 0; j < sortedNeighborIds.size(); ++j)
+                sortedNeighborIds[j] = j;
+        }
+
+        for (size_t j = 0; j < sortedNeighborIds.size(); ++j)
+            m_mergeSweepNeighborNodeIds.push_back(m_mesh->getNodeIdx(neighbors[sortedNeighborIds[j]]));
+
+        m_mergeSweepNeighborOffsets[i + 1] = m_mergeSweepNeighborNodeIds.size();
+    }
+
+    float totalMax;
+    m_inputField->lattice().computeRange(m_mergeSweepTotalMin, totalMax);
+
+    m_needMergeSweepInitialization = false;
+
+    theWorkArea->stopWorking();
+
+    theMsg->printf("segmentation initialization took %f seconds", watch.stop());
+
+    return true;
+}
+
+// Same result as computeSegmentation() without join tree, but replays the sweep collected by
+// initMergeSweep(), so only the merge decisions and one relabeling pass remain.
+// Returns number of segments
+int
+HxContourTreeSegmentation::computeSegmentationFromMergeSweep(const float persistenceValue, const mculong minNumberVoxels)
+{
+    if (!m_inputField)
+        return -1;
+
+    McWatch watch;
+
+    const mculong numNodes = m_mergeSweepSortedNodeIdx.size();
+
+    SetUnionDataStructure setUnion;
+    setUnion.setNumElements(numNodes);
+
+    std::vector<float> maxValuesOfComponent(numNodes);
+    std::vector<mculong> sizeOfComponent(numNodes);
+
+    std::vector<mculong> sortedNeighborIds;
+    std::vector<mculong> numNeighborsWithEqualLabel;
+
+    theWorkArea->startWorking("Propagating contours ...");
+
+    const bool localRelative = (portPersistenceMode.getValue() == PERS_ADAPTIVE);
+    const float totalMin = m_mergeSweepTotalMin;
+
+    int numberSegments = 0;
+
+    for (mculong i = 0; i < numNodes; ++i)
+    {
+        if (i % 100 == 0)
+        {
+            theWorkArea->setProgressValue((float)i / (float)numNodes);
+
+            if (theWorkArea->wasInterrupted())
+                break;
+        }
+
+        const mculong nodeIdx = m_mergeSweepSortedNodeIdx[i];
+        setUnion.setSetIdOfElement(nodeIdx, nodeIdx);
+
+        const float value = m_mergeSweepNodeValues[nodeIdx];
+        maxValuesOfComponent[nodeIdx] = value;
+        sizeOfComponent[nodeIdx] = 1;
+
+        const mculong firstNeighbor = m_mergeSweepNeighborOffsets[i];
+        const size_t numNeighbors = m_mergeSweepNeighborOffsets[i + 1] - firstNeighbor;
+
+        if (numNeighbors == 0)
+        {
+            numberSegments++;
+            continue;
+        }
+
+        const mculong* neighbors = &m_mergeSweepNeighborNodeIds[firstNeighbor];
+
+        if (!m_mergeSweepSortByValue)
+            sortNodesAccordingToMajorityVote(neighbors, numNeighbors, sortedNeighborIds, numNeighborsWithEqualLabel, setUnion);
+
+        for (size_t j = 0; j < numNeighbors; ++j)
+        {
+            const mclong neighbor = m_mergeSweepSortByValue ? neighbors[j] : neighbors[sortedNeighborIds[j]];
+            const mclong component1 = setUnion.findSetId(nodeIdx);
+            const mclong component2 = setUnion.findSetId(neighbor);
+
+            if (component1 == component2)
+                continue;
+
+            float persistenceComponent1 = 0;
+            float persistenceComponent2 = 0;
+
+            if (localRelative)
+            {
+                persistenceComponent1 = (maxValuesOfComponent[component1] - value) / (maxValuesOfComponent[component1] - totalMin);
+                persistenceComponent2 = (maxValuesOfComponent[component2] - value) / (maxValuesOfComponent[component2] - totalMin);
+            }
+            else
+            {
+                persistenceComponent1 = (maxValuesOfComponent[component1] - value);
+                persistenceComponent2 = (maxValuesOfComponent[component2] - value);
+            }
+
+            if ((((maxValuesOfComponent[component1] - value) >= 0) && ((maxValuesOfComponent[component2] - value) >= 0)) && (((persistenceComponent1 <= persistenceValue) || (sizeOfComponent[component1] < minNumberVoxels)) || ((persistenceComponent2 <= persistenceValue) || (sizeOfComponent[component2] < minNumberVoxels))))
+            {
+                if (j != 0)
+                {
+                    numberSegments--;
+                }
+
+                setUnion.mergeSetsOfElements(nodeIdx, neighbor);
+                if (maxValuesOfComponent[component1] >= maxValuesOfComponent[component2])
+                    maxValuesOfComponent[component2] = maxValuesOfComponent[component1];
+                else
+                    maxValuesOfComponent[component1] = maxValuesOfComponent[component2];
+                mculong sizeOfComponents = sizeOfComponent[component2] + sizeOfComponent[component1];
+                sizeOfComponent[component2] = sizeOfComponents;
+                sizeOfComponent[component1] = sizeOfComponents;
+            }
+        }
+    }
+
+    theWorkArea->stopWorking();
+
+    // Label components in order of their first voxel, like relabelOutputLabelField() does
+    const McDim3l& dims = m_outputLabelField->lattice().getDims();
+    const mculong size = dims[0] * dims[1] * dims[2];
+
+    mcint32* data = (mcint32*)m_outputLabelField->lattice().dataPtr();
+
+    std::vector<mclong> oldLabelToNewLabel(numNodes, -1);
+
+    HxParamBundle* materials = m_outputLabelField->getParameters().getMaterials();
+    materials->removeAll();
+    materials->insert(new HxParamBundle("Exterior"), 0);
+
+    mculong numLabels = 1;
+    for (mculong i = 0; i < size; ++i)
+    {
+        const mclong nodeIdx = m_mesh->getNodeIdx(i);
+        if (nodeIdx < 0)
+            continue;
+
+        // Nodes not reached by an interrupted sweep stay background
+        const mclong componentLabel = setUnion.findSetIdFailSafe(nodeIdx);
+        if (componentLabel < 0)
+            continue;
+
+        if (oldLabelToNewLabel[componentLabel] < 0)
+        {
+            oldLabelToNewLabel[componentLabel] = numLabels;
+            QString mat = QString("Material%1").arg(QString::number(numLabels));
+            materials->insert(new HxParamBundle(mat), 0);
+            ++numLabels;
+        }
+
+        data[i] = oldLabelToNewLabel[componentLabel];
+    }
+
+    m_outputLabelField->touchMinMax();
+
+    m_setUnionFinestSegmentation = setUnion;
+    m_maxValuesOfComponentFinestSegmentation = maxValuesOfComponent;
+    m_sizeOfComponentFinestSegmentation = sizeOfComponent;
+
+    theMsg->printf("segmentation took %f seconds", watch.stop());
+
+    setResult(m_outputLabelField);
+
+    return numberSegments;
+}
+
 void
 HxContourTreeSegmentation::getRange(
     McHistogram& histogram,
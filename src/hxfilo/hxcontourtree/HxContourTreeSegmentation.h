@@ -47,6 +47,22 @@ public:
 
     HxPortDoIt portDoIt;
 
+    enum
+    {
+        OUTPUT_SEGMENTATION,
+        OUTPUT_PERSISTENCE_DIAGRAM
+    };
+
+    /// One entry of the persistence diagram collected by calculatePlot():
+    /// a component with maximum birth merges at value death into a component with a higher maximum.
+    struct PersistencePair
+    {
+        float birth;
+        float death;
+        float persistence;
+        bool mergedBecauseOfSize;
+    };
+
 protected:
     void update();
     void compute();
@@ -64,6 +80,7 @@ private:
     void initOutputLabelField();
     int computeSegmentation(const float persistenceValue, const mculong minNumberVoxels, AugmentedContourTree* augmentedJoinTree = 0);
     void calculatePlot();
+    void createPersistenceDiagram(const std::vector<PersistencePair>& persistencePairs);
     void calculatePlotForFastSegmentation();
     void sortNeighbors(const std::vector<mculong>& neighbors,
                        const std::vector<float>& values,
@@ -74,6 +91,11 @@ private:
     void sortNeighborsAccordingToMajorityVote(const std::vector<mculong>& neighbors,
                                               std::vector<mculong>& sortedNeighborIds,
                                               SetUnionDataStructure& setUnion);
+    void sortNodesAccordingToMajorityVote(const mculong* nodeIds,
+                                          const size_t numNodes,
+                                          std::vector<mculong>& sortedNeighborIds,
+                                          std::vector<mculong>& numNeighborsWithEqualLabel,
+                                          SetUnionDataStructure& setUnion);
     void relabelOutputLabelField(SetUnionDataStructure& setUnion);
     mcuint32 evalOutputLabelField(HxLattice3& lattice,
                                   mculong meshVertexId);
@@ -84,6 +106,8 @@ private:
                     const float maxPersistanceValue);
     void initFastContourTreeSegmentation();
     int fastContourTreeSegmentation(const float persistenceValue, const mculong minNumberVoxels);
+    bool initMergeSweep();
+    int computeSegmentationFromMergeSweep(const float persistenceValue, const mculong minNumberVoxels);
     void getRange(McHistogram& histogram,
                   float& vMin,
                   float& vMax,
@@ -111,6 +135,15 @@ private:
     std::vector<float> m_maxValuesOfComponentFinestSegmentation;
     std::vector<mculong> m_sizeOfComponentFinestSegmentation;
     int m_numberOfSegmentsFinestSegmentation;
+
+    // Parameter independent part of the segmentation sweep, see initMergeSweep()
+    bool m_needMergeSweepInitialization;
+    bool m_mergeSweepSortByValue;
+    float m_mergeSweepTotalMin;
+    std::vector<mculong> m_mergeSweepSortedNodeIdx;
+    std::vector<float> m_mergeSweepNodeValues;
+    std::vector<mculong> m_mergeSweepNeighborOffsets;
+    std::vector<mculong> m_mergeSweepNeighborNodeIds;
 };
 
 #endif
@@ -56,6 +56,7 @@ HxPropagateContours::HxPropagateContours()
     theController->addEventCallback(&keyboardEventCallback, this);
 
     mCurrentPixelHeapElementId = -1;
+    mModulationMode = MODULATION_NONE;
 }
 
 // Sets the max, min and middle values of the slider port
@@ -176,11 +177,33 @@ HxPropagateContours::initPointList()
     }
 }
 
+// Evaluate the mode ports once per computation, not for every voxel
+void
+HxPropagateContours::initModulationMode()
+{
+    if (portMode.getValue() == 0 || portSeedRadio.getValue() == 1)
+    {
+        mModulationMode = MODULATION_NONE;
+    }
+    else if (portMode.getValue() == 1)
+    {
+        mModulationMode = MODULATION_VALUE_DIST;
+    }
+    else if (portMode.getValue() == 2)
+    {
+        mModulationMode = MODULATION_DIST;
+    }
+    else
+    {
+        throw("Error: Mode not supported!");
+    }
+}
+
 float
 HxPropagateContours::getModulatedValue(
     int x, int y, int z, int pointId, float val)
 {
-    if (portMode.getValue() == 0 || portSeedRadio.getValue() == 1)
+    if (mModulationMode == MODULATION_NONE)
     {
         return val;
     }
@@ -192,17 +215,13 @@ HxPropagateContours::getModulatedValue(
 
     const float dist = (p1 - p2).length();
 
-    if (portMode.getValue() == 1)
+    if (mModulationMode == MODULATION_VALUE_DIST)
     {
         return (val / (dist + 1));
     }
-    else if (portMode.getValue() == 2)
-    {
-        return (1.f / (dist + 1));
-    }
     else
     {
-        throw("Error: Mode not supported!");
+        return (1.f / (dist + 1));
     }
 }
 
@@ -250,6 +269,8 @@ HxPropagateContours::compute()
     if (!mInputField)
         return;
 
+    initModulationMode();
+
     initCompute();
 
     thresholdTP = portStopThreshold.getValue();
@@ -432,6 +453,9 @@ HxPropagateContours::propagate()
     mWatch.start();
     mLastTime = mWatch.getTime();
 
+    std::vector<PixelHeapElement*> nhood;
+    std::vector<PixelHeapElement*> newFront;
+
     while (elem && !canceled) // while the heap is not empty
     {
         processedElems++;
@@ -448,7 +472,6 @@ HxPropagateContours::propagate()
         pt[1] = elem->position.j;
         pt[2] = elem->position.k;
 
-        std::vector<PixelHeapElement*> nhood;
         getNeighbours(pt, elem->label, nhood);
 
         // take a look at the neighbours
@@ -466,7 +489,6 @@ HxPropagateContours::propagate()
         // process current element
         float currentLabel;
         mOutputLabelField->lattice().eval(pt[0], pt[1], pt[2], &currentLabel);
-        std::vector<PixelHeapElement*> newFront;
 
         processCurrentElement(currentLabel, newFront, nhood);
 
@@ -113,15 +113,24 @@ private:
     McVec3f getWorldLocation(const int pointId);
     McVec3i getLatticeLocation(const int pointId);
     McVec3f convertToWorldLocation(McVec3i& p);
+    void initModulationMode();
     float getModulatedValue(int x, int y, int z, int pointId, float val);
     //
 
+    enum ModulationMode
+    {
+        MODULATION_NONE,
+        MODULATION_VALUE_DIST,
+        MODULATION_DIST
+    };
+
     McHandle<HxUniformScalarField3> mInputField;
     McHandle<HxUniformLabelField3> mInputLabelField;
     McHandle<HxUniformLabelField3> mOutputLabelField;
     McHandle<HxUniformScalarField3> mFrontField;
 
     McFHeap<PixelHeapElement> mHeap;
+    ModulationMode mModulationMode;
     std::vector<PixelHeapElement*> mPixelHeapElements;
     mclong mCurrentPixelHeapElementId;
     std::vector<McVec3f> mPointListWorld;
@@ -230,10 +230,10 @@ HxTouchPointGraphBuilder::initCompute()
 }
 
 void
-HxTouchPointGraphBuilder::printVector(std::vector<PixelHeapElement> & points)
+HxTouchPointGraphBuilder::printVector(std::vector<TouchPointHeapElement> & points)
 {
-    std::vector<PixelHeapElement>::iterator p_it     = points.begin();
-    std::vector<PixelHeapElement>::iterator p_it_end = points.end();
+    std::vector<TouchPointHeapElement>::iterator p_it     = points.begin();
+    std::vector<TouchPointHeapElement>::iterator p_it_end = points.end();
 
     for(; p_it != p_it_end; ++p_it)
     {
@@ -243,7 +243,7 @@ HxTouchPointGraphBuilder::printVector(std::vector<PixelHeapElement> & points)
 }
 
 void
-HxTouchPointGraphBuilder::printPixelHeapElement(PixelHeapElement * elem)
+HxTouchPointGraphBuilder::printPixelHeapElement(TouchPointHeapElement * elem)
 {
     theMsg->stream()
         << elem->label << " value: "
@@ -294,13 +294,16 @@ HxTouchPointGraphBuilder::initFields()
 void
 HxTouchPointGraphBuilder::propagate()
 {
-    PixelHeapElement* elem = mHeap.getMin();
+    TouchPointHeapElement* elem = mHeap.getMin();
 
     int processedElems = 0;
 
     mWatch.start();
     mLastTime = mWatch.getTime();
 
+    std::vector<TouchPointHeapElement*> nhood;
+    std::vector<TouchPointHeapElement*> newFront;
+
     while (elem) // while the heap is not empty
     {
         processedElems++;
@@ -317,7 +320,6 @@ HxTouchPointGraphBuilder::propagate()
         pt[1] = elem->position.j;
         pt[2] = elem->position.k;
 
-        std::vector<PixelHeapElement*> nhood;
         this->getNeighbours(pt, nhood);
 
         // take a look at the neighbours
@@ -335,7 +337,6 @@ HxTouchPointGraphBuilder::propagate()
         // process current element
         float currentLabel;
         this->mOutputLabelField->lattice().eval(pt[0], pt[1], pt[2], &currentLabel);
-        std::vector<PixelHeapElement*> newFront;
 
         this->processCurrentElement(currentLabel, newFront, nhood);
 
@@ -347,13 +348,21 @@ HxTouchPointGraphBuilder::propagate()
 
         this->addNeighboursToHeap(newFront);
 
-        delete elem;
+        this->makeHeapElementAvailableForReuse(elem);
         nhood.clear();
         newFront.clear();
 
         elem = mHeap.getMin();
     }
 
+    // the propagation stopped at a touching point before processing its neighbours
+    if (elem)
+    {
+        for (size_t i = 0; i < nhood.size(); ++i)
+            this->makeHeapElementAvailableForReuse(nhood[i]);
+        this->makeHeapElementAvailableForReuse(elem);
+    }
+
     theMsg->printf("elapsed time: %f seconds", mWatch.stop());
 
     this->cleanUp();
@@ -362,7 +371,7 @@ HxTouchPointGraphBuilder::propagate()
 void
 HxTouchPointGraphBuilder::cleanUp()
 {
-    PixelHeapElement* elem = mHeap.getMin();
+    TouchPointHeapElement* elem = mHeap.getMin();
     int processedElems = 0;
 
     while (elem) // while the heap is not empty
@@ -376,6 +385,10 @@ HxTouchPointGraphBuilder::cleanUp()
         elem = mHeap.getMin();
     }
 
+    for (size_t i = 0; i < mFreeHeapElements.size(); ++i)
+        delete mFreeHeapElements[i];
+    mFreeHeapElements.clear();
+
     return;
 }
 
@@ -394,11 +407,11 @@ HxTouchPointGraphBuilder::updateMaxima(const McVec3i & position,
 
 void
 HxTouchPointGraphBuilder::processCurrentElement(float currentLabel,
-                                           std::vector<PixelHeapElement*> & newFront,
-                                           std::vector<PixelHeapElement*> & nhood)
+                                           std::vector<TouchPointHeapElement*> & newFront,
+                                           std::vector<TouchPointHeapElement*> & nhood)
 {
-    std::vector<PixelHeapElement*>::iterator n_it = nhood.begin();
-    std::vector<PixelHeapElement*>::iterator n_it_end = nhood.end();
+    std::vector<TouchPointHeapElement*>::iterator n_it = nhood.begin();
+    std::vector<TouchPointHeapElement*>::iterator n_it_end = nhood.end();
     for(; n_it != n_it_end; ++n_it)
     {
         int i = (*n_it)->position.i;
@@ -429,18 +442,18 @@ HxTouchPointGraphBuilder::processCurrentElement(float currentLabel,
             this->pushNeighbour(i, j, k, newFront);
         }
 
-        delete (*n_it);
+        this->makeHeapElementAvailableForReuse(*n_it);
     }
 }
 
 void
 HxTouchPointGraphBuilder::analyzeNeighbours(bool & touchPointReached,
                                        bool & thresholdReached,
-                                       std::vector<PixelHeapElement*> & nhood,
-                                       PixelHeapElement * elem)
+                                       std::vector<TouchPointHeapElement*> & nhood,
+                                       TouchPointHeapElement * elem)
 {
-    std::vector<PixelHeapElement*>::iterator nh_it     = nhood.begin();
-    std::vector<PixelHeapElement*>::iterator nh_it_end = nhood.end();
+    std::vector<TouchPointHeapElement*>::iterator nh_it     = nhood.begin();
+    std::vector<TouchPointHeapElement*>::iterator nh_it_end = nhood.end();
     for(; nh_it != nh_it_end; ++nh_it)
     {
         float neighbourLabel = (*nh_it)->label;
@@ -477,12 +490,12 @@ HxTouchPointGraphBuilder::initContours()
         this->mOutputLabelField  ->lattice().set(pt[0], pt[1], pt[2], &lbl);
         this->mFrontField        ->lattice().set(pt[0], pt[1], pt[2], &(this->setFront));
 
-        PixelHeapElement startingPt(pt, value, lbl);
+        TouchPointHeapElement startingPt(pt, value, lbl);
         
         this->startingPoints.push_back(startingPt);
         this->maximalPoints.push_back(startingPt);
 
-        std::vector<PixelHeapElement*> nhood;
+        std::vector<TouchPointHeapElement*> nhood;
         this->getNeighbours(pt, nhood);
         this->labelNeighbours(&lbl, nhood);
 
@@ -517,12 +530,12 @@ HxTouchPointGraphBuilder::initGraph()
 }
 
 void
-HxTouchPointGraphBuilder::addPointsToGraph(std::vector<PixelHeapElement> & points,
+HxTouchPointGraphBuilder::addPointsToGraph(std::vector<TouchPointHeapElement> & points,
                                       std::vector<int> & indexes,
                                       const int id)
 {
-    std::vector<PixelHeapElement>::iterator p_it     = points.begin();
-    std::vector<PixelHeapElement>::iterator p_it_end = points.end();
+    std::vector<TouchPointHeapElement>::iterator p_it     = points.begin();
+    std::vector<TouchPointHeapElement>::iterator p_it_end = points.end();
 
     for(; p_it != p_it_end; ++p_it)
     {
@@ -544,8 +557,8 @@ HxTouchPointGraphBuilder::connectGraph()
     int numberPoints = touchingPoints.size();
 
     // connect each touchpoint with the starting points that are touching at it
-    std::vector<PixelHeapElement>::iterator tp_it     = touchingPoints.begin();
-    std::vector<PixelHeapElement>::iterator tp_it_end = touchingPoints.end();
+    std::vector<TouchPointHeapElement>::iterator tp_it     = touchingPoints.begin();
+    std::vector<TouchPointHeapElement>::iterator tp_it_end = touchingPoints.end();
     for(; tp_it != tp_it_end; ++tp_it)
     {
         processedPoints++;
@@ -601,10 +614,10 @@ HxTouchPointGraphBuilder::addIntPointToGraph(McVec3i & pt, int & index, const in
 
 void
 HxTouchPointGraphBuilder::labelNeighbours(const float * label,
-                                     std::vector<PixelHeapElement*> & nhood)
+                                     std::vector<TouchPointHeapElement*> & nhood)
 {
-    std::vector<PixelHeapElement*>::iterator n_it = nhood.begin();
-    std::vector<PixelHeapElement*>::iterator n_it_end = nhood.end();
+    std::vector<TouchPointHeapElement*>::iterator n_it = nhood.begin();
+    std::vector<TouchPointHeapElement*>::iterator n_it_end = nhood.end();
     for(; n_it != n_it_end; ++n_it)
     {
         this->mOutputLabelField->lattice().set((*n_it)->position.i,
@@ -619,7 +632,7 @@ HxTouchPointGraphBuilder::labelNeighbours(const float * label,
 
 void
 HxTouchPointGraphBuilder::getNeighbours(const McVec3i & pt,
-                                   std::vector<PixelHeapElement*> & nhood)
+                                   std::vector<TouchPointHeapElement*> & nhood)
 {
     const McDim3l& dims = this->mOutputLabelField->lattice().getDims();
 
@@ -640,10 +653,10 @@ HxTouchPointGraphBuilder::getNeighbours(const McVec3i & pt,
 }
 
 void
-HxTouchPointGraphBuilder::addNeighboursToHeap(std::vector<PixelHeapElement*> & nhood)
+HxTouchPointGraphBuilder::addNeighboursToHeap(std::vector<TouchPointHeapElement*> & nhood)
 {
-    std::vector<PixelHeapElement*>::iterator nh_it = nhood.begin();
-    std::vector<PixelHeapElement*>::iterator nh_it_end = nhood.end();
+    std::vector<TouchPointHeapElement*>::iterator nh_it = nhood.begin();
+    std::vector<TouchPointHeapElement*>::iterator nh_it_end = nhood.end();
     for(; nh_it != nh_it_end; ++nh_it)
     {
         mHeap.insert(*nh_it);
@@ -652,11 +665,29 @@ HxTouchPointGraphBuilder::addNeighboursToHeap(std::vector<PixelHeapElement*> & n
     return;
 }
 
+TouchPointHeapElement *
+HxTouchPointGraphBuilder::getHeapElement()
+{
+    if (mFreeHeapElements.empty())
+        return new TouchPointHeapElement();
+
+    TouchPointHeapElement * element = mFreeHeapElements.back();
+    mFreeHeapElements.pop_back();
+    element->labels.clear();
+    return element;
+}
+
+void
+HxTouchPointGraphBuilder::makeHeapElementAvailableForReuse(TouchPointHeapElement * elem)
+{
+    mFreeHeapElements.push_back(elem);
+}
+
 void
 HxTouchPointGraphBuilder::pushNeighbour(int x, int y, int z,
-                                   std::vector<PixelHeapElement*> & nhood)
+                                   std::vector<TouchPointHeapElement*> & nhood)
 {
-    PixelHeapElement * element = new PixelHeapElement();
+    TouchPointHeapElement * element = this->getHeapElement();
 
     element->position.setValue(x, y, z);
 
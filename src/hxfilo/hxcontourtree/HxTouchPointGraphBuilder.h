@@ -27,28 +27,29 @@
 class SoEvent;
 class HxViewer; // for the keyboard call back, i guess
 
-// copied from HxCoralSegmentation
-struct PixelHeapElement : public McFHeapElement
+// copied from HxCoralSegmentation,
+// not named PixelHeapElement to not clash with the one of HxPropagateContours
+struct TouchPointHeapElement : public McFHeapElement
 {
     McVec3i position;
     float pixelValue;
     int label;
     std::vector<float> labels;
 
-    int operator < (const PixelHeapElement& other)
+    int operator < (const TouchPointHeapElement& other)
     {
         return pixelValue > other.pixelValue;
     }
 
-    PixelHeapElement()
+    TouchPointHeapElement()
     {}
 
-    PixelHeapElement(McVec3i & pos, float val, float lbl) 
+    TouchPointHeapElement(McVec3i & pos, float val, float lbl) 
         : position(pos), pixelValue(val), label(lbl) 
     {
     }
 
-    ~PixelHeapElement()
+    ~TouchPointHeapElement()
     {
         labels.clear();
     }
@@ -84,19 +85,21 @@ class HXCONTOURTREE_API HxTouchPointGraphBuilder : public HxCompModule
         void connectGraph();
         void cleanUpComputation();
 
-        void addNeighboursToHeap(std::vector<PixelHeapElement*> & nhood);
-        void getNeighbours(const McVec3i & pt, std::vector<PixelHeapElement*> & nhood);
-        void pushNeighbour(int x, int y, int z, std::vector<PixelHeapElement*> & nhood);
-        void labelNeighbours(const float * label, std::vector<PixelHeapElement*> & nhood);
-        void analyzeNeighbours(bool & touchPointReached, bool & thresholdReached, std::vector<PixelHeapElement*> & nhood, PixelHeapElement * elem);
-        void processCurrentElement(float currentLabel, std::vector<PixelHeapElement*> & newFront, std::vector<PixelHeapElement*> & nhood);
+        void addNeighboursToHeap(std::vector<TouchPointHeapElement*> & nhood);
+        TouchPointHeapElement * getHeapElement();
+        void makeHeapElementAvailableForReuse(TouchPointHeapElement * elem);
+        void getNeighbours(const McVec3i & pt, std::vector<TouchPointHeapElement*> & nhood);
+        void pushNeighbour(int x, int y, int z, std::vector<TouchPointHeapElement*> & nhood);
+        void labelNeighbours(const float * label, std::vector<TouchPointHeapElement*> & nhood);
+        void analyzeNeighbours(bool & touchPointReached, bool & thresholdReached, std::vector<TouchPointHeapElement*> & nhood, TouchPointHeapElement * elem);
+        void processCurrentElement(float currentLabel, std::vector<TouchPointHeapElement*> & newFront, std::vector<TouchPointHeapElement*> & nhood);
         void updateMaxima(const McVec3i & position, const float & value, const float & currentLabel);
-        void printPixelHeapElement(PixelHeapElement * elem);
-        void printVector(std::vector<PixelHeapElement> & points);
+        void printPixelHeapElement(TouchPointHeapElement * elem);
+        void printVector(std::vector<TouchPointHeapElement> & points);
         
         //graph
         void addIntPointToGraph(McVec3i & pt, int & index, const int id);
-        void addPointsToGraph(std::vector<PixelHeapElement> & points, std::vector<int> & indexes, const int id);
+        void addPointsToGraph(std::vector<TouchPointHeapElement> & points, std::vector<int> & indexes, const int id);
         void addEdges(std::vector<int> & sources, std::vector<int> & targets);
 
         bool getSeedMode();
@@ -119,7 +122,9 @@ class HXCONTOURTREE_API HxTouchPointGraphBuilder : public HxCompModule
         
         McHandle<HxSpatialGraph> graph;
 
-        McFHeap<PixelHeapElement> mHeap;
+        McFHeap<TouchPointHeapElement> mHeap;
+        // elements that are not in the heap, reused instead of allocating one per neighbour
+        std::vector<TouchPointHeapElement*> mFreeHeapElements;
 
         static const float setFront;
         static const float notFront;
@@ -132,9 +137,9 @@ class HXCONTOURTREE_API HxTouchPointGraphBuilder : public HxCompModule
         static const int resultIdGraph = 1;
 
         float thresholdTP;
-        std::vector<PixelHeapElement> startingPoints;
-        std::vector<PixelHeapElement> maximalPoints;
-        std::vector<PixelHeapElement> touchingPoints;
+        std::vector<TouchPointHeapElement> startingPoints;
+        std::vector<TouchPointHeapElement> maximalPoints;
+        std::vector<TouchPointHeapElement> touchingPoints;
         
         std::vector<int> startingIdx;
         std::vector<int> maximalIdx;
@@ -4,7 +4,6 @@
 #include <algorithm>
 
 #include <hxfield/HxLattice3.h>
-#include <hxcontourtree/CompareCheckFunctors.h>
 
 
 
@@ -21,6 +20,8 @@ Lattice3MeshBase::Lattice3MeshBase(const HxLattice3* lattice)
     m_voxelSize = dynamic_cast<HxUniformCoord3*>(lattice->coords())->getVoxelSize();
 
     lattice->computeRange(m_dataMin, m_dataMax);
+
+    computeStencils();
 }
 
 
@@ -72,40 +73,77 @@ long long Lattice3MeshBase::getNodeIdx(const size_t meshVertexIdx) const
 }
 
 
-std::array<long long, 3> Lattice3MeshBase::linear2components(const size_t linear) const
+void Lattice3MeshBase::computeStencils()
 {
-    std::array<long long, 3> components{ {0, 0, static_cast<long long>(linear) / (m_dims.ny * m_dims.nx)} };
-    components[0] = (static_cast<long long>(linear) - components[2] * ((m_dims.ny * m_dims.nx)));
-    components[1] = components[0] / m_dims.nx;
-    components[0] -= components[1] * m_dims.nx;
+    m_xyStencil.clear();
+    m_zStencil.clear();
 
-    return components;
-}
+    if(m_interpretation == Interpretation::XY_SLICES)
+    {
+        assert(m_connectivity != Connectivity::FACE);
+        assert(m_connectivity != Connectivity::EXP_8P2);
 
+        if(m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER)
+            m_xyStencil.insert(m_xyStencil.end(), { { {  0, -1,  0} }, { { -1,  0,  0} }, { { +1,  0,  0} }, { {  0, +1,  0} } });
 
-bool Lattice3MeshBase::validComponents(const std::array<long long, 3>& components) const
-{
-    if(components[0] < 0 || components[1] < 0 || components[2] < 0 ||
-       components[0] >= m_dims.nx || components[1] >= m_dims.ny || components[2] >= m_dims.nz)
-        return false;
+        if(m_connectivity == Connectivity::CORNER)
+            m_xyStencil.insert(m_xyStencil.end(), { { { -1, -1,  0} }, { { +1, -1,  0} }, { { -1, +1,  0} }, { { +1, +1,  0} } });
+    }
+    else // m_interpretation == Interpretation::SPATIAL || m_interpretation == Interpretation::SPATIOTEMPORAL
+    {
+        m_xyStencil.insert(m_xyStencil.end(), { { {  0, -1,  0} }, { { -1,  0,  0} }, { { +1,  0,  0} }, { {  0, +1,  0} } });
+
+        if(m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER || m_connectivity == Connectivity::EXP_8P2)
+            m_xyStencil.insert(m_xyStencil.end(), { { { -1, -1,  0} }, { { +1, -1,  0} }, { { -1, +1,  0} }, { { +1, +1,  0} } });
+    }
+
+    // The z stencil does not depend on the interpretation: getAllZNeighboursOfMeshVertex()
+    // uses its direct z neighbours also for XY_SLICES.
+    m_zStencil.insert(m_zStencil.end(), { { {  0,  0, -1} }, { {  0,  0, +1} } });
 
-    return true;
+    if(m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER)
+    {
+        m_zStencil.insert(m_zStencil.end(), { { {  0, -1, -1} }, { { -1,  0, -1} }, { { +1,  0, -1} }, { {  0, +1, -1} } });
+        m_zStencil.insert(m_zStencil.end(), { { {  0, -1, +1} }, { { -1,  0, +1} }, { { +1,  0, +1} }, { {  0, +1, +1} } });
+    }
+    if(m_connectivity == Connectivity::CORNER)
+    {
+        m_zStencil.insert(m_zStencil.end(), { { { -1, -1, -1} }, { { +1, -1, -1} }, { { -1, +1, -1} }, { { +1, +1, -1} } });
+        m_zStencil.insert(m_zStencil.end(), { { { -1, -1, +1} }, { { +1, -1, +1} }, { { -1, +1, +1} }, { { +1, +1, +1} } });
+    }
+
+    const auto stencil2offsets = [this] (const std::vector<std::array<long long, 3> >& stencil, std::vector<long long>& stencilOffsets)
+    {
+        stencilOffsets.clear();
+        stencilOffsets.reserve(stencil.size());
+
+        for(const std::array<long long, 3>& offset : stencil)
+            stencilOffsets.push_back((offset[2] * m_dims.ny + offset[1]) * m_dims.nx + offset[0]);
+    };
+
+    stencil2offsets(m_xyStencil, m_xyStencilOffsets);
+    stencil2offsets(m_zStencil, m_zStencilOffsets);
 }
 
 
-size_t Lattice3MeshBase::components2linear(const std::array<long long, 3>& components) const
+bool Lattice3MeshBase::hasDeformedZNeighbours() const
 {
-    assert(validComponents(components));
-
-    return components2linear(static_cast<size_t>(components[0]),
-                             static_cast<size_t>(components[1]),
-                             static_cast<size_t>(components[2]));
+    return m_nDataVarDeformation && m_interpretation == Interpretation::SPATIOTEMPORAL;
 }
 
 
-size_t Lattice3MeshBase::components2linear(const size_t x, const size_t y, const size_t z) const
+std::array<long long, 4> Lattice3MeshBase::getDeformationOffsets(const size_t meshVertexIdx) const
 {
-    return (((z)*m_dims.ny + y)*m_dims.nx + x);
+    assert(m_meshVertexBackwardData);
+    assert(m_meshVertexFordwardData);
+
+    const std::array<float, 2> backwardDeformation{ {m_meshVertexBackwardData[meshVertexIdx * m_nDataVarDeformation + 0], m_meshVertexBackwardData[meshVertexIdx * m_nDataVarDeformation + 1]} };
+    const std::array<float, 2> forwardDeformation{ {m_meshVertexFordwardData[meshVertexIdx * m_nDataVarDeformation + 0], m_meshVertexFordwardData[meshVertexIdx * m_nDataVarDeformation + 1]} };
+
+    return { {static_cast<long long>(std::round(backwardDeformation[0] / m_voxelSize[0])),
+              static_cast<long long>(std::round(backwardDeformation[1] / m_voxelSize[1])),
+              static_cast<long long>(std::round(forwardDeformation[0] / m_voxelSize[0])),
+              static_cast<long long>(std::round(forwardDeformation[1] / m_voxelSize[1]))} };
 }
 
 
@@ -128,8 +166,13 @@ Lattice3Mesh<T>::Lattice3Mesh(const HxLattice3* lattice)
 template <typename T>
 void Lattice3Mesh<T>::resetStoreOffsetNeighbours()
 {
-    m_node2inverseMeshVertexNeighbours.assign(m_sortedNodeIndices.size(), std::vector<std::pair<size_t, T> >());
-    m_storeOffsetNeighbours = true;
+    // Inverse neighbours are only read for deformed z neighbours, where the neighbourhood is not symmetric.
+    m_storeOffsetNeighbours = hasDeformedZNeighbours();
+
+    if(m_storeOffsetNeighbours)
+        m_node2inverseMeshVertexNeighbours.assign(m_sortedNodeIndices.size(), std::vector<std::pair<size_t, T> >());
+    else
+        m_node2inverseMeshVertexNeighbours.clear();
 }
 
 
@@ -207,73 +250,21 @@ const std::vector<std::pair<size_t, T> >& Lattice3Mesh<T>::getSortedNodeIndices(
 template <typename T>
 void Lattice3Mesh<T>::getAllZNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<size_t>& meshVertexNeighbours)
 {
-    std::vector<std::pair<size_t, T> > tmpNeighbours;
-    tmpNeighbours.reserve(18 + m_node2inverseMeshVertexNeighbours[static_cast<size_t>(getNodeIdx(meshVertexIdx))].size());
-
+    assert(!m_storeOffsetNeighbours);
 
-    long long offsetBackwardX;
-    long long offsetBackwardY;
-    long long offsetForwardX;
-    long long offsetForwardY;
+    const std::array<long long, 3> components = linear2components(meshVertexIdx);
+    const bool deformed{m_nDataVarDeformation && (m_interpretation == Interpretation::XY_SLICES || m_interpretation == Interpretation::SPATIOTEMPORAL)};
+    const bool interior{!deformed &&
+                        components[0] > 0 && components[0] < m_dims.nx - 1 &&
+                        components[1] > 0 && components[1] < m_dims.ny - 1 &&
+                        components[2] > 0 && components[2] < m_dims.nz - 1};
+    const std::array<long long, 4> deformationOffsets = deformed ? getDeformationOffsets(meshVertexIdx) : std::array<long long, 4>{ {0, 0, 0, 0} };
+    const size_t nStencil{m_interpretation == Interpretation::XY_SLICES ? size_t(2) : m_zStencil.size()};
 
+    meshVertexNeighbours.reserve(meshVertexNeighbours.size() + nStencil);
 
-    if(m_nDataVarDeformation && (m_interpretation == Interpretation::XY_SLICES || m_interpretation == Interpretation::SPATIOTEMPORAL) )
-    {
-        assert(m_meshVertexBackwardData);
-        assert(m_meshVertexFordwardData);
-
-        const std::array<float, 2> backwardDeformation{ {m_meshVertexBackwardData[meshVertexIdx * m_nDataVarDeformation + 0], m_meshVertexBackwardData[meshVertexIdx * m_nDataVarDeformation + 1]} };
-        offsetBackwardX = static_cast<long long>(std::round(backwardDeformation[0] / m_voxelSize[0]));
-        offsetBackwardY = static_cast<long long>(std::round(backwardDeformation[1] / m_voxelSize[1]));
-
-        const std::array<float, 2> forwardDeformation{ {m_meshVertexFordwardData[meshVertexIdx * m_nDataVarDeformation + 0], m_meshVertexFordwardData[meshVertexIdx * m_nDataVarDeformation + 1]} };
-        offsetForwardX = static_cast<long long>(std::round(forwardDeformation[0] / m_voxelSize[0]));
-        offsetForwardY = static_cast<long long>(std::round(forwardDeformation[1] / m_voxelSize[1]));
-    }
-    else
-    {
-        offsetBackwardX = 0;
-        offsetBackwardY = 0;
-        offsetForwardX = 0;
-        offsetForwardY = 0;
-    }
-
-
-    addNeighbour(meshVertexIdx, { {offsetBackwardX, offsetBackwardY, -1} }, tmpNeighbours, nullptr, nullptr);
-    addNeighbour(meshVertexIdx, { { offsetForwardX,  offsetForwardY, +1} }, tmpNeighbours, nullptr, nullptr);
-
-    if(m_interpretation == Interpretation::SPATIAL || m_interpretation == Interpretation::SPATIOTEMPORAL)
-    {
-        if(m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER)
-        {
-            addNeighbour(meshVertexIdx, { {offsetBackwardX    , offsetBackwardY - 1, -1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { {offsetBackwardX - 1, offsetBackwardY    , -1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { {offsetBackwardX + 1, offsetBackwardY    , -1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { {offsetBackwardX    , offsetBackwardY + 1, -1} }, tmpNeighbours, nullptr, nullptr);
-
-            addNeighbour(meshVertexIdx, { { offsetForwardX    ,  offsetForwardY - 1, +1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { { offsetForwardX - 1,  offsetForwardY    , +1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { { offsetForwardX + 1,  offsetForwardY    , +1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { { offsetForwardX    ,  offsetForwardY + 1, +1} }, tmpNeighbours, nullptr, nullptr);
-        }
-        if(m_connectivity == Connectivity::CORNER)
-        {
-            addNeighbour(meshVertexIdx, { {offsetBackwardX - 1, offsetBackwardY - 1, -1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { {offsetBackwardX + 1, offsetBackwardY - 1, -1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { {offsetBackwardX - 1, offsetBackwardY + 1, -1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { {offsetBackwardX + 1, offsetBackwardY + 1, -1} }, tmpNeighbours, nullptr, nullptr);
-
-            addNeighbour(meshVertexIdx, { { offsetForwardX - 1,  offsetForwardY - 1, +1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { { offsetForwardX + 1,  offsetForwardY - 1, +1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { { offsetForwardX - 1,  offsetForwardY + 1, +1} }, tmpNeighbours, nullptr, nullptr);
-            addNeighbour(meshVertexIdx, { { offsetForwardX + 1,  offsetForwardY + 1, +1} }, tmpNeighbours, nullptr, nullptr);
-        }
-    }
-
-
-    meshVertexNeighbours.reserve(tmpNeighbours.size());
-    std::transform(tmpNeighbours.begin(), tmpNeighbours.end(), std::back_inserter(meshVertexNeighbours),
-                   [] (const std::pair<size_t, T>& pair) -> size_t { return pair.first; });
+    auto appender = [&meshVertexNeighbours] (const size_t meshVertexNeighbourIdx) { meshVertexNeighbours.push_back(meshVertexNeighbourIdx); };
+    visitStencil(meshVertexIdx, components, interior, m_zStencil, m_zStencilOffsets, nStencil, deformationOffsets, appender);
 }
 
 
@@ -296,183 +287,14 @@ size_t Lattice3Mesh<T>::getMeshVertexIdxOfMaxValue(const std::vector<size_t>& me
 template <typename T>
 void Lattice3Mesh<T>::getSmallerNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax)
 {
-    OutOfRangeChecker<T> outOfRangeChecker{rangeMin, rangeMax};
-    IndexValueSmallerComparator<T> comparator{};
-    getNeighboursOfMeshVertex(meshVertexIdx, meshVertexNeighbours, &outOfRangeChecker, &comparator);
+    getNeighboursOfMeshVertex(meshVertexIdx, meshVertexNeighbours, rangeMin, rangeMax, IndexValueSmallerComparator<T>());
 }
 
 
 template <typename T>
 void Lattice3Mesh<T>::getGreaterNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax)
 {
-    OutOfRangeChecker<T> outOfRangeChecker{rangeMin, rangeMax};
-    IndexValueGreaterComparator<T> comparator{};
-    getNeighboursOfMeshVertex(meshVertexIdx, meshVertexNeighbours, &outOfRangeChecker, &comparator);
-}
-
-
-template <typename T>
-void Lattice3Mesh<T>::getNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax, const IndexValueAbstractBaseComparator<T>* comparator)
-{
-    OutOfRangeChecker<T> outOfRangeChecker{rangeMin, rangeMax};
-    getNeighboursOfMeshVertex(meshVertexIdx, meshVertexNeighbours, &outOfRangeChecker, comparator);
-}
-
-
-template <typename T>
-void Lattice3Mesh<T>::getNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator)
-{
-    meshVertexNeighbours.reserve(26 + m_node2inverseMeshVertexNeighbours[static_cast<size_t>(getNodeIdx(meshVertexIdx))].size());
-    getXYNeighboursOfMeshVertex(meshVertexIdx, meshVertexNeighbours, outOfRangeChecker, comparator);
-    getZNeighboursOfMeshVertex(meshVertexIdx, meshVertexNeighbours, outOfRangeChecker, comparator);
-}
-
-
-template <typename T>
-void Lattice3Mesh<T>::getXYNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator)
-{
-    if(m_interpretation == Interpretation::XY_SLICES)
-    {
-        assert(m_connectivity != Connectivity::FACE);
-        assert(m_connectivity != Connectivity::EXP_8P2);
-
-        if(m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER)
-        {
-            addNeighbour(meshVertexIdx, { {  0, -1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { -1,  0,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { +1,  0,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { {  0, +1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        }
-
-        if(m_connectivity == Connectivity::CORNER)
-        {
-            addNeighbour(meshVertexIdx, { { -1, -1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { +1, -1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { -1, +1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { +1, +1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        }
-    }
-    else // m_interpretation == Interpretation::VOLUME || m_interpretation == Interpretation::EXPERIMENTAL
-    {
-
-        if(m_connectivity == Connectivity::FACE || m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER || m_connectivity == Connectivity::EXP_8P2)
-        {
-            addNeighbour(meshVertexIdx, { {  0, -1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { -1,  0,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { +1,  0,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { {  0, +1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-
-        }
-        if(m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER || m_connectivity == Connectivity::EXP_8P2)
-        {
-            addNeighbour(meshVertexIdx, { { -1, -1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { +1, -1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { -1, +1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-            addNeighbour(meshVertexIdx, { { +1, +1,  0} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        }
-    }
-}
-
-
-template <typename T>
-void Lattice3Mesh<T>::getZNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator)
-{
-    if(m_interpretation == Interpretation::XY_SLICES)
-        return;
-
-    long long offsetBackwardX;
-    long long offsetBackwardY;
-    long long offsetForwardX;
-    long long offsetForwardY;
-
-
-    if(m_nDataVarDeformation && m_interpretation == Interpretation::SPATIOTEMPORAL)
-    {
-        assert(m_meshVertexBackwardData);
-        assert(m_meshVertexFordwardData);
-
-        const std::array<float, 2> backwardDeformation{ {m_meshVertexBackwardData[meshVertexIdx * m_nDataVarDeformation + 0], m_meshVertexBackwardData[meshVertexIdx * m_nDataVarDeformation + 1]} };
-        offsetBackwardX = static_cast<long long>(std::round(backwardDeformation[0] / m_voxelSize[0]));
-        offsetBackwardY = static_cast<long long>(std::round(backwardDeformation[1] / m_voxelSize[1]));
-
-        const std::array<float, 2> forwardDeformation{ {m_meshVertexFordwardData[meshVertexIdx * m_nDataVarDeformation + 0], m_meshVertexFordwardData[meshVertexIdx * m_nDataVarDeformation + 1]} };
-        offsetForwardX = static_cast<long long>(std::round(forwardDeformation[0] / m_voxelSize[0]));
-        offsetForwardY = static_cast<long long>(std::round(forwardDeformation[1] / m_voxelSize[1]));
-
-        if(comparator)
-        {
-            size_t nodeIdx = static_cast<size_t>(getNodeIdx(meshVertexIdx));
-            meshVertexNeighbours.insert(meshVertexNeighbours.end(), m_node2inverseMeshVertexNeighbours[nodeIdx].begin(), m_node2inverseMeshVertexNeighbours[nodeIdx].end());
-        }
-    }
-    else
-    {
-        offsetBackwardX = 0;
-        offsetBackwardY = 0;
-        offsetForwardX = 0;
-        offsetForwardY = 0;
-    }
-
-
-    addNeighbour(meshVertexIdx, { {offsetBackwardX, offsetBackwardY, -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-    addNeighbour(meshVertexIdx, { { offsetForwardX,  offsetForwardY, +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-
-    if(m_connectivity == Connectivity::EDGE || m_connectivity == Connectivity::CORNER)
-    {
-        addNeighbour(meshVertexIdx, { {offsetBackwardX    , offsetBackwardY - 1, -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { {offsetBackwardX - 1, offsetBackwardY    , -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { {offsetBackwardX + 1, offsetBackwardY    , -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { {offsetBackwardX    , offsetBackwardY + 1, -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-
-        addNeighbour(meshVertexIdx, { { offsetForwardX    ,  offsetForwardY - 1, +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { { offsetForwardX - 1,  offsetForwardY    , +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { { offsetForwardX + 1,  offsetForwardY    , +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { { offsetForwardX    ,  offsetForwardY + 1, +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-    }
-    if(m_connectivity == Connectivity::CORNER)
-    {
-        addNeighbour(meshVertexIdx, { {offsetBackwardX - 1, offsetBackwardY - 1, -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { {offsetBackwardX + 1, offsetBackwardY - 1, -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { {offsetBackwardX - 1, offsetBackwardY + 1, -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { {offsetBackwardX + 1, offsetBackwardY + 1, -1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-
-        addNeighbour(meshVertexIdx, { { offsetForwardX - 1,  offsetForwardY - 1, +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { { offsetForwardX + 1,  offsetForwardY - 1, +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { { offsetForwardX - 1,  offsetForwardY + 1, +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-        addNeighbour(meshVertexIdx, { { offsetForwardX + 1,  offsetForwardY + 1, +1} }, meshVertexNeighbours, outOfRangeChecker, comparator);
-    }
-}
-
-
-template <typename T>
-void Lattice3Mesh<T>::addNeighbour(const size_t meshVertexIdx, const std::array<long long, 3>& offsetComponents, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator)
-{
-    std::array<long long, 3> components = linear2components(meshVertexIdx);
-    components[0] += offsetComponents[0];
-    components[1] += offsetComponents[1];
-    components[2] += offsetComponents[2];
-
-    if(!validComponents(components))
-        return;
-
-    const size_t meshVertexNeighbourIdx{components2linear(static_cast<size_t>(components[0]), static_cast<size_t>(components[1]), static_cast<size_t>(components[2]))};
-    const T meshVertexNeighbourValue{m_meshVertexData[meshVertexNeighbourIdx]};
-
-    if(outOfRangeChecker && outOfRangeChecker->operator ()(meshVertexNeighbourValue))
-        return;
-
-    if(comparator)
-    {
-        if(comparator->operator ()({meshVertexNeighbourIdx, meshVertexNeighbourValue}, {meshVertexIdx, m_meshVertexData[meshVertexIdx]}))
-            meshVertexNeighbours.emplace_back( meshVertexNeighbourIdx, meshVertexNeighbourValue );
-        else if(m_storeOffsetNeighbours)
-            m_node2inverseMeshVertexNeighbours[getNodeIdx(meshVertexNeighbourIdx)].emplace_back( meshVertexIdx, m_meshVertexData[meshVertexIdx] );
-    }
-    else
-    {
-        assert(!m_storeOffsetNeighbours);
-        meshVertexNeighbours.emplace_back( meshVertexNeighbourIdx, meshVertexNeighbourValue );
-    }
+    getNeighboursOfMeshVertex(meshVertexIdx, meshVertexNeighbours, rangeMin, rangeMax, IndexValueGreaterComparator<T>());
 }
 
 
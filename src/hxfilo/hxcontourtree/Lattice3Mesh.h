@@ -4,8 +4,10 @@
 
 #include <mclib/McVec3.h>
 #include <mclib/McDim3l.h>
+#include <hxcontourtree/CompareCheckFunctors.h>
 #include <array>
 #include <vector>
+#include <cassert>
 
 
 
@@ -41,8 +43,8 @@ public:
     virtual ~Lattice3MeshBase() {}
 
     size_t getNumMeshVertices() { return static_cast<size_t>(m_dims.nbVoxel()); }
-    void setInterpretation(Interpretation interpretation) { m_interpretation = interpretation; }
-    void setConnectivity(Connectivity connectivity) { m_connectivity = connectivity; }
+    void setInterpretation(Interpretation interpretation) { m_interpretation = interpretation; computeStencils(); }
+    void setConnectivity(Connectivity connectivity) { m_connectivity = connectivity; computeStencils(); }
 
     void setDeformation(const HxLattice3* backwardDeformation, const HxLattice3* forwardDeformation);
     void unsetDeformation();
@@ -64,10 +66,19 @@ public:
     virtual size_t getMeshVertexIdxOfMaxValue(const std::vector<size_t>& meshVertexIndices) const = 0;
 
 protected:
-    std::array<long long, 3> linear2components(const size_t meshVertexIdx) const;
-    bool validComponents(const std::array<long long, 3>& components) const;
-    size_t components2linear(const std::array<long long, 3>& components) const;
-    size_t components2linear(const size_t x, const size_t y, const size_t z) const;
+    inline std::array<long long, 3> linear2components(const size_t meshVertexIdx) const;
+    inline bool validComponents(const std::array<long long, 3>& components) const;
+    inline size_t components2linear(const std::array<long long, 3>& components) const;
+    inline size_t components2linear(const size_t x, const size_t y, const size_t z) const;
+
+    void computeStencils();
+    bool hasDeformedZNeighbours() const;
+    std::array<long long, 4> getDeformationOffsets(const size_t meshVertexIdx) const;
+
+    template <typename Visitor>
+    inline void visitStencil(const size_t meshVertexIdx, const std::array<long long, 3>& components, const bool interior,
+                             const std::vector<std::array<long long, 3> >& stencil, const std::vector<long long>& stencilOffsets, const size_t nStencil,
+                             const std::array<long long, 4>& deformationOffsets, Visitor& visitor) const;
 
 
     Interpretation m_interpretation;
@@ -86,18 +97,20 @@ protected:
     int m_nDataVarDeformation;
     const float* m_meshVertexBackwardData;
     const float* m_meshVertexFordwardData;
+
+    // Neighbour stencils of the current interpretation and connectivity, as component offsets and
+    // as linear offsets. The linear offsets are only valid for interior mesh vertices, i.e. mesh
+    // vertices whose whole stencil lies inside the lattice, which need no bounds checks.
+    // The z stencil is ordered such that its first two entries are the direct z neighbours.
+    std::vector<std::array<long long, 3> > m_xyStencil;
+    std::vector<long long> m_xyStencilOffsets;
+    std::vector<std::array<long long, 3> > m_zStencil;
+    std::vector<long long> m_zStencilOffsets;
 };
 
 
 
 
-template <typename T>
-struct IndexValueAbstractBaseComparator;
-
-template <typename T>
-class OutOfRangeChecker;
-
-
 template <typename T>
 class Lattice3Mesh : public Lattice3MeshBase
 {
@@ -123,13 +136,25 @@ public:
 
     void getSmallerNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax);
     void getGreaterNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax);
-    void getNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax, const IndexValueAbstractBaseComparator<T>* comparator);
+
+    // Appends all in-range neighbours n of the mesh vertex with comparator(n, meshVertex) to meshVertexNeighbours.
+    // The comparator is a template parameter, so the calls are resolved statically. meshVertexNeighbours is not
+    // cleared and keeps its capacity, so a buffer reused across calls does not allocate.
+    template <typename Comparator>
+    inline void getNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax, const Comparator& comparator);
 
 private:
-    void getNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator);
-    void getXYNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator);
-    void getZNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator);
-    void addNeighbour(const size_t meshVertexIdx, const std::array<long long, 3>& offsetComponents, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, const OutOfRangeChecker<T>* outOfRangeChecker, const IndexValueAbstractBaseComparator<T>* comparator);
+    template <typename Comparator>
+    struct NeighbourCollector
+    {
+        inline void operator ()(const size_t meshVertexNeighbourIdx);
+
+        Lattice3Mesh<T>& m_mesh;
+        const std::pair<size_t, T> m_meshVertex;
+        std::vector<std::pair<size_t, T> >& m_meshVertexNeighbours;
+        const OutOfRangeChecker<T> m_outOfRangeChecker;
+        const Comparator& m_comparator;
+    };
 
 
     float m_globalMin;
@@ -142,4 +167,138 @@ private:
 };
 
 
+
+
+
+inline std::array<long long, 3> Lattice3MeshBase::linear2components(const size_t linear) const
+{
+    std::array<long long, 3> components{ {0, 0, static_cast<long long>(linear) / (m_dims.ny * m_dims.nx)} };
+    components[0] = (static_cast<long long>(linear) - components[2] * ((m_dims.ny * m_dims.nx)));
+    components[1] = components[0] / m_dims.nx;
+    components[0] -= components[1] * m_dims.nx;
+
+    return components;
+}
+
+
+inline bool Lattice3MeshBase::validComponents(const std::array<long long, 3>& components) const
+{
+    if(components[0] < 0 || components[1] < 0 || components[2] < 0 ||
+       components[0] >= m_dims.nx || components[1] >= m_dims.ny || components[2] >= m_dims.nz)
+        return false;
+
+    return true;
+}
+
+
+inline size_t Lattice3MeshBase::components2linear(const std::array<long long, 3>& components) const
+{
+    assert(validComponents(components));
+
+    return components2linear(static_cast<size_t>(components[0]),
+                             static_cast<size_t>(components[1]),
+                             static_cast<size_t>(components[2]));
+}
+
+
+inline size_t Lattice3MeshBase::components2linear(const size_t x, const size_t y, const size_t z) const
+{
+    return (((z)*m_dims.ny + y)*m_dims.nx + x);
+}
+
+
+template <typename Visitor>
+inline void Lattice3MeshBase::visitStencil(const size_t meshVertexIdx, const std::array<long long, 3>& components, const bool interior,
+                                           const std::vector<std::array<long long, 3> >& stencil, const std::vector<long long>& stencilOffsets, const size_t nStencil,
+                                           const std::array<long long, 4>& deformationOffsets, Visitor& visitor) const
+{
+    assert(nStencil <= stencil.size());
+
+    if(interior)
+    {
+        const long long linear{static_cast<long long>(meshVertexIdx)};
+
+        for(size_t i = 0; i < nStencil; ++i)
+            visitor(static_cast<size_t>(linear + stencilOffsets[i]));
+
+        return;
+    }
+
+    std::array<long long, 3> neighbourComponents;
+
+    for(size_t i = 0; i < nStencil; ++i)
+    {
+        const std::array<long long, 3>& offset = stencil[i];
+
+        neighbourComponents[0] = components[0] + offset[0];
+        neighbourComponents[1] = components[1] + offset[1];
+        neighbourComponents[2] = components[2] + offset[2];
+
+        if(offset[2] < 0)
+        {
+            neighbourComponents[0] += deformationOffsets[0];
+            neighbourComponents[1] += deformationOffsets[1];
+        }
+        else if(offset[2] > 0)
+        {
+            neighbourComponents[0] += deformationOffsets[2];
+            neighbourComponents[1] += deformationOffsets[3];
+        }
+
+        if(!validComponents(neighbourComponents))
+            continue;
+
+        visitor(components2linear(neighbourComponents));
+    }
+}
+
+
+
+
+template <typename T>
+template <typename Comparator>
+inline void Lattice3Mesh<T>::NeighbourCollector<Comparator>::operator ()(const size_t meshVertexNeighbourIdx)
+{
+    const T meshVertexNeighbourValue{m_mesh.m_meshVertexData[meshVertexNeighbourIdx]};
+
+    if(m_outOfRangeChecker(meshVertexNeighbourValue))
+        return;
+
+    if(m_comparator(std::pair<size_t, T>(meshVertexNeighbourIdx, meshVertexNeighbourValue), m_meshVertex))
+        m_meshVertexNeighbours.emplace_back(meshVertexNeighbourIdx, meshVertexNeighbourValue);
+    else if(m_mesh.m_storeOffsetNeighbours)
+        m_mesh.m_node2inverseMeshVertexNeighbours[m_mesh.getNodeIdx(meshVertexNeighbourIdx)].emplace_back(m_meshVertex);
+}
+
+
+template <typename T>
+template <typename Comparator>
+inline void Lattice3Mesh<T>::getNeighboursOfMeshVertex(const size_t meshVertexIdx, std::vector<std::pair<size_t, T> >& meshVertexNeighbours, float rangeMin, float rangeMax, const Comparator& comparator)
+{
+    NeighbourCollector<Comparator> collector{*this, {meshVertexIdx, m_meshVertexData[meshVertexIdx]}, meshVertexNeighbours, {rangeMin, rangeMax}, comparator};
+
+    const std::array<long long, 3> components = linear2components(meshVertexIdx);
+    const bool interiorXY{components[0] > 0 && components[0] < m_dims.nx - 1 && components[1] > 0 && components[1] < m_dims.ny - 1};
+    const std::array<long long, 4> noDeformation{ {0, 0, 0, 0} };
+
+    visitStencil(meshVertexIdx, components, interiorXY, m_xyStencil, m_xyStencilOffsets, m_xyStencil.size(), noDeformation, collector);
+
+    if(m_interpretation == Interpretation::XY_SLICES)
+        return;
+
+    if(m_nDataVarDeformation && m_interpretation == Interpretation::SPATIOTEMPORAL)
+    {
+        const std::vector<std::pair<size_t, T> >& inverseNeighbours = m_node2inverseMeshVertexNeighbours[static_cast<size_t>(getNodeIdx(meshVertexIdx))];
+        meshVertexNeighbours.insert(meshVertexNeighbours.end(), inverseNeighbours.begin(), inverseNeighbours.end());
+
+        visitStencil(meshVertexIdx, components, false, m_zStencil, m_zStencilOffsets, m_zStencil.size(), getDeformationOffsets(meshVertexIdx), collector);
+    }
+    else
+    {
+        const bool interiorZ{interiorXY && components[2] > 0 && components[2] < m_dims.nz - 1};
+        visitStencil(meshVertexIdx, components, interiorZ, m_zStencil, m_zStencilOffsets, m_zStencil.size(), noDeformation, collector);
+    }
+}
+
+
 #endif // LATTICE3MESH_H
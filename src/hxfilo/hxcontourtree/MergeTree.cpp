@@ -165,7 +165,7 @@ void MergeTree<T>::computeMergeTree(float globalMin, float globalMax)
         IndexValueGreaterComparator<T> comparator;
 
         m_mesh->resetStoreOffsetNeighbours();
-        computeMergeTree(sortedNodeIndices.crbegin(), sortedNodeIndices.crend(), &comparator, globalMin, globalMax);
+        computeMergeTree(sortedNodeIndices.crbegin(), sortedNodeIndices.crend(), comparator, globalMin, globalMax);
         m_mesh->unsetStoreOffsetNeighbours();
 
         computeSortedMaximaAndSaddles();
@@ -175,7 +175,7 @@ void MergeTree<T>::computeMergeTree(float globalMin, float globalMax)
         IndexValueSmallerComparator<T> comparator;
 
         m_mesh->resetStoreOffsetNeighbours();
-        computeMergeTree(sortedNodeIndices.cbegin(), sortedNodeIndices.cend(), &comparator, globalMin, globalMax);
+        computeMergeTree(sortedNodeIndices.cbegin(), sortedNodeIndices.cend(), comparator, globalMin, globalMax);
         m_mesh->unsetStoreOffsetNeighbours();
 
         computeSortedMaximaAndSaddles();
@@ -200,17 +200,17 @@ void MergeTree<T>::computeFastMergeSegmentation(float rangeMin, float rangeMax,
     {
         IndexValueGreaterComparator<T> comparator;
         if(m_segmentationMode == SegmentationMode::DISJOINT)
-            computeFastDisjointMergeSegmentation(revUpperBoundIt, revLowerBoundIt, &comparator, m_mesh->getDataMin(), rangeMin, rangeMax, persistenceValue, res);
+            computeFastDisjointMergeSegmentation(revUpperBoundIt, revLowerBoundIt, comparator, m_mesh->getDataMin(), rangeMin, rangeMax, persistenceValue, res);
         else // m_segmentationMode == NESTED || m_segmentationMode == NESTED_CORES
-            computeFastNestedMergeSegmentation(revUpperBoundIt, revLowerBoundIt, &comparator, m_mesh->getDataMin(), rangeMin, rangeMax, persistenceValue, res);
+            computeFastNestedMergeSegmentation(revUpperBoundIt, revLowerBoundIt, comparator, m_mesh->getDataMin(), rangeMin, rangeMax, persistenceValue, res);
     }
     else // m_mergeMode == SPLIT_TREE
     {
         IndexValueSmallerComparator<T> comparator;
         if(m_segmentationMode == SegmentationMode::DISJOINT)
-            computeFastDisjointMergeSegmentation(lowerBoundIt, upperBoundIt, &comparator, m_mesh->getDataMax(), rangeMin, rangeMax, persistenceValue, res);
+            computeFastDisjointMergeSegmentation(lowerBoundIt, upperBoundIt, comparator, m_mesh->getDataMax(), rangeMin, rangeMax, persistenceValue, res);
         else // m_segmentationMode == NESTED || m_segmentationMode == NESTED_CORES
-            computeFastNestedMergeSegmentation(lowerBoundIt, upperBoundIt, &comparator, m_mesh->getDataMax(), rangeMin, rangeMax, persistenceValue, res);
+            computeFastNestedMergeSegmentation(lowerBoundIt, upperBoundIt, comparator, m_mesh->getDataMax(), rangeMin, rangeMax, persistenceValue, res);
     }
 }
 
@@ -279,7 +279,7 @@ void MergeTree<T>::sortNeighboursAccordingToMajorityVote(std::vector<std::pair<s
 
 
 template <typename T>
-void MergeTree<T>::sortNeighboursAccordingToExtrema(std::vector<std::pair<size_t, T> >& meshVertexNeighbours, SetUnionDataStructure& setUnion, IndexValueAbstractBaseComparator<T>* comparator)
+void MergeTree<T>::sortNeighboursAccordingToExtrema(std::vector<std::pair<size_t, T> >& meshVertexNeighbours, SetUnionDataStructure& setUnion, const IndexValueAbstractBaseComparator<T>* comparator)
 {
     size_t nodeNeighbourIdx;
     size_t nodeNeighbourComponent;
@@ -121,7 +121,7 @@ public:
 
 private:
     void sortNeighboursAccordingToMajorityVote(std::vector<std::pair<size_t, T> >& meshVertexNeighbours, SetUnionDataStructure& setUnion);
-    void sortNeighboursAccordingToExtrema(std::vector<std::pair<size_t, T> >& meshVertexNeighbours, SetUnionDataStructure& setUnion, IndexValueAbstractBaseComparator<T>* comparator);
+    void sortNeighboursAccordingToExtrema(std::vector<std::pair<size_t, T> >& meshVertexNeighbours, SetUnionDataStructure& setUnion, const IndexValueAbstractBaseComparator<T>* comparator);
     void computeSortedMaximaAndSaddles();
 
 
@@ -129,8 +129,8 @@ private:
     U abs(U a, U b) { return std::max(a, b) - std::min(a, b); }
 
 
-    template <typename IT>
-    void computeMergeTree(IT begin, IT end, IndexValueAbstractBaseComparator<T>* comparator, float rangeMin, float rangeMax)
+    template <typename IT, typename Comparator>
+    void computeMergeTree(IT begin, IT end, const Comparator& comparator, float rangeMin, float rangeMax)
     {
         // for storing merge tree
         SetUnionDataStructure setUnion;
@@ -154,6 +154,7 @@ private:
 
         size_t meshVertexIdx;
         std::vector<std::pair<size_t, T> > meshVertexNeighbours;
+        meshVertexNeighbours.reserve(26);
 
         size_t nodeNeighbourIdx;
         size_t nodeNeighbourComponent;
@@ -187,11 +188,11 @@ private:
 
 
             if(m_sortNeighbours == SortNeighbours::BY_VALUE)
-                std::sort(meshVertexNeighbours.begin(), meshVertexNeighbours.end(), IndexValueInvertedComparator<T>(comparator));
+                std::sort(meshVertexNeighbours.begin(), meshVertexNeighbours.end(), IndexValueInvertedPolicyComparator<T, Comparator>(comparator));
             else if(m_sortNeighbours == SortNeighbours::BY_VOTE)
                 sortNeighboursAccordingToMajorityVote(meshVertexNeighbours, m_disjointSetUnion);
             else if(m_sortNeighbours == SortNeighbours::BY_EXTREMA)
-                sortNeighboursAccordingToExtrema(meshVertexNeighbours, m_disjointSetUnion, comparator);
+                sortNeighboursAccordingToExtrema(meshVertexNeighbours, m_disjointSetUnion, &comparator);
 
             // for storing merge tree
             for(const std::pair<size_t, T>& meshVertexNeighbour : meshVertexNeighbours)
@@ -221,7 +222,7 @@ private:
             nodeNeighbourComponent = m_disjointSetUnion.findSetId(nodeNeighbourIdx);
             assert(nodeComponent != nodeNeighbourComponent);
 
-            assert(!(comparator->operator ()(m_extremeValueOfDisjointComponent[nodeComponent], m_extremeValueOfDisjointComponent[nodeNeighbourComponent])));
+            assert(!(comparator(m_extremeValueOfDisjointComponent[nodeComponent], m_extremeValueOfDisjointComponent[nodeNeighbourComponent])));
             m_disjointSetUnion.mergeSetsOfElements(nodeIdx, nodeNeighbourIdx);
 
 
@@ -241,7 +242,7 @@ private:
                 assert(nodeComponent != m_nestedSetUnion.findSetId(nodeParentIdx));
 
 //                assert(!(comparator->operator ()(m_extremeValueOfNestedComponent[nodeComponent], m_extremeValueOfNestedComponent[nodeParentComponent])));
-                assert(!(comparator->operator ()(m_extremeValueOfNestedComponent[nodeComponent], m_extremeValueOfNestedComponent[m_nestedSetUnion.findSetId(nodeParentIdx)])));
+                assert(!(comparator(m_extremeValueOfNestedComponent[nodeComponent], m_extremeValueOfNestedComponent[m_nestedSetUnion.findSetId(nodeParentIdx)])));
                 m_nestedSetUnion.mergeSetsOfElements(nodeIdx, nodeParentIdx);
             }
             else    // saddle node
@@ -251,7 +252,7 @@ private:
                     size_t nodeParentComponent = m_nestedSetUnion.findSetId(nodeParentIdx);
                     assert(nodeComponent != nodeParentComponent);
 
-                    if(comparator->operator ()(m_extremeValueOfNestedComponent[nodeParentComponent], m_extremeValueOfNestedComponent[nodeComponent]))
+                    if(comparator(m_extremeValueOfNestedComponent[nodeParentComponent], m_extremeValueOfNestedComponent[nodeComponent]))
                         m_extremeValueOfNestedComponent[nodeComponent] = m_extremeValueOfNestedComponent[nodeParentComponent];
                 }
             }
@@ -259,8 +260,8 @@ private:
     }
 
 
-    template <typename IT>
-    void computeFastDisjointMergeSegmentation(IT begin, IT end, IndexValueAbstractBaseComparator<T>* comparator, float dataOpposite, float rangeMin, float rangeMax, float persistenceValue, HxUniformLabelField3* res)
+    template <typename IT, typename Comparator>
+    void computeFastDisjointMergeSegmentation(IT begin, IT end, const Comparator& comparator, float dataOpposite, float rangeMin, float rangeMax, float persistenceValue, HxUniformLabelField3* res)
     {
         SetUnionDataStructure setUnion = m_disjointSetUnion;
 
@@ -276,6 +277,7 @@ private:
 
         size_t meshVertexIdx;
         std::vector<std::pair<size_t, T> > meshVertexNeighbours;
+        meshVertexNeighbours.reserve(26);
 
         size_t saddleNeighbourIdx;
         size_t saddleNeighbourComponent;
@@ -387,7 +389,7 @@ private:
                 if( (m_persistenceMode == PersistenceMode::GLOBAL && static_cast<float>(minComponentLength) < persistenceValue) ||
                     (m_persistenceMode == PersistenceMode::ADAPTIVE && (static_cast<float>(minComponentLength) / minDataHeight) < persistenceValue ) )
                 {
-                    if(comparator->operator ()(m_extremeValueOfDisjointComponent[saddleNeighbourComponent], m_extremeValueOfDisjointComponent[saddleComponent]))
+                    if(comparator(m_extremeValueOfDisjointComponent[saddleNeighbourComponent], m_extremeValueOfDisjointComponent[saddleComponent]))
                         setUnion.mergeSetsOfElements(saddleIdx, saddleNeighbourIdx);
                     else
                         setUnion.mergeSetsOfElements(saddleNeighbourIdx, saddleIdx);
@@ -425,8 +427,8 @@ private:
     }
 
 
-    template <typename IT>
-    void computeFastNestedMergeSegmentation(IT begin, IT end, IndexValueAbstractBaseComparator<T>* comparator, float dataOpposite, float rangeMin, float rangeMax, float persistenceValue, HxUniformLabelField3* res)
+    template <typename IT, typename Comparator>
+    void computeFastNestedMergeSegmentation(IT begin, IT end, const Comparator& comparator, float dataOpposite, float rangeMin, float rangeMax, float persistenceValue, HxUniformLabelField3* res)
     {
         SetUnionDataStructure setUnion = m_nestedSetUnion;
 
@@ -493,7 +495,7 @@ private:
                     (m_persistenceMode == PersistenceMode::ADAPTIVE && (static_cast<float>(saddleParentComponentLength) / saddleParentDataHeight) < persistenceValue) )
                 {
 //                    assert(!(comparator->operator ()(m_extremeValueOfNestedComponent[saddleParentComponent], m_extremeValueOfNestedComponent[saddleComponent])));
-                    assert(!(comparator->operator ()(m_extremeValueOfNestedComponent[saddleParentComponent], m_extremeValueOfNestedComponent[setUnion.findSetId(saddleIdx)])));
+                    assert(!(comparator(m_extremeValueOfNestedComponent[saddleParentComponent], m_extremeValueOfNestedComponent[setUnion.findSetId(saddleIdx)])));
                     setUnion.mergeSetsOfElements(saddleParentIdx, saddleIdx);
                 }
                 else if(!saddleBecomesBackground)
@@ -516,7 +518,7 @@ private:
                 saddleParentComponent = setUnion.findSetId(unmergedParents.front());
 
 //                assert(!(comparator->operator ()(m_extremeValueOfNestedComponent[saddleParentComponent], m_extremeValueOfNestedComponent[saddleComponent])));
-                assert(!(comparator->operator ()(m_extremeValueOfNestedComponent[saddleParentComponent], m_extremeValueOfNestedComponent[setUnion.findSetId(saddleIdx)])));
+                assert(!(comparator(m_extremeValueOfNestedComponent[saddleParentComponent], m_extremeValueOfNestedComponent[setUnion.findSetId(saddleIdx)])));
                 setUnion.mergeSetsOfElements(unmergedParents.front(), saddleIdx);
             }
             else if(m_segmentationMode == SegmentationMode::NESTED_CORES)
@@ -13,6 +13,7 @@
 
 #include "AngularPointRepresentation3d.h"
 #include "AngularCacheObject3d.h"
+#include "CorrespondenceGraph.h"
 #include "PointMatchingDataStruct.h"
 #include "PointMatchingScoringFunction.h"
 #include "Transformation.h"
@@ -79,7 +80,7 @@ AngularPointRepresentation3d::getDirections() const
     return mDirections;
 }
 
-const std::vector<std::vector<double> > & 
+const PointDistanceMatrix & 
 AngularPointRepresentation3d::getDistMatrix() const
 {
     return distMatrix;
@@ -91,25 +92,15 @@ AngularPointRepresentation3d::computeBBoxAndDistMatrix()
 {
     int numPoints = mCoords.size();
 
-    // compute bounding box and resize distMatrix
+    // compute bounding box
     bbox.makeEmpty();
-    distMatrix.resize(numPoints);
     for ( int i=0; i<numPoints; i++ ) {
         bbox.extendBy(mCoords[i]);
-        distMatrix[i].resize(numPoints);
     }
 
     // compute distance matrix
-    maximumDistance = 0.0f;
-    for ( int i=0; i<numPoints; i++ ) {
-        distMatrix[i][i] = 0.0f;
-        for ( int j=i+1; j<numPoints; j++ ) {
-            distMatrix[i][j] = distMatrix[j][i] = 
-                (mCoords[i] - mCoords[j]).length();
-            if ( distMatrix[i][j] > maximumDistance ) 
-                maximumDistance = distMatrix[i][j];
-        }
-    }
+    distMatrix.setCoords(mCoords);
+    maximumDistance = distMatrix.getMaximumDistance();
     bbox.extendByEps(0.05);
 }
 
@@ -153,27 +144,77 @@ AngularPointRepresentation3d::computeCorrespondenceGraphVertices(
     }
 }
 
+namespace {
+
+// Accepts an edge of the correspondence graph, if the angles between the
+// directions of the points in the two sets differ by less than the given
+// angle (in degrees). The angles between all pairs of directions are
+// computed once per point set.
+class AngleDifferenceEdgeCheck {
+public:
+    AngleDifferenceEdgeCheck(const std::vector<McVec3f> & directions1,
+                             const std::vector<McVec3f> & directions2,
+                             const double                 maxAngleDist)
+        : mNumPoints1(directions1.size())
+        , mNumPoints2(directions2.size())
+        , mMaxAngleDist(maxAngleDist)
+    {
+        computeAngles(directions1, mAngles1);
+        computeAngles(directions2, mAngles2);
+    }
+
+    bool operator()(const int a, const int b, const int c, const int d) const
+    {
+        double angleDiffDiff = fabs(mAngles1[a*mNumPoints1 + c] - mAngles2[b*mNumPoints2 + d]);
+        angleDiffDiff = angleDiffDiff/(2.0*M_PI)*360.0;
+
+        return angleDiffDiff < mMaxAngleDist;
+    }
+
+private:
+    static void computeAngles(const std::vector<McVec3f> & directions,
+                              std::vector<double>        & angles)
+    {
+        const int numPoints = directions.size();
+        angles.resize(numPoints*numPoints);
+        for ( int i=0; i<numPoints; i++ ) {
+            for ( int j=0; j<numPoints; j++ ) {
+                const double cosAngle = directions[i].dot(directions[j]);
+                angles[i*numPoints + j] = acos(cosAngle);
+            }
+        }
+    }
+
+    const int           mNumPoints1;
+    const int           mNumPoints2;
+    const double        mMaxAngleDist;
+    std::vector<double> mAngles1;
+    std::vector<double> mAngles2;
+};
+
+}
+
 void 
 AngularPointRepresentation3d::computeCorrespondenceGraphEdges(
         const PointRepresentation * pointSet2, 
         const std::vector<McVec2i>           & corrGraph,
-        std::vector<McBitfield>              & connected) const
+        std::vector<std::vector<int> >      & adjacency) const
 {
-    connected.resize(corrGraph.size());
+    const AngularPointRepresentation3d * angularPointSet2 =
+        dynamic_cast<const AngularPointRepresentation3d *>(pointSet2);
 
-    for ( size_t i=0; i<connected.size(); i++ ) {
-        connected[i].resize(corrGraph.size());
-        connected[i].setAll();
-    }
-        
-    for ( size_t i=0; i<corrGraph.size(); i++ ) {
-        for ( size_t j=i+1; j<corrGraph.size(); j++ ) {
-            if ( !connectByEdge(i, j, pointSet2, corrGraph) ) {
-                connected[i].unset(j);
-                connected[j].unset(i);
-            } 
-        }
-    }   
+    assert(angularPointSet2);
+
+    const AngleDifferenceEdgeCheck angleCheck(this->getDirections(),
+                                              angularPointSet2->getDirections(),
+                                              mMaxAngleDistForInitMatching);
+
+    computeCorrespondenceGraphEdgesFromSortedDistances(this->getDistMatrix(),
+                                                       angularPointSet2->getDistMatrix(),
+                                                       mCliqueDistThreshold,
+                                                       corrGraph,
+                                                       angleCheck,
+                                                       adjacency);
 }
 
 bool 
@@ -182,10 +223,10 @@ AngularPointRepresentation3d::connectByEdge( const int vertex1,
                                              const PointRepresentation * otherPoints,
                                              const std::vector<McVec2i>   & corrGraph) const
 {
-    const std::vector<std::vector<double> > & distMatrix1 = this->getDistMatrix();
-    const std::vector<std::vector<double> > & distMatrix2 = otherPoints->getDistMatrix();
-    bool distanceThresholdOK = !(fabs(distMatrix1[corrGraph[vertex1][0]][corrGraph[vertex2][0]]- 
-                                    distMatrix2[corrGraph[vertex1][1]][corrGraph[vertex2][1]])>
+    const PointDistanceMatrix & distMatrix1 = this->getDistMatrix();
+    const PointDistanceMatrix & distMatrix2 = otherPoints->getDistMatrix();
+    bool distanceThresholdOK = !(fabs(double(distMatrix1(corrGraph[vertex1][0], corrGraph[vertex2][0]))- 
+                                    double(distMatrix2(corrGraph[vertex1][1], corrGraph[vertex2][1])))>
                                     mCliqueDistThreshold);
     const AngularPointRepresentation3d* otherPointsA = dynamic_cast<const AngularPointRepresentation3d*>(otherPoints);
     const std::vector<McVec3f> & directions1 = this->getDirections();
@@ -14,6 +14,7 @@
 #include <mclib/McBox3f.h>
 #include <mclib/McBitfield.h>
 
+#include "PointDistanceMatrix.h"
 #include "PointRepresentation.h"
 #include "api.h"
 
@@ -34,7 +35,7 @@ public:
     const std::vector<McVec3f> & getCoords() const;
     const std::vector<McVec3f> & getOrigCoords() const;
     const std::vector<McVec3f> & getDirections() const;
-    const std::vector<std::vector<double> > & getDistMatrix() const;
+    const PointDistanceMatrix & getDistMatrix() const;
 
     virtual int getNumPoints() const;
 
@@ -45,7 +46,7 @@ public:
     virtual void computeCorrespondenceGraphEdges(
                 const PointRepresentation * pointSet2, 
                 const std::vector<McVec2i>           & corrGraph,
-                std::vector<McBitfield>              & connected) const;
+                std::vector<std::vector<int> >      & adjacency) const;
 
     virtual void computeTransformation(
                 const PointRepresentation     * pointSet2,
@@ -107,7 +108,7 @@ private:
     std::vector<McVec3f>           mDirections;
     McBox3f                     bbox;
     double                      maximumDistance;
-    std::vector<std::vector<double> > distMatrix;
+    PointDistanceMatrix         distMatrix;
     int                         transformType;
     double                      mMaxPointDistance;
     double                      mMaxPointDistance2;
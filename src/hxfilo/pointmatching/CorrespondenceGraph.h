@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////
+//
+// CorrespondenceGraph.h
+//
+// Main Authors: Baum
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef CORRESPONDENCE_GRAPH_H
+#define CORRESPONDENCE_GRAPH_H
+
+#include <mclib/McVec2i.h>
+
+#include "PointDistanceMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/** Distance between two points of the same point set. */
+struct CorrespondenceGraphPointPair {
+    float dist;
+    int   point1;
+    int   point2;
+
+    bool operator<(const CorrespondenceGraphPointPair & other) const
+    { return (dist < other.dist); }
+};
+
+/** Edge check accepting all edges that satisfy the distance criterion. */
+struct CorrespondenceGraphAcceptAllEdges {
+    bool operator()(const int, const int, const int, const int) const
+    { return true; }
+};
+
+/**
+    Computes the edges of the correspondence graph with the vertices
+    @c corrGraph. Each vertex is a pair of a point of the first and a
+    point of the second point set. Two vertices (a,b) and (c,d) are
+    connected, if the distance between a and c in the first set and
+    the distance between b and d in the second set differ by at most
+    @c cliqueDistThreshold, and if @c edgeCheck(a, b, c, d) is true.
+    The edge check must be symmetric, i.e. @c edgeCheck(c, d, a, b)
+    must return the same value.
+
+    Instead of testing all pairs of vertices, the distances between
+    all pairs of points of the second set are sorted once. For each
+    pair of points of the first set, only the pairs of the second set
+    with a distance in the admissible range are visited. Since both
+    distance matrices are symmetric, only pairs with a<=c and b<=d are
+    visited. The output is a sorted adjacency list per vertex, not
+    containing the vertex itself.
+*/
+template <class EdgeCheck>
+void computeCorrespondenceGraphEdgesFromSortedDistances(
+        const PointDistanceMatrix               & distMatrix1,
+        const PointDistanceMatrix               & distMatrix2,
+        const double                              cliqueDistThreshold,
+        const std::vector<McVec2i>              & corrGraph,
+        const EdgeCheck                         & edgeCheck,
+        std::vector<std::vector<int> >          & adjacency)
+{
+    const int numPoints1 = distMatrix1.getNumPoints();
+    const int numPoints2 = distMatrix2.getNumPoints();
+
+    adjacency.clear();
+    adjacency.resize(corrGraph.size());
+
+    // vertex index of each pair of points, -1 if pair is not a vertex
+    std::vector<int> vertexIdx(numPoints1*numPoints2, -1);
+    std::vector<bool> isPointOfVertex1(numPoints1, false);
+    for ( size_t i=0; i<corrGraph.size(); i++ ) {
+        vertexIdx[corrGraph[i][0]*numPoints2 + corrGraph[i][1]] = i;
+        isPointOfVertex1[corrGraph[i][0]] = true;
+    }
+
+    // distances between all unordered pairs of points of the second set,
+    // including the pairs (b,b)
+    std::vector<CorrespondenceGraphPointPair> pairs2;
+    pairs2.reserve(size_t(numPoints2)*size_t(numPoints2 + 1)/2);
+    for ( int b=0; b<numPoints2; b++ ) {
+        for ( int d=b; d<numPoints2; d++ ) {
+            CorrespondenceGraphPointPair pair;
+            pair.dist = distMatrix2(b, d);
+            pair.point1 = b;
+            pair.point2 = d;
+            pairs2.push_back(pair);
+        }
+    }
+    std::sort(pairs2.begin(), pairs2.end());
+
+    const size_t numPairs2 = pairs2.size();
+
+    std::vector<float> row1(numPoints1);
+
+    for ( int a=0; a<numPoints1; a++ ) {
+        if ( !isPointOfVertex1[a] )
+            continue;
+
+        for ( int c=a; c<numPoints1; c++ )
+            row1[c] = distMatrix1(a, c);
+
+        for ( int c=a; c<numPoints1; c++ ) {
+            if ( !isPointOfVertex1[c] )
+                continue;
+
+            // distances are compared in double precision as before
+            const double dist1 = row1[c];
+
+            // Vertices are connected iff !(fabs(dist1 - dist2) > threshold).
+            // Both (dist1 - dist2 > threshold) and (dist2 - dist1 > threshold)
+            // are monotone in dist2, so the admissible pairs are contiguous.
+            size_t lo = 0;
+            size_t hi = numPairs2;
+            while ( lo < hi ) {
+                const size_t mid = lo + (hi - lo) / 2;
+                if ( dist1 - double(pairs2[mid].dist) > cliqueDistThreshold )
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            for ( size_t k=lo; k<numPairs2; k++ ) {
+                if ( double(pairs2[k].dist) - dist1 > cliqueDistThreshold )
+                    break;
+
+                const int b = pairs2[k].point1;
+                const int d = pairs2[k].point2;
+
+                // (a,b) - (c,d)
+                const int u = vertexIdx[a*numPoints2 + b];
+                const int v = vertexIdx[c*numPoints2 + d];
+                if ( u >= 0 && v >= 0 && u != v && edgeCheck(a, b, c, d) ) {
+                    adjacency[u].push_back(v);
+                    adjacency[v].push_back(u);
+                }
+
+                // (a,d) - (c,b), same as above if a==c or b==d
+                if ( a == c || b == d )
+                    continue;
+
+                const int w = vertexIdx[a*numPoints2 + d];
+                const int x = vertexIdx[c*numPoints2 + b];
+                if ( w >= 0 && x >= 0 && edgeCheck(a, d, c, b) ) {
+                    adjacency[w].push_back(x);
+                    adjacency[x].push_back(w);
+                }
+            }
+        }
+    }
+
+    for ( size_t i=0; i<adjacency.size(); i++ ) {
+        std::sort(adjacency[i].begin(), adjacency[i].end());
+    }
+}
+
+#endif
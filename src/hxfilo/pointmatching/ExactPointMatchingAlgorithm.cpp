@@ -18,6 +18,17 @@ ExactPointMatchingAlgorithm::ExactPointMatchingAlgorithm()
     m_useUserDefinedEdgeWeights = false;
 }
 
+PointMatchingAlgorithm *
+ExactPointMatchingAlgorithm::duplicate() const
+{
+    ExactPointMatchingAlgorithm * algorithm = new ExactPointMatchingAlgorithm();
+    duplicateSettings(algorithm);
+
+    algorithm->m_useUserDefinedEdgeWeights = m_useUserDefinedEdgeWeights;
+    algorithm->m_userDefinedEdgeWeights = m_userDefinedEdgeWeights;
+
+    return algorithm;
+}
 
 void
 ExactPointMatchingAlgorithm::setUserDefinedEdgeWeights(
@@ -112,22 +123,26 @@ ExactPointMatchingAlgorithm::computeBestMatching(const PointRepresentation * poi
     bool validMatchingFound = false;
     double bestScore = -1.0;
     double newScore = 0.0;
-    std::vector<McDijkstraEdge *> bestMatching;
-    std::vector<McDijkstraEdge *> newMatching;
+    std::vector<int> newRefPoints;
+    std::vector<int> newQueryPoints;
+    refPoints.clear();
+    queryPoints.clear();
     do {
-        validMatchingFound = findMatching(newMatching);
+        // matching with minimal sum of squared edge weights that has
+        // one more edge than the previous one
+        validMatchingFound = m_bipartiteMatching.augment();
+        m_bipartiteMatching.getMatching(newRefPoints, newQueryPoints);
 
-	newScore = getScoreOfMatching(pointRep1, pointRep2, newMatching);
+	newScore = getScoreOfMatching(pointRep1, pointRep2, newRefPoints, newQueryPoints);
 
-        if ( newMatching.size()>=3 && newScore>bestScore )
+        if ( newRefPoints.size()>=3 && newScore>bestScore )
         {
             bestScore = newScore;
-            bestMatching = newMatching;
+            refPoints = newRefPoints;
+            queryPoints = newQueryPoints;
         }
     } while ( validMatchingFound && newScore > 0.0 );
 
-    getRefAndQueryPointsFromMatching(pointRep1, bestMatching, refPoints, queryPoints);
-
     return bestScore;
 }
 
@@ -138,18 +153,12 @@ ExactPointMatchingAlgorithm::computeMaxCardinalityMatching(
     std::vector<int> & refPoints,
     std::vector<int> & queryPoints)
 {
-    bool validMatchingFound = false;
-    std::vector<McDijkstraEdge *> maxCardMatching;
-    do {
-        validMatchingFound = findMatching(maxCardMatching);
-    } while ( validMatchingFound );
-
-    const double maxCardMatchingScore =
-        getScoreOfMatching(pointRep1, pointRep2, maxCardMatching);
+    while ( m_bipartiteMatching.augment() ) {
+    }
 
-    getRefAndQueryPointsFromMatching(pointRep1, maxCardMatching, refPoints, queryPoints);
+    m_bipartiteMatching.getMatching(refPoints, queryPoints);
 
-    return maxCardMatchingScore;
+    return getScoreOfMatching(pointRep1, pointRep2, refPoints, queryPoints);
 }
 
 double
@@ -167,15 +176,11 @@ ExactPointMatchingAlgorithm::getEdgeWeight(const PointRepresentation * pointRep1
 double
 ExactPointMatchingAlgorithm::getScoreOfMatching(const PointRepresentation * pointRep1,
 						const PointRepresentation * pointRep2,
-					        std::vector<McDijkstraEdge *> matching)
+					        const std::vector<int>    & refPoints,
+					        const std::vector<int>    & queryPoints)
 {
-    std::vector<int> refPoints;
-    std::vector<int> queryPoints;
-
-    getRefAndQueryPointsFromMatching(pointRep1, matching, refPoints, queryPoints);
-
-    std::vector<double> squaredWeights(matching.size());
-    for ( size_t i=0; i<matching.size(); ++i )
+    std::vector<double> squaredWeights(refPoints.size());
+    for ( size_t i=0; i<refPoints.size(); ++i )
     {
         squaredWeights[i] =
             getEdgeWeight(pointRep1, refPoints[i], pointRep2, queryPoints[i]);
@@ -184,31 +189,6 @@ ExactPointMatchingAlgorithm::getScoreOfMatching(const PointRepresentation * poin
     return scoringFunction->computeScore(squaredWeights);
 }
 
-void
-ExactPointMatchingAlgorithm::getRefAndQueryPointsFromMatching(const PointRepresentation * pointRep1,
-							      std::vector<McDijkstraEdge *> matching,
-							      std::vector<int> & refPoints,
-							      std::vector<int> & queryPoints)
-{
-    const int numPoints1 = pointRep1->getNumPoints();
-
-    refPoints.resize(matching.size());
-    queryPoints.resize(matching.size());
-    for ( size_t i=0; i<matching.size(); ++i )
-    {
-        if ( matching[i]->endVertex < matching[i]->startVertex )
-	{
-            refPoints[i]   = matching[i]->endVertex;
-            queryPoints[i] = matching[i]->startVertex-numPoints1;
-        }
-	else
-	{
-            refPoints[i]   = matching[i]->startVertex;
-            queryPoints[i] = matching[i]->endVertex-numPoints1;
-        }
-    }
-}
-
 void
 ExactPointMatchingAlgorithm::createBipartiteGraph(const PointRepresentation * pointRep1,
 						  const PointRepresentation * pointRep2)
@@ -216,146 +196,21 @@ ExactPointMatchingAlgorithm::createBipartiteGraph(const PointRepresentation * po
     int numPoints1 = pointRep1->getNumPoints();
     int numPoints2 = pointRep2->getNumPoints();
 
-    m_startVertex = numPoints1 + numPoints2;
-    m_terminalVertex = m_startVertex + 1;
+    m_bipartiteMatching.init(numPoints1, numPoints2);
 
-    m_edges.clear();
-    m_edges.resize(numPoints1*numPoints2 + numPoints1 + numPoints2);
-
-    // create edges between points
-    int cv=0;
-    int ce=0;
-    for ( int i=0; i<numPoints1; ++i, ++cv )
+    // create edges between points that can be matched
+    for ( int i=0; i<numPoints1; ++i )
     {
-        int endVertex = numPoints1;
-        for ( int j=0; j<numPoints2; ++j, ++endVertex )
+        for ( int j=0; j<numPoints2; ++j )
         {
             double squaredEdgeWeight = 0.0;
             if ( !pointRep1->canPointsBeMatched(i, pointRep2, j, m_cacheObject, squaredEdgeWeight) )
                 continue;
 
-            m_edges[ce].startVertex = cv;
-            m_edges[ce].endVertex   = endVertex;
             if ( m_useUserDefinedEdgeWeights )
-                m_edges[ce].edgeLength = m_userDefinedEdgeWeights[i][j];
+                m_bipartiteMatching.addEdge(i, j, m_userDefinedEdgeWeights[i][j]);
             else
-                m_edges[ce].edgeLength = squaredEdgeWeight;
-
-            ++ce;
+                m_bipartiteMatching.addEdge(i, j, squaredEdgeWeight);
         }
     }
-
-    // all points plus vertices s and t
-    m_vertices.clear();
-    m_vertices.resize(numPoints1 + numPoints2 + 2);
-
-    // edges from starting vertex s to vertices of first point set
-    for ( int i=0; i<numPoints1; ++i, ++ce )
-    {
-        m_edges[ce].startVertex  = m_startVertex;
-        m_edges[ce].endVertex    = i;
-        m_edges[ce].edgeLength   = 0.0;
-    }
-        
-    // edges from vertices of second point set to end vertex t
-    cv = numPoints1;
-    for ( int i=0; i<numPoints2; ++i, ++cv, ++ce )
-    {
-        m_edges[ce].startVertex  = cv;
-        m_edges[ce].endVertex    = m_terminalVertex;
-        m_edges[ce].edgeLength   = 0.0;
-    }
-
-    m_edges.resize(ce);
-
-    for ( size_t i=0; i<m_edges.size(); ++i )
-    {
-        m_vertices[m_edges[i].startVertex].edges.append(&m_edges[i]);
-    }
-}
-
-bool 
-ExactPointMatchingAlgorithm::findMatching(std::vector<McDijkstraEdge *> & matching)
-{
-    McDijkstraShortestPath::computeOneToAll(m_vertices, m_edges, m_startVertex);
-
-    // current edge to be looked at
-    McDijkstraEdge * currEdge;
-
-    // modify edge weights
-    for ( size_t i=0; i<m_vertices.size(); ++i ) {
-        
-        currEdge = m_vertices[i].edges.first();
-        while ( currEdge ) {
-            currEdge->edgeLength += 
-                ( m_vertices[i].distance - 
-                  m_vertices[currEdge->endVertex].distance );
-            
-            if ( currEdge->edgeLength < 0.0 ) {
-                if ( std::abs(currEdge->edgeLength) > 0.000001 ) {
-                    // edgeLength is too negative
-                    printf("Error in ExactPointMatchingAlgorithm::findMatching: "
-                           "negative edge length = %f\n", 
-                           currEdge->edgeLength);
-                }
-                currEdge->edgeLength = 0.0;
-            }
-
-            currEdge = m_vertices[i].edges.succ(currEdge);
-        }
-    }
-    
-    if ( !McDijkstraShortestPath::computeOneToOne(m_vertices, m_edges, m_startVertex, m_terminalVertex) ) {
-        return false;
-    }
-
-    std::vector<McDijkstraEdge *> shortestPathEdges;
-    
-    McDijkstraEdge * predEdge = m_vertices[m_terminalVertex].predEdge;
-    shortestPathEdges.push_back(predEdge);
-    while ( predEdge->startVertex != m_startVertex ) {
-        predEdge = m_vertices[predEdge->startVertex].predEdge;
-        shortestPathEdges.push_back(predEdge);
-    }
-
-    // remove first edge of minimal s-t-path
-    int last = shortestPathEdges.size()-1;
-    m_vertices[shortestPathEdges[last]->startVertex].
-        edges.remove(shortestPathEdges[last]);
-    
-    // remove last edge of minimal s-t-path
-    m_vertices[shortestPathEdges[0]->startVertex].
-        edges.remove(shortestPathEdges[0]);
-    
-    // invert all other edges 
-    int startVertex, endVertex;
-    for ( int i=1; i<last; ++i ) {
-        startVertex = shortestPathEdges[i]->startVertex;
-        endVertex   = shortestPathEdges[i]->endVertex;
-        
-        m_vertices[startVertex].edges.remove(shortestPathEdges[i]);
-        m_vertices[endVertex].edges.append(shortestPathEdges[i]);
-        
-        // invert edge
-        shortestPathEdges[i]->startVertex = endVertex;
-        shortestPathEdges[i]->endVertex   = startVertex;
-    }
-    
-    // remove old matching edges first
-    std::vector<McDijkstraEdge *> newMatching;
-    for ( size_t i=0; i<matching.size(); ++i )
-    {
-        if ( matching[i]->startVertex > matching[i]->endVertex )
-            newMatching.push_back(matching[i]);
-    }
-    
-    // append new matching edges
-    for ( int i=1; i<last; i+=2 )
-    {
-        newMatching.push_back(shortestPathEdges[i]);
-    }
-    
-    matching = newMatching;
-
-    return true;
 }
@@ -11,7 +11,7 @@
 
 #include <mclib/McBitfield.h>
 
-#include "hxgraphalgorithms/McDijkstraShortestPath.h"
+#include "hxgraphalgorithms/McMinCostBipartiteMatching.h"
 
 #include "PointMatchingAlgorithm.h"
 #include "PointMatchingScoringFunction.h"
@@ -27,6 +27,8 @@ class POINTMATCHING_API ExactPointMatchingAlgorithm : public PointMatchingAlgori
 public:
     ExactPointMatchingAlgorithm();
 
+    virtual PointMatchingAlgorithm * duplicate() const;
+
     void setUserDefinedEdgeWeights(const std::vector< std::vector<double> > & edgeWeights);
     
     void computePointMatching(const PointRepresentation * pointRep1, 
@@ -40,11 +42,8 @@ public:
                                             PointMatchingDataStruct   * pointMatching);
 
 private:
-    std::vector<McDijkstraVertex>   m_vertices;
-    std::vector<McDijkstraEdge>     m_edges;
-    int                          m_startVertex;
-    int                          m_terminalVertex;
-                                 
+    McMinCostBipartiteMatching   m_bipartiteMatching;
+
     McHandle< CacheObject >      m_cacheObject;
     bool                         m_useUserDefinedEdgeWeights;
     std::vector< std::vector<double> > m_userDefinedEdgeWeights;
@@ -65,19 +64,13 @@ protected:
 
     double getScoreOfMatching(const PointRepresentation * pointRep1,
                               const PointRepresentation * pointRep2,
-                              std::vector<McDijkstraEdge *> matching);
+                              const std::vector<int>    & refPoints,
+                              const std::vector<int>    & queryPoints);
 
     double getEdgeWeight(const PointRepresentation * pointRep1,
                          const int                   pointRep1PointIdx,
                          const PointRepresentation * pointRep2,
                          const int                   pointRep2PointIdx);
-
-    void getRefAndQueryPointsFromMatching(const PointRepresentation * pointRep1,
-					  std::vector<McDijkstraEdge *> matching,
-					  std::vector<int> & refPoints,
-                                          std::vector<int> & queryPoints);
-
-    bool findMatching(std::vector<McDijkstraEdge *> & matching);
 };
 
 #endif
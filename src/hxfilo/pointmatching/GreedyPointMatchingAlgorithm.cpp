@@ -14,12 +14,24 @@
 #include "GreedyPointMatchingAlgorithm.h"
 #include "CacheObject.h"
 
+#include <atomic>
+#include <thread>
+
 #define SCORE_EPS 0.01
 
 GreedyPointMatchingAlgorithm::GreedyPointMatchingAlgorithm() :
     PointMatchingAlgorithm()
 {
-   
+    mIncremental = false;
+}
+
+PointMatchingAlgorithm *
+GreedyPointMatchingAlgorithm::duplicate() const
+{
+    GreedyPointMatchingAlgorithm * algorithm = new GreedyPointMatchingAlgorithm();
+    duplicateSettings(algorithm);
+
+    return algorithm;
 }
 
 void 
@@ -37,9 +49,16 @@ GreedyPointMatchingAlgorithm::computePointMatching(
     pointRep1->setScoreDivisor(pointRep2, scoringFunction);
     
     // pointRep1 is the reference point representation
-    McHandle<CacheObject> cacheObject = 
-        pointRep1->startGreedyPointMatching(pointRep2, 
-                                            pointRep2StartTransform);
+    McHandle<CacheObject> cacheObject;
+    if ( mIncremental ) {
+        cacheObject = pointRep1->continueGreedyPointMatching(pointRep2, 
+                                                             pointRep2StartTransform,
+                                                             mPreviousCacheObject);
+        mPreviousCacheObject = 0;
+    } else {
+        cacheObject = pointRep1->startGreedyPointMatching(pointRep2, 
+                                                          pointRep2StartTransform);
+    }
     
     int    refPointIx;
     int    queryPointIx;
@@ -49,8 +68,10 @@ GreedyPointMatchingAlgorithm::computePointMatching(
     double score;
     double bestMatchingScore = 0.0f;
     
-    std::vector<int>   refPoints;
-    std::vector<int>   queryPoints;
+    std::vector<int> & refPoints = mRefPoints;
+    std::vector<int> & queryPoints = mQueryPoints;
+    refPoints.clear();
+    queryPoints.clear();
 
     while ( pointRep1->getNextMatchingPair(cacheObject, refPointIx, queryPointIx, dist2)) 
     {
@@ -79,9 +100,80 @@ GreedyPointMatchingAlgorithm::computePointMatching(
     pointMatching->setQueryPoints(queryPoints);
     pointMatching->setScore(bestMatchingScore);
     
+    // keep cache object for the next call
+    if ( mIncremental )
+        mPreviousCacheObject = cacheObject;
+
     // clear temporary data structures
     pointRep1->finishGreedyPointMatching();
 
     // clean up scoring function 
     scoringFunction->finishEditing();
 }
+
+void
+GreedyPointMatchingAlgorithm::startIncrementalMatching()
+{
+    mIncremental = true;
+    mPreviousCacheObject = 0;
+}
+
+void
+GreedyPointMatchingAlgorithm::finishIncrementalMatching()
+{
+    mIncremental = false;
+    mPreviousCacheObject = 0;
+}
+
+void
+GreedyPointMatchingAlgorithm::computeConsecutivePointMatchings(
+            const std::vector<const PointRepresentation *>   & pointReps,
+            const Transformation                             * pointRep2Transform,
+            std::vector< McHandle<PointMatchingDataStruct> > & pointMatchings,
+            int                                                numThreads) const
+{
+    const int numPairs = ( pointReps.size() > 1 ) ? pointReps.size() - 1 : 0;
+
+    pointMatchings.resize(numPairs);
+    for ( int t=0; t<numPairs; ++t )
+        pointMatchings[t] = new PointMatchingDataStruct();
+
+    if ( numPairs == 0 )
+        return;
+
+    if ( numThreads <= 0 )
+        numThreads = std::thread::hardware_concurrency();
+    if ( numThreads <= 0 )
+        numThreads = 1;
+    if ( numThreads > numPairs )
+        numThreads = numPairs;
+
+    // each thread uses its own algorithm with its own scoring function
+    // and buffers
+    std::vector<PointMatchingAlgorithm *> algorithms(numThreads);
+    for ( int i=0; i<numThreads; ++i )
+        algorithms[i] = duplicate();
+
+    std::atomic<int> nextPair(0);
+
+    auto computePointMatchings = [&](PointMatchingAlgorithm * algorithm)
+    {
+        int t;
+        while ( (t = nextPair++) < numPairs ) {
+            algorithm->computePointMatching(pointReps[t],
+                                            pointReps[t + 1],
+                                            pointRep2Transform,
+                                            pointMatchings[t]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ( int i=1; i<numThreads; ++i )
+        threads.push_back(std::thread(computePointMatchings, algorithms[i]));
+    computePointMatchings(algorithms[0]);
+    for ( size_t i=0; i<threads.size(); ++i )
+        threads[i].join();
+
+    for ( int i=0; i<numThreads; ++i )
+        delete algorithms[i];
+}
@@ -9,10 +9,15 @@
 #ifndef GREEDY_POINT_MATCHING_ALGORITHM_H
 #define GREEDY_POINT_MATCHING_ALGORITHM_H
 
+#include <mclib/McHandle.h>
+
+#include "CacheObject.h"
 #include "PointMatchingAlgorithm.h"
 #include "PointMatchingScoringFunction.h"
 #include "api.h"
 
+#include <vector>
+
 class Transformation;
 class PointMatchingDataStruct;
 class PointRepresentation;
@@ -22,11 +27,38 @@ class POINTMATCHING_API GreedyPointMatchingAlgorithm : public PointMatchingAlgor
 public:
     GreedyPointMatchingAlgorithm();
 
+    virtual PointMatchingAlgorithm * duplicate() const;
+
     virtual void computePointMatching(const PointRepresentation * pointRep1, 
                                       const PointRepresentation * pointRep2,
                                       const Transformation      * pointRep2Transform,
                                       PointMatchingDataStruct   * pointMatching);
 
+    virtual void startIncrementalMatching();
+    virtual void finishIncrementalMatching();
+
+    /** Computes the point matchings of all consecutive point
+        representations, e.g. of the frames of a movie:
+        @c pointMatchings[t] is the matching of @c pointReps[t] and
+        @c pointReps[t+1] with the transformation @c pointRep2Transform
+        of the second point set. The matchings are computed by
+        @c numThreads threads (all available cores if @c numThreads
+        <= 0), each with its own duplicate of this algorithm. The result
+        is the same as when calling computePointMatching for each pair
+        of point representations. */
+    void computeConsecutivePointMatchings(
+                const std::vector<const PointRepresentation *>   & pointReps,
+                const Transformation                             * pointRep2Transform,
+                std::vector< McHandle<PointMatchingDataStruct> > & pointMatchings,
+                int                                                numThreads = 0) const;
+
+private:
+    bool                  mIncremental;
+    McHandle<CacheObject> mPreviousCacheObject;
+
+    // Buffers for the matching pairs, reused between calls
+    std::vector<int>      mRefPoints;
+    std::vector<int>      mQueryPoints;
 };
 
 #endif
@@ -1,5 +1,9 @@
 #include "Test_GreedyPointMatching.h"
 #include "Test_ExactPointMatching.h"
+#include "Test_CliqueDetection.h"
+#include "Test_KruskalTreeClusterer.h"
+#include "Test_MinCostBipartiteMatching.h"
+#include "Test_CsrDijkstraShortestPath.h"
 #include "HxTest_PointMatching.h"
 
 HX_INIT_CLASS(HxTest_PointMatching, HxCompModule);
@@ -33,5 +37,18 @@ void HxTest_PointMatching::compute()
 
         Test_GreedyPointMatching::test5();
         Test_ExactPointMatching::test5();
+
+        Test_GreedyPointMatching::testIncremental();
+        Test_GreedyPointMatching::testConsecutive();
+        Test_GreedyPointMatching::testBestPointMatching();
+
+        Test_CliqueDetection::test1();
+        Test_CliqueDetection::benchmark();
+
+        Test_KruskalTreeClusterer::test1();
+
+        Test_MinCostBipartiteMatching::test1();
+
+        Test_CsrDijkstraShortestPath::test1();
     }
 }
@@ -14,11 +14,21 @@
 #include "Transformation.h"
 #include "IterativePointMatching.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #define SCORE_EPS 1e-4
 
 IterativePointMatching::IterativePointMatching()
 {
-    // empty
+    mIncremental = false;
+}
+
+void
+IterativePointMatching::setIncremental(const bool incremental)
+{
+    mIncremental = incremental;
 }
 
 bool
@@ -50,6 +60,8 @@ IterativePointMatching::computePointMatching(PointMatchingAlgorithm  * pointMatc
         pointMatching->duplicate();
     *pointRep2Transform = *pointRep2StartTransform;
 
+    if ( mIncremental )
+        pointMatchingAlgorithm->startIncrementalMatching();
 
     do {
         pointMatchingAlgorithm->computePointMatching(pointRep1, 
@@ -64,6 +76,9 @@ IterativePointMatching::computePointMatching(PointMatchingAlgorithm  * pointMatc
                                                           pointMatching,
                                                           pointRep2Transform) );
 
+    if ( mIncremental )
+        pointMatchingAlgorithm->finishIncrementalMatching();
+
     return ( pointMatching->getScore() > 0.0f );
 }
 
@@ -85,3 +100,104 @@ IterativePointMatching::computePointMatching(PointMatchingAlgorithm  * pointMatc
                                 numIterations);
 }
 
+
+int
+IterativePointMatching::computeBestPointMatching(const PointMatchingAlgorithm      * pointMatchingAlgorithm,
+                                                 PointRepresentation               * pointRep1, 
+                                                 PointRepresentation               * pointRep2,
+                                                 const std::vector<Transformation> & pointRep2StartTransforms,
+                                                 PointMatchingDataStruct           * pointMatching,
+                                                 Transformation                    * pointRep2Transform,
+                                                 int                                 numThreads)
+{
+    if (    !pointMatchingAlgorithm 
+         || !pointRep1 
+         || !pointRep2 
+         || !pointMatching 
+         || !pointRep2Transform ) 
+        return -1;
+
+    pointMatching->reset();
+
+    const int numStartTransforms = pointRep2StartTransforms.size();
+    if ( numStartTransforms == 0 )
+        return -1;
+
+    if ( numThreads <= 0 )
+        numThreads = std::thread::hardware_concurrency();
+    if ( numThreads <= 0 )
+        numThreads = 1;
+    if ( numThreads > numStartTransforms )
+        numThreads = numStartTransforms;
+
+    // each thread uses its own algorithm, cache objects and scoring function
+    std::vector<PointMatchingAlgorithm *> algorithms(numThreads);
+    for ( int t=0; t<numThreads; ++t )
+        algorithms[t] = pointMatchingAlgorithm->duplicate();
+
+    const double maxScore = algorithms[0]->getMaxScore(pointRep1, pointRep2);
+
+    // results per start transformation
+    std::vector< McHandle<PointMatchingDataStruct> > matchings(numStartTransforms);
+    std::vector<Transformation> transforms(numStartTransforms);
+    std::vector<char> isValid(numStartTransforms, 0);
+
+    std::atomic<int> nextStartTransform(0);
+
+    // smallest index of a start transformation reaching maxScore
+    std::atomic<int> maxScoreStartTransform(numStartTransforms);
+
+    auto evaluateStartTransforms = [&](PointMatchingAlgorithm * algorithm)
+    {
+        IterativePointMatching iterativePointMatching;
+        iterativePointMatching.setIncremental(mIncremental);
+
+        int i;
+        while ( (i = nextStartTransform++) < numStartTransforms ) {
+            // an earlier start transformation cannot be beaten
+            if ( i > maxScoreStartTransform )
+                continue;
+
+            matchings[i] = pointMatching->duplicate();
+            isValid[i] = iterativePointMatching.computePointMatching(algorithm,
+                                                                     pointRep1,
+                                                                     pointRep2,
+                                                                     &pointRep2StartTransforms[i],
+                                                                     matchings[i],
+                                                                     &transforms[i]);
+
+            if ( isValid[i] && matchings[i]->getScore() >= maxScore ) {
+                int current = maxScoreStartTransform;
+                while ( i < current && !maxScoreStartTransform.compare_exchange_weak(current, i) ) {
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for ( int t=1; t<numThreads; ++t )
+        threads.push_back(std::thread(evaluateStartTransforms, algorithms[t]));
+    evaluateStartTransforms(algorithms[0]);
+    for ( size_t t=0; t<threads.size(); ++t )
+        threads[t].join();
+
+    for ( int t=0; t<numThreads; ++t )
+        delete algorithms[t];
+
+    // keep the first best point matching, as in a sequential loop
+    int bestStartTransform = -1;
+    double bestScore = 0.0;
+    for ( int i=0; i<numStartTransforms; ++i ) {
+        if ( isValid[i] && matchings[i]->getScore() > bestScore ) {
+            bestScore = matchings[i]->getScore();
+            bestStartTransform = i;
+        }
+    }
+
+    if ( bestStartTransform >= 0 ) {
+        *pointMatching = *matchings[bestStartTransform];
+        *pointRep2Transform = transforms[bestStartTransform];
+    }
+
+    return bestStartTransform;
+}
@@ -11,6 +11,8 @@
 
 #include "api.h"
 
+#include <vector>
+
 class Transformation;
 class PointMatchingDataStruct;
 class PointRepresentation;
@@ -20,6 +22,13 @@ class POINTMATCHING_API IterativePointMatching {
 
 public:
     IterativePointMatching();
+
+    /** In incremental mode, the point matching algorithm may reuse
+        data of the previous iteration, e.g. the candidate pairs of the
+        greedy point matching, as long as the transformation changes
+        only slightly. The resulting point matching is the same. The
+        default is false. */
+    void setIncremental(const bool incremental);
     
     bool computePointMatching(PointMatchingAlgorithm  * pointMatchingAlgorithm,
                               PointRepresentation     * pointRep1, 
@@ -36,6 +45,29 @@ public:
                               PointMatchingDataStruct * pointMatching,
                               Transformation          * pointRep2Transform,
                               int&                      numIterations);
+
+    /** Calls computePointMatching for each start transformation and
+        keeps the point matching with the highest score. If several
+        point matchings have the same score, the one of the first start
+        transformation is kept, i.e. the result is the same as when
+        processing the start transformations one after another.
+
+        The start transformations are evaluated by @c numThreads
+        threads (all available cores if @c numThreads <= 0). Each
+        thread uses its own duplicate of @c pointMatchingAlgorithm, so
+        cache objects and scoring functions are not shared. Once a start
+        transformation reaches the maximum possible score, all later
+        start transformations are skipped, since they cannot beat it.
+
+        Returns the index of the best start transformation, or -1 if no
+        point matching with a positive score was found. */
+    int computeBestPointMatching(const PointMatchingAlgorithm        * pointMatchingAlgorithm,
+                                 PointRepresentation                 * pointRep1, 
+                                 PointRepresentation                 * pointRep2,
+                                 const std::vector<Transformation>   & pointRep2StartTransforms,
+                                 PointMatchingDataStruct             * pointMatching,
+                                 Transformation                      * pointRep2Transform,
+                                 int                                   numThreads = 0);
     
 protected:
     bool acceptPointMatching(const PointRepresentation     * pointRep1, 
@@ -44,7 +76,7 @@ protected:
                              PointMatchingDataStruct       * pointMatching);
 
 protected:
-
+    bool mIncremental;
 };
 
 #endif
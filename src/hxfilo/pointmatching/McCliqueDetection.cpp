@@ -6,8 +6,12 @@
 //
 ////////////////////////////////////////////////////////////////////////////
 
+#include <mclib/McPrimType.h>
+
 #include "McCliqueDetection.h"
 
+#include <algorithm>
+
 void 
 McCliqueDetection::computeCliquesBasic(
             std::vector<int>        & clique, 
@@ -178,3 +182,320 @@ McCliqueDetection::computeCliquesBronKerbosch(
     return true;
 }
 
+
+namespace {
+
+typedef mcuint64 CliqueWord;
+
+const int numBitsPerWord = 64;
+
+inline int
+countBits(CliqueWord word)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return int((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Candidate set of one recursion level: the bits of the candidates and
+// the range of words containing them.
+struct CandidateSet {
+    std::vector<CliqueWord> words;
+    int                     beginWord;
+    int                     endWord;
+    int                     size;
+};
+
+class BronKerboschBitset {
+public:
+    BronKerboschBitset(const std::vector<std::vector<int> > & adjacency,
+                       int                                  & nCliques,
+                       std::vector<std::vector<int> >       & cliques,
+                       const int                              minCliqueSize,
+                       const int                              maxNumCliques)
+        : mNumVertices(adjacency.size())
+        , mNumWords((mNumVertices + numBitsPerWord - 1) / numBitsPerWord)
+        , mNCliques(nCliques)
+        , mCliques(cliques)
+        , mMinCliqueSize(minCliqueSize)
+        , mMaxNumCliques(maxNumCliques)
+    {
+        // each vertex is connected to itself, as in computeCliquesBronKerbosch
+        mConnected.assign(size_t(mNumVertices) * mNumWords, 0);
+        for ( int i=0; i<mNumVertices; i++ ) {
+            setBit(getRow(i), i);
+            for ( size_t j=0; j<adjacency[i].size(); j++ ) {
+                setBit(getRow(i), adjacency[i][j]);
+            }
+        }
+
+        // one set of temporary lists per recursion depth
+        mLevelNotAndCand.resize(mNumVertices + 1);
+        mLevelCand.resize(mNumVertices + 1);
+    }
+
+    bool run()
+    {
+        std::vector<int> & notAndCand = mLevelNotAndCand[0];
+        CandidateSet & cand = mLevelCand[0];
+
+        notAndCand.resize(mNumVertices);
+        cand.words.assign(mNumWords, 0);
+        for ( int i=0; i<mNumVertices; i++ ) {
+            notAndCand[i] = i;
+            setBit(&cand.words[0], i);
+        }
+        cand.beginWord = 0;
+        cand.endWord = mNumWords;
+        cand.size = mNumVertices;
+
+        return computeCliques(notAndCand, 0, mNumVertices, cand);
+    }
+
+private:
+    static void setBit(CliqueWord * words, const int bit)
+    {
+        words[bit / numBitsPerWord] |= CliqueWord(1) << (bit % numBitsPerWord);
+    }
+
+    static void unsetBit(CliqueWord * words, const int bit)
+    {
+        words[bit / numBitsPerWord] &= ~(CliqueWord(1) << (bit % numBitsPerWord));
+    }
+
+    static bool isBitSet(const CliqueWord * words, const int bit)
+    {
+        return (words[bit / numBitsPerWord] >> (bit % numBitsPerWord)) & 1;
+    }
+
+    CliqueWord * getRow(const int vertex)
+    {
+        return &mConnected[size_t(vertex) * mNumWords];
+    }
+
+    const CliqueWord * getRow(const int vertex) const
+    {
+        return &mConnected[size_t(vertex) * mNumWords];
+    }
+
+    bool isConnected(const int vertex1, const int vertex2) const
+    {
+        return isBitSet(getRow(vertex1), vertex2);
+    }
+
+    // Number of candidates connected to the vertex. The candidate words
+    // are ANDed with the adjacency row if the candidates are dense enough,
+    // otherwise the candidates are tested one by one.
+    int countConnected(const int                vertex,
+                       const std::vector<int> & notAndCand,
+                       const int                endNot,
+                       const int                endCand,
+                       const CandidateSet     & cand) const
+    {
+        const CliqueWord * row = getRow(vertex);
+        int count = 0;
+        if ( cand.endWord - cand.beginWord <= cand.size ) {
+            for ( int w=cand.beginWord; w<cand.endWord; w++ ) {
+                count += countBits(row[w] & cand.words[w]);
+            }
+        }
+        else {
+            for ( int j=endNot; j<endCand; j++ ) {
+                count += isBitSet(row, notAndCand[j]);
+            }
+        }
+        return count;
+    }
+
+    // Greedy colouring of the candidates, each colour class is an
+    // independent set. Returns true if at least minNumColors colours
+    // are needed, i.e. if a clique of this size may exist.
+    bool mayContainClique(const std::vector<int> & notAndCand,
+                          const int                endNot,
+                          const int                endCand,
+                          const int                minNumColors)
+    {
+        if ( minNumColors <= 1 )
+            return true;
+
+        mColorClassOfVertex.resize(endCand - endNot);
+        mColorClassBegin.clear();
+
+        int numColors = 0;
+        for ( int i=endNot; i<endCand; i++ ) {
+            const CliqueWord * row = getRow(notAndCand[i]);
+
+            // first colour class without a neighbor of the vertex
+            int color = 0;
+            for ( ; color<numColors; color++ ) {
+                bool hasNeighbor = false;
+                for ( int j=mColorClassBegin[color]; j>=0 && !hasNeighbor; j=mColorClassOfVertex[j] ) {
+                    hasNeighbor = isBitSet(row, notAndCand[endNot + j]);
+                }
+                if ( !hasNeighbor )
+                    break;
+            }
+
+            if ( color == numColors ) {
+                numColors++;
+                if ( numColors >= minNumColors )
+                    return true;
+                mColorClassBegin.push_back(-1);
+            }
+
+            // prepend vertex to linked list of its colour class
+            mColorClassOfVertex[i - endNot] = mColorClassBegin[color];
+            mColorClassBegin[color] = i - endNot;
+        }
+
+        return false;
+    }
+
+    bool computeCliques(std::vector<int> & notAndCand,
+                        int                endNot,
+                        int                endCand,
+                        CandidateSet     & cand)
+    {
+        if ( mMaxNumCliques > -1 && mNCliques >= mMaxNumCliques ) {
+            return false;
+        }
+
+        // Choose the vertex with the fewest disconnections to the
+        // candidates as fixed point, as in computeCliquesBronKerbosch.
+        int i, count, fixp = -1, s = -1;
+        int minNod = endCand;
+        int nod = 0;
+
+        for ( i=0; i<endCand && minNod!=0; i++ ) {
+            count = cand.size - countConnected(notAndCand[i], notAndCand, endNot, endCand, cand);
+            if ( count < minNod ) {
+                fixp = notAndCand[i];
+                minNod = count;
+                s = i;
+                nod = ( i<endNot ) ? 0 : 1;
+            }
+        }
+
+        if ( fixp >= 0 && s < endNot ) {
+            // start with the last candidate not connected to the fixed point
+            for ( int j=endNot; j<endCand; j++ ) {
+                if ( !isConnected(fixp, notAndCand[j]) )
+                    s = j;
+            }
+        }
+
+        const int depth = mClique.size() + 1;
+        std::vector<int> & notAndCand2 = mLevelNotAndCand[depth];
+        CandidateSet & cand2 = mLevelCand[depth];
+        if ( cand2.words.empty() )
+            cand2.words.assign(mNumWords, 0);
+
+        for ( nod=minNod+nod; nod>0; nod-- ) {
+            const int p = notAndCand[s];
+            notAndCand[s] = notAndCand[endNot];
+            const int sel = notAndCand[endNot] = p;
+            const CliqueWord * row = getRow(sel);
+
+            unsetBit(&cand.words[0], sel);
+            cand.size--;
+
+            notAndCand2.resize(endCand);
+            int endNot2 = 0;
+            for ( i=0; i<endNot; i++ ) {
+                if ( isBitSet(row, notAndCand[i]) ) {
+                    notAndCand2[endNot2] = notAndCand[i];
+                    endNot2++;
+                }
+            }
+            int endCand2 = endNot2;
+            cand2.beginWord = mNumWords;
+            cand2.endWord = 0;
+            for ( i=endNot+1; i<endCand; i++ ) {
+                const int v = notAndCand[i];
+                if ( isBitSet(row, v) ) {
+                    notAndCand2[endCand2] = v;
+                    endCand2++;
+
+                    setBit(&cand2.words[0], v);
+                    cand2.beginWord = std::min(cand2.beginWord, v / numBitsPerWord);
+                    cand2.endWord = std::max(cand2.endWord, v / numBitsPerWord + 1);
+                }
+            }
+            cand2.size = endCand2 - endNot2;
+            notAndCand2.resize(endCand2);
+            mClique.push_back(sel);
+
+            bool stop = false;
+            if ( endCand2 == 0 ) {
+                if ( static_cast<int>(mClique.size()) >= mMinCliqueSize ) {
+                    mNCliques++;
+                    mCliques.push_back(mClique);
+                }
+            } else if ( endNot2 < endCand2 ) {
+                if ( static_cast<int>(mClique.size())+(endCand2-endNot2) >= mMinCliqueSize ) {
+                    if ( mMaxNumCliques > -1 && mNCliques >= mMaxNumCliques ) {
+                        // the recursion would stop immediately
+                        stop = true;
+                    } else if ( mayContainClique(notAndCand2, endNot2, endCand2,
+                                                 mMinCliqueSize - static_cast<int>(mClique.size())) ) {
+                        stop = !computeCliques(notAndCand2, endNot2, endCand2, cand2);
+                    }
+                }
+            }
+
+            // clear candidate bits of the next level
+            for ( i=0; i<endCand2; i++ ) {
+                cand2.words[notAndCand2[i] / numBitsPerWord] = 0;
+            }
+
+            if ( stop )
+                return false;
+
+            mClique.pop_back();
+            endNot++;
+
+            if ( nod>1 ) {
+                s = endNot;
+                while ( isConnected(fixp, notAndCand[s]) ) {
+                    s++;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    const int                        mNumVertices;
+    const int                        mNumWords;
+    std::vector<CliqueWord>          mConnected;
+    int                            & mNCliques;
+    std::vector<std::vector<int> > & mCliques;
+    const int                        mMinCliqueSize;
+    const int                        mMaxNumCliques;
+    std::vector<int>                 mClique;
+    std::vector<std::vector<int> >   mLevelNotAndCand;
+    std::vector<CandidateSet>        mLevelCand;
+    std::vector<int>                 mColorClassBegin;
+    std::vector<int>                 mColorClassOfVertex;
+};
+
+}
+
+bool
+McCliqueDetection::computeCliquesBronKerboschBitset(
+            const std::vector<std::vector<int> > & adjacency,
+            int                                  & nCliques,
+            std::vector<std::vector<int> >       & cliques,
+            int                                    minCliqueSize,
+            int                                    maxNumCliques)
+{
+    BronKerboschBitset bronKerbosch(adjacency, nCliques, cliques,
+                                    minCliqueSize, maxNumCliques);
+
+    return bronKerbosch.run();
+}
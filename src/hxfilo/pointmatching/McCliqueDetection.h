@@ -43,6 +43,20 @@ public:
                     std::vector<std::vector<int> > & cliques, 
                     int                        minCliqueSize=1,
                     int                        maxNumCliques=-1);
+
+    /** Same as computeCliquesBronKerbosch with all vertices as initial
+        candidates. The graph is given by adjacency lists, which are
+        converted to word-packed adjacency rows, so that candidate sets
+        are intersected and counted word by word. Branches that cannot
+        reach minCliqueSize by a greedy colouring bound are skipped.
+        The cliques are reported in the same order as by
+        computeCliquesBronKerbosch. */
+    static bool computeCliquesBronKerboschBitset(
+                    const std::vector<std::vector<int> > & adjacency,
+                    int                                  & nCliques,
+                    std::vector<std::vector<int> >       & cliques,
+                    int                                    minCliqueSize=1,
+                    int                                    maxNumCliques=-1);
 };
 
 #endif
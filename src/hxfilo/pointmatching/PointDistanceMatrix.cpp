@@ -0,0 +1,52 @@
+/////////////////////////////////////////////////////////////////
+//
+// PointDistanceMatrix.cpp
+//
+// Main Authors: Baum
+//
+/////////////////////////////////////////////////////////////////
+
+#include "PointDistanceMatrix.h"
+
+// 10000 points need 200 MB
+const int PointDistanceMatrix::maxNumPointsForStoredDistances = 10000;
+
+PointDistanceMatrix::PointDistanceMatrix()
+{
+    mHasStoredDistances = true;
+    mMaximumDistance = 0.0f;
+}
+
+void
+PointDistanceMatrix::setCoords(const std::vector<McVec3f> & coords)
+{
+    mCoords = coords;
+    mDistances.clear();
+
+    const int numPoints = mCoords.size();
+
+    mHasStoredDistances = ( numPoints <= maxNumPointsForStoredDistances );
+    if ( mHasStoredDistances )
+        mDistances.resize(size_t(numPoints) * size_t(numPoints - 1) / 2);
+
+    mMaximumDistance = 0.0f;
+    for ( int i=0; i<numPoints; i++ ) {
+        const McVec3f & p = mCoords[i];
+        if ( mHasStoredDistances ) {
+            float * row = mDistances.data() + getRowOffset(i);
+            for ( int j=i+1; j<numPoints; j++ )
+                row[j - i - 1] = (p - mCoords[j]).length();
+            for ( int j=i+1; j<numPoints; j++ ) {
+                if ( row[j - i - 1] > mMaximumDistance )
+                    mMaximumDistance = row[j - i - 1];
+            }
+        }
+        else {
+            for ( int j=i+1; j<numPoints; j++ ) {
+                const float dist = (p - mCoords[j]).length();
+                if ( dist > mMaximumDistance )
+                    mMaximumDistance = dist;
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////
+//
+// PointDistanceMatrix.h
+//
+// Main Authors: Baum
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef POINT_DISTANCE_MATRIX_H
+#define POINT_DISTANCE_MATRIX_H
+
+#include <mclib/McVec3.h>
+
+#include "api.h"
+
+#include <vector>
+
+/**
+    Symmetric matrix of the euclidean distances between all pairs of
+    points of a point set.
+
+    Only the distances (i,j) with i<j are stored, row by row in one
+    contiguous float array, i.e. the distances of point i to the points
+    i+1, ..., n-1 are found at @c getRow(i). Since the distances are
+    computed from float coordinates, storing them as floats does not
+    lose precision.
+
+    For point sets with more than @c maxNumPointsForStoredDistances
+    points, no distances are stored and each distance is computed from
+    the coordinates when it is requested.
+*/
+class POINTMATCHING_API PointDistanceMatrix {
+
+public:
+    PointDistanceMatrix();
+
+    /** Computes the distances between all points in @c coords. The
+        coordinates are copied. */
+    void setCoords(const std::vector<McVec3f> & coords);
+
+    int getNumPoints() const
+    {
+        return mCoords.size();
+    }
+
+    /// Returns true if the distances are stored, false if they are
+    /// computed on demand.
+    bool hasStoredDistances() const
+    {
+        return mHasStoredDistances;
+    }
+
+    /// Maximal distance between two points.
+    float getMaximumDistance() const
+    {
+        return mMaximumDistance;
+    }
+
+    float operator()(const int i, const int j) const
+    {
+        if ( i == j )
+            return 0.0f;
+
+        if ( !mHasStoredDistances )
+            return (mCoords[i] - mCoords[j]).length();
+
+        return ( i < j ) ? getRow(i)[j - i - 1] : getRow(j)[i - j - 1];
+    }
+
+    /** Returns the distances of point @c i to the points i+1, ..., n-1.
+        Only valid if the distances are stored. */
+    const float * getRow(const int i) const
+    {
+        return mDistances.data() + getRowOffset(i);
+    }
+
+    static const int maxNumPointsForStoredDistances;
+
+private:
+    size_t getRowOffset(const int i) const
+    {
+        const size_t n = mCoords.size();
+        return size_t(i) * n - size_t(i) * size_t(i + 1) / 2;
+    }
+
+    std::vector<McVec3f> mCoords;
+    std::vector<float>   mDistances;
+    bool                 mHasStoredDistances;
+    float                mMaximumDistance;
+};
+
+#endif
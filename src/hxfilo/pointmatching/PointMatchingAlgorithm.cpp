@@ -25,6 +25,14 @@ PointMatchingAlgorithm::~PointMatchingAlgorithm()
 {
 }
 
+void
+PointMatchingAlgorithm::duplicateSettings(PointMatchingAlgorithm * algorithm) const
+{
+    algorithm->minPointMatchingSize  = this->minPointMatchingSize;
+    algorithm->minPointMatchingScore = this->minPointMatchingScore;
+    algorithm->scoringFunction       = this->scoringFunction->duplicate();
+}
+
 void  
 PointMatchingAlgorithm::setMinPointMatchingSize(
             const int minPointMatchingSize)
@@ -48,6 +56,30 @@ PointMatchingAlgorithm::setScoringFunction(
     this->scoringFunction = scoringFunction;
 }
 
+void
+PointMatchingAlgorithm::startIncrementalMatching()
+{
+    // empty
+}
+
+void
+PointMatchingAlgorithm::finishIncrementalMatching()
+{
+    // empty
+}
+
+double
+PointMatchingAlgorithm::getMaxScore(const PointRepresentation * pointRep1, 
+                                    const PointRepresentation * pointRep2)
+{
+    pointRep1->setScoreDivisor(pointRep2, scoringFunction);
+
+    const int numPoints1 = pointRep1->getNumPoints();
+    const int numPoints2 = pointRep2->getNumPoints();
+
+    return scoringFunction->computeMaxScore(numPoints1 < numPoints2 ? numPoints1 : numPoints2);
+}
+
 bool
 PointMatchingAlgorithm::acceptPointMatching(
             const PointRepresentation     * pointRep1, 
@@ -26,6 +26,11 @@ public:
 
     /** Destructor */
     virtual ~PointMatchingAlgorithm();
+
+    /** Creates an algorithm of the same type with the same settings
+        and its own scoring function, so that it can be used in another
+        thread. The caller takes ownership. */
+    virtual PointMatchingAlgorithm * duplicate() const = 0;
     
     /** Sets the minimum size, i.e. number of matched pairs, a point
         matching should have.
@@ -76,8 +81,28 @@ public:
                                      const PointMatchingDataStruct * newPointMatching,
                                      PointMatchingDataStruct       * pointMatching,
                                      Transformation                * pointRep2Transform);
+
+    /** Called before and after a series of calls of
+        computePointMatching for the same point sets with slowly
+        changing transformations, as in an iterative point matching.
+        In between, an algorithm may reuse data of the previous call.
+        The default implementation does nothing. */
+    virtual void startIncrementalMatching();
+    virtual void finishIncrementalMatching();
+
+    /** Returns an upper bound of the score of any point matching
+        between the two point sets.
+        \param[in] pointRep1 Representation of point set 1.
+        \param[in] pointRep2 Representation of point set 2.
+     */
+    double getMaxScore(const PointRepresentation * pointRep1, 
+                       const PointRepresentation * pointRep2);
         
 protected:
+    /** Copies the settings of this algorithm to @c algorithm, using a
+        duplicate of the scoring function. */
+    void duplicateSettings(PointMatchingAlgorithm * algorithm) const;
+
     McHandle<PointMatchingScoringFunction> scoringFunction;
     int    minPointMatchingSize;
     double minPointMatchingScore;
@@ -24,6 +24,19 @@ PointMatchingScoringFunction::PointMatchingScoringFunction()
     scoreDivisor    = 1.0f;
 }
 
+PointMatchingScoringFunction *
+PointMatchingScoringFunction::duplicate() const
+{
+    PointMatchingScoringFunction * scoringFunction =
+        new PointMatchingScoringFunction();
+
+    scoringFunction->scoreType       = scoreType;
+    scoringFunction->rmsdScaleFactor = rmsdScaleFactor;
+    scoringFunction->scoreDivisor    = scoreDivisor;
+
+    return scoringFunction;
+}
+
 void 
 PointMatchingScoringFunction::setRMSDScaleFactor(const double factor)
 {
@@ -127,3 +140,12 @@ PointMatchingScoringFunction::computeScore(const std::vector<double> & squaredDi
     
     return computeScore();
 }
+
+double
+PointMatchingScoringFunction::computeMaxScore(const int maxMatchingSize) const
+{
+    // same as computeScore() for an rmsd of 0
+    const double rmsd = 0.0;
+
+    return ((double(maxMatchingSize) / scoreDivisor) * exp(-rmsdScaleFactor * rmsd));
+}
@@ -21,6 +21,10 @@ class POINTMATCHING_API PointMatchingScoringFunction : public McHandable {
 public:
     /** Constructor. */
     PointMatchingScoringFunction();
+
+    /** Creates a scoring function with the same settings, e.g. for
+        computing scores in another thread. */
+    virtual PointMatchingScoringFunction * duplicate() const;
     
     /** Sets the matching score type. */
     void setScoreType(unsigned int type);
@@ -51,6 +55,10 @@ public:
     /** Computes the score from the current state of the member
         variables and @c newSquaredDist. */
     virtual double computeScore(const double newSquaredDist);
+
+    /** Returns an upper bound of the score of a matching with at most
+        @c maxMatchingSize pairs, i.e. the score for an rmsd of 0. */
+    virtual double computeMaxScore(const int maxMatchingSize) const;
     
     enum ScoreType {
         NORMALIZE_BY_MIN = 0,
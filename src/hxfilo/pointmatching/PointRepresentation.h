@@ -23,6 +23,7 @@ class PointMatchingDataStruct;
 class PointMatchingScoringFunction;
 class Transformation;
 class CacheObject;
+class PointDistanceMatrix;
 
 class POINTMATCHING_API PointRepresentation : public McHandable {
 
@@ -42,6 +43,16 @@ public:
                 const PointRepresentation * pointRep2, 
                 const Transformation      * pointRep2StartTransform) const = 0;
 
+    /** Same as startGreedyPointMatching, but may reuse data of the
+        cache object of the previous iteration of an iterative point
+        matching. @c previousCacheObject may be modified and must not
+        be used afterwards. It is NULL in the first iteration. */
+    virtual CacheObject * continueGreedyPointMatching(
+                const PointRepresentation * pointRep2, 
+                const Transformation      * pointRep2StartTransform,
+                CacheObject               * previousCacheObject) const
+    { return startGreedyPointMatching(pointRep2, pointRep2StartTransform); }
+
     virtual CacheObject * startExactPointMatching(
                 const PointRepresentation * pointRep2, 
                 const Transformation      * pointRep2StartTransform) const = 0;
@@ -61,13 +72,13 @@ public:
     virtual void computeCorrespondenceGraphEdges(
                 const PointRepresentation * pointSet2, 
                 const std::vector<McVec2i>   & corrGraph,
-                std::vector<McBitfield>      & connected) const = 0;
+                std::vector<std::vector<int> > & adjacency) const = 0;
 
     virtual void finishGreedyPointMatching() const = 0;
 
     virtual void finishExactPointMatching() const = 0;
 
-    virtual const std::vector<std::vector<double> > & getDistMatrix() const = 0;
+    virtual const PointDistanceMatrix & getDistMatrix() const = 0;
 
     virtual bool canPointsBeMatched(
 	       const int pointRep1PointIdx,
@@ -11,9 +11,13 @@
 
 #include "SimpleCacheObject3d.h"
 
+#include <algorithm>
+#include <cmath>
+
 SimpleCacheObject3d::SimpleCacheObject3d()
 {
-    // empty
+    candidateMaxDistance = 0.0;
+    candidateMaxDisplacement = -1.0;
 }
 
 SimpleCacheObject3d::~SimpleCacheObject3d()
@@ -40,6 +44,100 @@ SimpleCacheObject3d::getCoords() const
     return coords;
 }
 
+namespace {
+
+// Uniform grid over a point set, with cells at least as large as the search
+// distance, so that all points within that distance of a query point are found in
+// the 27 cells around the cell of the query point. Points are stored cell by cell.
+class PointGrid3d {
+public:
+    PointGrid3d(const std::vector<McVec3f> & coords,
+                const double              minCellSize)
+    {
+        const int numCoords = coords.size();
+
+        bboxMin = coords[0];
+        McVec3f bboxMax = coords[0];
+        for ( int i=1; i<numCoords; ++i ) {
+            for ( int d=0; d<3; ++d ) {
+                bboxMin[d] = std::min(bboxMin[d], coords[i][d]);
+                bboxMax[d] = std::max(bboxMax[d], coords[i][d]);
+            }
+        }
+
+        // Do not allocate much more cells than points, even if the search distance is small
+        const double maxNumCells = 8.0 * numCoords + 27.0;
+        cellSize = minCellSize;
+        double numCells;
+        do {
+            numCells = 1.0;
+            for ( int d=0; d<3; ++d ) {
+                numCells *= std::floor((bboxMax[d] - bboxMin[d]) / cellSize) + 1.0;
+            }
+            if ( numCells > maxNumCells ) {
+                cellSize *= std::max(std::pow(numCells / maxNumCells, 1.0 / 3.0), 1.1);
+            }
+        } while ( numCells > maxNumCells );
+
+        for ( int d=0; d<3; ++d ) {
+            dims[d] = int(std::floor((bboxMax[d] - bboxMin[d]) / cellSize)) + 1;
+        }
+
+        // Sort the points into the cells (counting sort, keeps point order within a cell)
+        std::vector<int> pointCell(numCoords);
+        cellStart.assign(dims[0] * dims[1] * dims[2] + 1, 0);
+        for ( int i=0; i<numCoords; ++i ) {
+            int cell[3];
+            for ( int d=0; d<3; ++d ) {
+                cell[d] = std::min(int((coords[i][d] - bboxMin[d]) / cellSize), dims[d] - 1);
+            }
+            pointCell[i] = (cell[2] * dims[1] + cell[1]) * dims[0] + cell[0];
+            cellStart[pointCell[i] + 1]++;
+        }
+        for ( size_t c=1; c<cellStart.size(); ++c ) {
+            cellStart[c] += cellStart[c-1];
+        }
+        cellPoints.resize(numCoords);
+        std::vector<int> cellFill(cellStart.begin(), cellStart.end() - 1);
+        for ( int i=0; i<numCoords; ++i ) {
+            cellPoints[cellFill[pointCell[i]]++] = i;
+        }
+    }
+
+    // Appends the indices of all points in the cells around point p
+    void getCandidates(const McVec3f    & p,
+                       std::vector<int> & candidates) const
+    {
+        int cellMin[3], cellMax[3];
+        for ( int d=0; d<3; ++d ) {
+            const double cell = std::floor((p[d] - bboxMin[d]) / cellSize);
+            if ( cell < -1.0 || cell > dims[d] ) {
+                return;
+            }
+            cellMin[d] = std::max(int(cell) - 1, 0);
+            cellMax[d] = std::min(int(cell) + 1, dims[d] - 1);
+        }
+
+        for ( int z=cellMin[2]; z<=cellMax[2]; ++z ) {
+            for ( int y=cellMin[1]; y<=cellMax[1]; ++y ) {
+                const int rowStart = (z * dims[1] + y) * dims[0];
+                const int first = cellStart[rowStart + cellMin[0]];
+                const int last = cellStart[rowStart + cellMax[0] + 1];
+                candidates.insert(candidates.end(), cellPoints.begin() + first, cellPoints.begin() + last);
+            }
+        }
+    }
+
+private:
+    McVec3f          bboxMin;
+    double           cellSize;
+    int              dims[3];
+    std::vector<int> cellStart;
+    std::vector<int> cellPoints;
+};
+
+} // namespace
+
 void 
 SimpleCacheObject3d::computeDistancesAndSort(
             const std::vector<McVec3f> & coords1,
@@ -58,12 +156,29 @@ SimpleCacheObject3d::computeDistancesAndSort(
 
     pointCorrespondence.clear();
     pointDist2.clear();
+    sortedDist2List.clear();
 
     double dist2;    
     double maxDistance2 = maxDistance * maxDistance;
 
+    if ( numCoords1 == 0 || numCoords2 == 0 || !(maxDistance2 > 0.0) ) {
+        return;
+    }
+
+    // Only pairs in neighboring grid cells can be closer than maxDistance.
+    // The pairs are collected in the same order as by comparing all pairs,
+    // so that the sorting below gives the same sequence of pairs.
+    // The small margin accounts for rounding when computing the cells.
+    const PointGrid3d grid(coords2, std::fabs(maxDistance) * (1.0 + 1.0e-6));
+
+    std::vector<int> candidates;
     for ( int i=0; i<numCoords1; ++i ) {
-        for ( int j=0; j<numCoords2; ++j ) {
+        candidates.clear();
+        grid.getCandidates(coords1[i], candidates);
+        std::sort(candidates.begin(), candidates.end());
+
+        for ( size_t k=0; k<candidates.size(); ++k ) {
+            const int j = candidates[k];
             dist2 = (coords1[i] - coords2[j]).length2();
             if ( dist2 < maxDistance2 ) {
                 pointCorrespondence.push_back(McVec2i(i,j));
@@ -83,6 +198,146 @@ SimpleCacheObject3d::computeDistancesAndSort(
     }
 }
 
+bool
+SimpleCacheObject3d::canReuseCandidatePairs(
+            const std::vector<McVec3f> & coords1,
+            const std::vector<McVec3f> & coords2,
+            const double              maxDistance) const
+{
+    if (    candidateMaxDisplacement < 0.0 
+         || candidateMaxDistance != maxDistance
+         || candidateCoords1.size() != coords1.size()
+         || candidateCoords2.size() != coords2.size() )
+        return false;
+
+    for ( size_t i=0; i<coords1.size(); ++i ) {
+        for ( int d=0; d<3; ++d ) {
+            if ( candidateCoords1[i][d] != coords1[i][d] )
+                return false;
+        }
+    }
+
+    const double maxDisplacement2 = candidateMaxDisplacement * candidateMaxDisplacement;
+    for ( size_t j=0; j<coords2.size(); ++j ) {
+        if ( (coords2[j] - candidateCoords2[j]).length2() > maxDisplacement2 )
+            return false;
+    }
+
+    return true;
+}
+
+void
+SimpleCacheObject3d::computeCandidatePairs(
+            const std::vector<McVec3f> & coords1,
+            const double              maxDistance)
+{
+    const std::vector<McVec3f> & coords2 = this->coords;
+
+    const int numCoords1 = coords1.size();
+
+    // A pair closer than maxDistance was closer than maxDistance + margin
+    // before the points of the second set moved by less than the margin.
+    const double margin = 0.25 * std::fabs(maxDistance);
+    const double searchDistance = std::fabs(maxDistance) + margin;
+    const double searchDistance2 = searchDistance * searchDistance;
+
+    candidatePairs.clear();
+    candidateCoords1 = coords1;
+    candidateCoords2 = coords2;
+    candidateMaxDistance = maxDistance;
+
+    // Leave room for rounding errors in the float distances
+    double maxAbsCoord = 0.0;
+    for ( size_t i=0; i<coords1.size(); ++i ) {
+        for ( int d=0; d<3; ++d )
+            maxAbsCoord = std::max(maxAbsCoord, double(std::fabs(coords1[i][d])));
+    }
+    for ( size_t j=0; j<coords2.size(); ++j ) {
+        for ( int d=0; d<3; ++d )
+            maxAbsCoord = std::max(maxAbsCoord, double(std::fabs(coords2[j][d])));
+    }
+    candidateMaxDisplacement = margin - 1.0e-5 * (maxAbsCoord + searchDistance);
+
+    const PointGrid3d grid(coords2, searchDistance * (1.0 + 1.0e-6));
+
+    std::vector<int> candidates;
+    for ( int i=0; i<numCoords1; ++i ) {
+        candidates.clear();
+        grid.getCandidates(coords1[i], candidates);
+        std::sort(candidates.begin(), candidates.end());
+
+        for ( size_t k=0; k<candidates.size(); ++k ) {
+            const int j = candidates[k];
+            if ( (coords1[i] - coords2[j]).length2() < searchDistance2 ) {
+                candidatePairs.push_back(McVec2i(i,j));
+            }
+        }
+    }
+}
+
+void 
+SimpleCacheObject3d::computeDistancesAndSort(
+            const std::vector<McVec3f> & coords1,
+            const double              maxDistance,
+            SimpleCacheObject3d     * previousCacheObject)
+{
+    const std::vector<McVec3f> & coords2 = this->coords;
+
+    const int numCoords1 = coords1.size();
+    const int numCoords2 = coords2.size();
+
+    pointSet1IsMatched.resize(numCoords1);
+    pointSet1IsMatched.unsetAll();
+    pointSet2IsMatched.resize(numCoords2);
+    pointSet2IsMatched.unsetAll();
+    currListIndex = 0;
+
+    pointCorrespondence.clear();
+    pointDist2.clear();
+    sortedDist2List.clear();
+
+    double dist2;    
+    double maxDistance2 = maxDistance * maxDistance;
+
+    if ( numCoords1 == 0 || numCoords2 == 0 || !(maxDistance2 > 0.0) ) {
+        return;
+    }
+
+    if (    previousCacheObject 
+         && previousCacheObject->canReuseCandidatePairs(coords1, coords2, maxDistance) ) {
+        candidatePairs.swap(previousCacheObject->candidatePairs);
+        candidateCoords1.swap(previousCacheObject->candidateCoords1);
+        candidateCoords2.swap(previousCacheObject->candidateCoords2);
+        candidateMaxDistance = previousCacheObject->candidateMaxDistance;
+        candidateMaxDisplacement = previousCacheObject->candidateMaxDisplacement;
+        previousCacheObject->candidateMaxDisplacement = -1.0;
+    }
+    else {
+        computeCandidatePairs(coords1, maxDistance);
+    }
+
+    // The candidates are ordered as the pairs in computeDistancesAndSort above
+    for ( size_t k=0; k<candidatePairs.size(); ++k ) {
+        const int i = candidatePairs[k][0];
+        const int j = candidatePairs[k][1];
+        dist2 = (coords1[i] - coords2[j]).length2();
+        if ( dist2 < maxDistance2 ) {
+            pointCorrespondence.push_back(candidatePairs[k]);
+            pointDist2.push_back(dist2);
+        }
+    }
+
+    sortedDist2List.resize(pointCorrespondence.size());
+    for ( size_t i=0; i<sortedDist2List.size(); ++i ) {
+        sortedDist2List[i] = i;   
+    }
+
+    if (pointDist2.size() > 0) {
+        McIndexByValueComparator<double> comparator(&pointDist2[0]);
+        sort(&(sortedDist2List[0]), sortedDist2List.size(), comparator);
+    }
+}
+
 bool
 SimpleCacheObject3d::getNextMatchingPair(
             int    & set1PointIx,
@@ -33,6 +33,16 @@ public:
     void computeDistancesAndSort(const std::vector<McVec3f> & coords,
                                  const double              maxDistance);
 
+    /** Same as above, but for repeated calls with slowly changing
+        transformations. All pairs closer than @c maxDistance plus a
+        margin are kept as candidates. If the transformed points have
+        moved less than the margin since the candidates were computed,
+        only the candidates of @c previousCacheObject are checked,
+        which are taken over. Gives the same pairs in the same order. */
+    void computeDistancesAndSort(const std::vector<McVec3f> & coords,
+                                 const double              maxDistance,
+                                 SimpleCacheObject3d     * previousCacheObject);
+
     bool getNextMatchingPair(int    & set1PointIx,
                              int    & set2PointIx,
                              double & dist2);
@@ -41,11 +51,28 @@ protected:
     std::vector<McVec3f> coords;
     
 private:
+    bool canReuseCandidatePairs(const std::vector<McVec3f> & coords1,
+                                const std::vector<McVec3f> & coords2,
+                                const double              maxDistance) const;
+
+    void computeCandidatePairs(const std::vector<McVec3f> & coords1,
+                               const double              maxDistance);
+
     std::vector<McVec2i> pointCorrespondence;
     std::vector<double>  pointDist2;
     std::vector<int>     sortedDist2List;
     McBitfield        pointSet1IsMatched;
     McBitfield        pointSet2IsMatched;
     int               currListIndex;
+
+    // Candidate pairs for incremental matching, computed for candidateCoords1
+    // and candidateCoords2. They contain all pairs closer than
+    // candidateMaxDistance as long as no point has moved by more than
+    // candidateMaxDisplacement.
+    std::vector<McVec2i> candidatePairs;
+    std::vector<McVec3f> candidateCoords1;
+    std::vector<McVec3f> candidateCoords2;
+    double               candidateMaxDistance;
+    double               candidateMaxDisplacement;
 };
 #endif
@@ -12,6 +12,7 @@
 
 #include "SimplePointRepresentation3d.h"
 #include "SimpleCacheObject3d.h"
+#include "CorrespondenceGraph.h"
 #include "PointMatchingDataStruct.h"
 #include "PointMatchingScoringFunction.h"
 #include "Transformation.h"
@@ -48,7 +49,7 @@ SimplePointRepresentation3d::getCoords() const
     return coords;
 }
 
-const std::vector<std::vector<double> > & 
+const PointDistanceMatrix & 
 SimplePointRepresentation3d::getDistMatrix() const
 {
     return distMatrix;
@@ -59,25 +60,15 @@ SimplePointRepresentation3d::computeBBoxAndDistMatrix()
 {
     int numPoints = coords.size();
 
-    // compute bounding box and resize distMatrix
+    // compute bounding box
     bbox.makeEmpty();
-    distMatrix.resize(numPoints);
     for ( int i=0; i<numPoints; i++ ) {
         bbox.extendBy(coords[i]);
-        distMatrix[i].resize(numPoints);
     }
 
     // compute distance matrix
-    maximumDistance = 0.0f;
-    for ( int i=0; i<numPoints; i++ ) {
-        distMatrix[i][i] = 0.0f;
-        for ( int j=i+1; j<numPoints; j++ ) {
-            distMatrix[i][j] = distMatrix[j][i] = 
-                (coords[i] - coords[j]).length();
-            if ( distMatrix[i][j] > maximumDistance ) 
-                maximumDistance = distMatrix[i][j];
-        }
-    }
+    distMatrix.setCoords(coords);
+    maximumDistance = distMatrix.getMaximumDistance();
     bbox.extendByEps(0.05);
 }
 
@@ -125,28 +116,17 @@ void
 SimplePointRepresentation3d::computeCorrespondenceGraphEdges(
         const PointRepresentation * pointSet2, 
         const std::vector<McVec2i>           & corrGraph,
-        std::vector<McBitfield>              & connected) const
+        std::vector<std::vector<int> >      & adjacency) const
 {
-    connected.resize(corrGraph.size());
-
-    for ( size_t i=0; i<connected.size(); i++ ) {
-        connected[i].resize(corrGraph.size());
-        connected[i].setAll();
-    }
-
-    const std::vector<std::vector<double> > & distMatrix1 = this->getDistMatrix();
-    const std::vector<std::vector<double> > & distMatrix2 = pointSet2->getDistMatrix();
-        
-    for ( size_t i=0; i<corrGraph.size(); i++ ) {
-        for ( size_t j=i+1; j<corrGraph.size(); j++ ) {
-            if ( std::abs(distMatrix1[corrGraph[i][0]][corrGraph[j][0]]-
-                          distMatrix2[corrGraph[i][1]][corrGraph[j][1]]) >
-                 mCliqueDistThreshold ) {
-                connected[i].unset(j);
-                connected[j].unset(i);
-            } 
-        }
-    }   
+    const PointDistanceMatrix & distMatrix1 = this->getDistMatrix();
+    const PointDistanceMatrix & distMatrix2 = pointSet2->getDistMatrix();
+
+    computeCorrespondenceGraphEdgesFromSortedDistances(distMatrix1,
+                                                       distMatrix2,
+                                                       mCliqueDistThreshold,
+                                                       corrGraph,
+                                                       CorrespondenceGraphAcceptAllEdges(),
+                                                       adjacency);
 }
 
 void 
@@ -200,6 +180,28 @@ SimplePointRepresentation3d::startGreedyPointMatching(
     return cacheObject;
 }
 
+CacheObject * 
+SimplePointRepresentation3d::continueGreedyPointMatching(
+        const PointRepresentation * pointSet2,
+        const Transformation      * pointSet2StartTransform,
+        CacheObject               * previousCacheObject) const
+{
+    const SimplePointRepresentation3d * simplePointSet2 = 
+        dynamic_cast<const SimplePointRepresentation3d *>(pointSet2);
+
+    assert(simplePointSet2);
+
+    SimpleCacheObject3d * cacheObject = new SimpleCacheObject3d();
+    cacheObject->setCoords(simplePointSet2->getCoords(),
+                           pointSet2StartTransform->getTransformation3d());
+
+    cacheObject->computeDistancesAndSort(coords,
+                                         mMaxPointDistance,
+                                         dynamic_cast<SimpleCacheObject3d *>(previousCacheObject));
+
+    return cacheObject;
+}
+
 bool 
 SimplePointRepresentation3d::getNextMatchingPair(
         CacheObject * cacheObject,
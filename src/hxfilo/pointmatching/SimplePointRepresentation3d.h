@@ -14,6 +14,7 @@
 #include <mclib/McBox3f.h>
 #include <mclib/McBitfield.h>
 
+#include "PointDistanceMatrix.h"
 #include "PointRepresentation.h"
 #include "api.h"
 
@@ -27,7 +28,7 @@ public:
 
     void setCoords(const std::vector<McVec3f> & coords);
     const std::vector<McVec3f> & getCoords() const;
-    const std::vector<std::vector<double> > & getDistMatrix() const;
+    const PointDistanceMatrix & getDistMatrix() const;
 
     virtual int getNumPoints() const;
 
@@ -38,7 +39,7 @@ public:
     virtual void computeCorrespondenceGraphEdges(
                 const PointRepresentation * pointSet2, 
                 const std::vector<McVec2i>           & corrGraph,
-                std::vector<McBitfield>              & connected) const;
+                std::vector<std::vector<int> >      & adjacency) const;
 
     virtual void computeTransformation(
                 const PointRepresentation     * pointSet2,
@@ -55,6 +56,11 @@ public:
                 const PointRepresentation * pointSet2,
                 const Transformation      * pointSet2StartTransform) const;
 
+    virtual CacheObject * continueGreedyPointMatching(
+                const PointRepresentation * pointSet2,
+                const Transformation      * pointSet2StartTransform,
+                CacheObject               * previousCacheObject) const;
+
     virtual CacheObject * startExactPointMatching(
                 const PointRepresentation * pointSet2,
                 const Transformation      * pointSet2StartTransform) const;
@@ -93,7 +99,7 @@ private:
     std::vector<McVec3f>           coords;
     McBox3f                     bbox;
     double                      maximumDistance;
-    std::vector<std::vector<double> > distMatrix;
+    PointDistanceMatrix         distMatrix;
     int                         transformType;
     double                      mMaxPointDistance;
     double                      mMaxPointDistance2;
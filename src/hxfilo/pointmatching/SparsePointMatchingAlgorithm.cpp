@@ -13,6 +13,15 @@ SparsePointMatchingAlgorithm::SparsePointMatchingAlgorithm()
 
 }
 
+PointMatchingAlgorithm *
+SparsePointMatchingAlgorithm::duplicate() const
+{
+    SparsePointMatchingAlgorithm * algorithm = new SparsePointMatchingAlgorithm();
+    duplicateSettings(algorithm);
+
+    return algorithm;
+}
+
 void 
 SparsePointMatchingAlgorithm::computePointMatching(
             const PointRepresentation * pointRep1, 
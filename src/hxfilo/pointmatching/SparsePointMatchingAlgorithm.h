@@ -21,6 +21,8 @@ class POINTMATCHING_API SparsePointMatchingAlgorithm : public PointMatchingAlgor
     
 public:
     SparsePointMatchingAlgorithm();
+
+    virtual PointMatchingAlgorithm * duplicate() const;
     
     virtual void computePointMatching(const PointRepresentation * pointRep1, 
                                       const PointRepresentation * pointRep2,
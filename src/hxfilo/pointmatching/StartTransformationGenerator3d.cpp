@@ -6,7 +6,6 @@
 // 
 /////////////////////////////////////////////////////////////////
 
-#include <mclib/McBitfield.h>
 #include <mclib/internal/McAlignPointSets.h>
 #include <mclib/McVec3.h>
 #include <mclib/internal/McAssert.h>
@@ -51,38 +50,24 @@ StartTransformationGenerator3d::compute(const PointRepresentation * pointSet1,
                                         std::vector<Transformation>          & startTransformations,
                                         std::vector<int>                     & cliqueSizes)
 {
-    // initialize connectivity of correspondence graph
-    //   - each node is connected to itself; 
-    //     this is needed for the clique detection algorithm
-    std::vector<McBitfield> connected;
-
     std::vector<McVec2i> corrGraph;
     pointSet1->computeCorrespondenceGraphVertices(pointSet2,
                                                   corrGraph);
 
     // compute edges of correspondence graph
+    std::vector<std::vector<int> > adjacency;
     pointSet1->computeCorrespondenceGraphEdges(pointSet2, 
                                                corrGraph,
-                                               connected);
-    
-    std::vector<int> notAndCand(corrGraph.size());
-    for ( size_t i=0; i<corrGraph.size(); i++ ) {
-        notAndCand[i] = i;
-    }
+                                               adjacency);
 
     int nCliques = 0;
-    std::vector<int> clique;
     std::vector<std::vector<int> > cliques;
     bool returnStatus = 
-        McCliqueDetection::computeCliquesBronKerbosch(clique, 
-                                                      notAndCand, 
-                                                      0, 
-                                                      notAndCand.size(),
-                                                      connected, 
-                                                      nCliques, 
-                                                      cliques, 
-                                                      minCliqueSize,
-                                                      maxNumStartTransformations);
+        McCliqueDetection::computeCliquesBronKerboschBitset(adjacency, 
+                                                            nCliques, 
+                                                            cliques, 
+                                                            minCliqueSize,
+                                                            maxNumStartTransformations);
 
     const std::vector<McVec3f> & coordsOfReference = pointSet1->getCoords();
     const std::vector<McVec3f> & coordsOfQuery     = pointSet2->getCoords();
@@ -0,0 +1,162 @@
+#include <mclib/McVec3.h>
+#include <mclib/McVec2i.h>
+#include <mclib/McBitfield.h>
+#include <mclib/internal/McWatch.h>
+
+#include "SimplePointRepresentation3d.h"
+#include "McCliqueDetection.h"
+#include "Test_CliqueDetection.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Random points in a box and a second set with the same points slightly
+// moved, which gives the kind of correspondence graph used for finding
+// start transformations.
+void getRandomGeometricCoords(const int numPoints,
+                              std::vector<McVec3f> & coords1,
+                              std::vector<McVec3f> & coords2)
+{
+    std::mt19937 generator(numPoints);
+    std::uniform_real_distribution<float> position(0.0f, 10.0f);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+
+    coords1.resize(numPoints);
+    coords2.resize(numPoints);
+    for ( int i=0; i<numPoints; ++i )
+    {
+        coords1[i] = McVec3f(position(generator), position(generator), position(generator));
+        coords2[i] = coords1[i] + McVec3f(noise(generator), noise(generator), noise(generator));
+    }
+}
+
+void getCorrespondenceGraph(const int numPoints,
+                            const double cliqueDistThreshold,
+                            std::vector<std::vector<int> > & adjacency)
+{
+    std::vector<McVec3f> coords1;
+    std::vector<McVec3f> coords2;
+    getRandomGeometricCoords(numPoints, coords1, coords2);
+
+    SimplePointRepresentation3d pointRep1(4.0, cliqueDistThreshold);
+    pointRep1.setCoords(coords1);
+
+    SimplePointRepresentation3d pointRep2(4.0, cliqueDistThreshold);
+    pointRep2.setCoords(coords2);
+
+    std::vector<McVec2i> corrGraph;
+    pointRep1.computeCorrespondenceGraphVertices(&pointRep2, corrGraph);
+    pointRep1.computeCorrespondenceGraphEdges(&pointRep2, corrGraph, adjacency);
+}
+
+bool computeCliquesWithBitfields(const std::vector<std::vector<int> > & adjacency,
+                                 const int minCliqueSize,
+                                 const int maxNumCliques,
+                                 int & nCliques,
+                                 std::vector<std::vector<int> > & cliques)
+{
+    std::vector<McBitfield> connected(adjacency.size());
+    for ( size_t i=0; i<adjacency.size(); ++i )
+    {
+        connected[i].resize(adjacency.size());
+        connected[i].unsetAll();
+        connected[i].set(i);
+        for ( size_t j=0; j<adjacency[i].size(); ++j )
+            connected[i].set(adjacency[i][j]);
+    }
+
+    std::vector<int> notAndCand(adjacency.size());
+    for ( size_t i=0; i<adjacency.size(); ++i )
+        notAndCand[i] = i;
+
+    std::vector<int> clique;
+    return McCliqueDetection::computeCliquesBronKerbosch(clique,
+                                                         notAndCand,
+                                                         0,
+                                                         notAndCand.size(),
+                                                         connected,
+                                                         nCliques,
+                                                         cliques,
+                                                         minCliqueSize,
+                                                         maxNumCliques);
+}
+
+}
+
+bool Test_CliqueDetection::test1()
+{
+    printf("Test_CliqueDetection::test1\n");
+
+    return ( test(8, 0.5, 3, -1) &&
+             test(12, 0.2, 3, -1) &&
+             test(12, 0.2, 3, 10) &&
+             test(15, 0.1, 5, -1) &&
+             test(15, 0.3, 4, 50) );
+}
+
+bool Test_CliqueDetection::benchmark()
+{
+    printf("Test_CliqueDetection::benchmark\n");
+
+    bool result = true;
+    const int numPoints[] = { 20, 40, 60 };
+    for ( int i=0; i<3; ++i )
+    {
+        std::vector<std::vector<int> > adjacency;
+        getCorrespondenceGraph(numPoints[i], 0.2, adjacency);
+
+        int nCliques1 = 0;
+        std::vector<std::vector<int> > cliques1;
+        McWatch watch1;
+        computeCliquesWithBitfields(adjacency, 5, -1, nCliques1, cliques1);
+        const double time1 = watch1.stop();
+
+        int nCliques2 = 0;
+        std::vector<std::vector<int> > cliques2;
+        McWatch watch2;
+        McCliqueDetection::computeCliquesBronKerboschBitset(adjacency, nCliques2, cliques2, 5, -1);
+        const double time2 = watch2.stop();
+
+        printf("%d points, %d vertices: %d cliques, bitfield %f s, bitset %f s\n",
+               numPoints[i], int(adjacency.size()), nCliques2, time1, time2);
+        fflush(stdout);
+
+        result = result && ( cliques1 == cliques2 );
+    }
+
+    return result;
+}
+
+bool Test_CliqueDetection::test(const int numPoints,
+                                const double cliqueDistThreshold,
+                                const int minCliqueSize,
+                                const int maxNumCliques)
+{
+    std::vector<std::vector<int> > adjacency;
+    getCorrespondenceGraph(numPoints, cliqueDistThreshold, adjacency);
+
+    int nCliques1 = 0;
+    std::vector<std::vector<int> > cliques1;
+    const bool status1 =
+        computeCliquesWithBitfields(adjacency, minCliqueSize, maxNumCliques, nCliques1, cliques1);
+
+    int nCliques2 = 0;
+    std::vector<std::vector<int> > cliques2;
+    const bool status2 =
+        McCliqueDetection::computeCliquesBronKerboschBitset(adjacency, nCliques2, cliques2,
+                                                            minCliqueSize, maxNumCliques);
+
+    const bool result = ( status1 == status2 &&
+                          nCliques1 == nCliques2 &&
+                          cliques1 == cliques2 );
+
+    printf("%d points, threshold %f, min. clique size %d: %d cliques %s\n",
+           numPoints, cliqueDistThreshold, minCliqueSize, nCliques2,
+           result ? "ok" : "FAILED");
+    fflush(stdout);
+
+    return result;
+}
@@ -0,0 +1,18 @@
+#ifndef TEST_CLIQUE_DETECTION_H
+#define TEST_CLIQUE_DETECTION_H
+
+#include <vector>
+
+class Test_CliqueDetection
+{
+public:
+    static bool test1();
+    static bool benchmark();
+
+    static bool test(const int numPoints,
+                     const double cliqueDistThreshold,
+                     const int minCliqueSize,
+                     const int maxNumCliques);
+};
+
+#endif
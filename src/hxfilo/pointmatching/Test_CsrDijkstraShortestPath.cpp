@@ -0,0 +1,128 @@
+#include "hxgraphalgorithms/McCsrDijkstraShortestPath.h"
+#include "hxgraphalgorithms/McDijkstraShortestPath.h"
+#include "Test_CsrDijkstraShortestPath.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Compares the result of the last query of shortestPath for vertex v with
+// the result of McDijkstraShortestPath, which marks unreached vertices by
+// a large distance and no predecessor edge.
+bool isSameResult(const McCsrDijkstraShortestPath & shortestPath,
+                  const std::vector<McDijkstraVertex> & vertices,
+                  const int s,
+                  const int v)
+{
+    const bool isReached = ( v == s || vertices[v].predEdge != 0 );
+    if ( !isReached )
+        return ( shortestPath.getDistance(v) < 0.0 && shortestPath.getPredEdge(v) == -1 );
+
+    const int predEdge = vertices[v].predEdge ? vertices[v].predEdge->id : -1;
+    if ( shortestPath.getDistance(v) != vertices[v].distance || shortestPath.getPredEdge(v) != predEdge )
+        return false;
+
+    // the path has to follow the predecessor edges back to s
+    std::vector<int> path;
+    if ( !shortestPath.getPath(v, path) || path.empty() || path.front() != s || path.back() != v )
+        return false;
+
+    int u = v;
+    for ( int i=int(path.size())-1; i>0; --i )
+    {
+        if ( !vertices[u].predEdge || vertices[u].predEdge->startVertex != path[i-1] )
+            return false;
+        u = path[i-1];
+    }
+    return true;
+}
+
+}
+
+bool Test_CsrDijkstraShortestPath::test1()
+{
+    printf("Test_CsrDijkstraShortestPath::test1\n");
+
+    // One object is used for all graphs and queries, so that stale
+    // data of earlier queries and graphs would show up as errors.
+    McCsrDijkstraShortestPath shortestPath;
+
+    return ( test(shortestPath, 10, 20, 20) &&
+             test(shortestPath, 50, 100, 50) &&
+             test(shortestPath, 100, 1000, 100) &&
+             test(shortestPath, 300, 600, 100) &&
+             test(shortestPath, 300, 3000, 100) &&
+             test(shortestPath, 20, 30, 5000) );
+}
+
+bool Test_CsrDijkstraShortestPath::test(McCsrDijkstraShortestPath & shortestPath,
+                                        const int numVertices,
+                                        const int numEdges,
+                                        const int numQueries)
+{
+    std::mt19937 generator(numVertices + numEdges);
+    std::uniform_real_distribution<double> length(0.0, 1.0);
+    std::uniform_int_distribution<int> vertex(0, numVertices - 1);
+
+    // The edges must not be reallocated after they have been added to the
+    // edge lists of the vertices.
+    std::vector<McDijkstraVertex> vertices(numVertices);
+    std::vector<McDijkstraEdge> edges(numEdges);
+    std::vector<int> startVertices(numEdges);
+    std::vector<int> endVertices(numEdges);
+    std::vector<double> edgeLengths(numEdges);
+    for ( int e=0; e<numEdges; ++e )
+    {
+        edges[e].startVertex = startVertices[e] = vertex(generator);
+        edges[e].endVertex = endVertices[e] = vertex(generator);
+        edges[e].edgeLength = edgeLengths[e] = length(generator);
+        edges[e].id = e;
+        vertices[edges[e].startVertex].edges.append(&edges[e]);
+    }
+
+    shortestPath.setGraph(numVertices, startVertices, endVertices, edgeLengths);
+
+    // One-to-one and one-to-all queries alternate, so that every query
+    // starts with the data of a different earlier query.
+    int numFailed = 0;
+    int numReached = 0;
+    for ( int q=0; q<numQueries; ++q )
+    {
+        const int s = vertex(generator);
+        if ( q % 2 == 0 )
+        {
+            McDijkstraShortestPath::computeOneToAll(vertices, edges, s);
+            shortestPath.computeOneToAll(s);
+
+            for ( int v=0; v<numVertices; ++v )
+            {
+                if ( !isSameResult(shortestPath, vertices, s, v) )
+                    ++numFailed;
+            }
+        }
+        else
+        {
+            int t = vertex(generator);
+            while ( t == s )
+                t = vertex(generator);
+
+            const bool isFound = McDijkstraShortestPath::computeOneToOne(vertices, edges, s, t);
+            if ( shortestPath.computeOneToOne(s, t) != isFound || !isSameResult(shortestPath, vertices, s, t) )
+                ++numFailed;
+            if ( isFound )
+                ++numReached;
+        }
+    }
+
+    const bool result = ( numFailed == 0 );
+
+    printf("%d vertices, %d edges, %d queries: %d one-to-one paths found, %d differences %s\n",
+           numVertices, numEdges, numQueries, numReached, numFailed,
+           result ? "ok" : "FAILED");
+    fflush(stdout);
+
+    return result;
+}
@@ -0,0 +1,19 @@
+#ifndef TEST_CSR_DIJKSTRA_SHORTEST_PATH_H
+#define TEST_CSR_DIJKSTRA_SHORTEST_PATH_H
+
+class McCsrDijkstraShortestPath;
+
+// Compares the distances and predecessor edges of McCsrDijkstraShortestPath
+// with those of McDijkstraShortestPath on random graphs.
+class Test_CsrDijkstraShortestPath
+{
+public:
+    static bool test1();
+
+    static bool test(McCsrDijkstraShortestPath & shortestPath,
+                     const int numVertices,
+                     const int numEdges,
+                     const int numQueries);
+};
+
+#endif
@@ -80,6 +80,17 @@ void getUserDefinedEdgeWeights(const std::vector<McVec3f> & coords1,
     }
 }
 
+// The matched pairs are returned ordered by reference point.
+bool isOrderedByRefPoint(const std::vector<int> & refPoints)
+{
+    for ( size_t i=1; i<refPoints.size(); ++i )
+    {
+        if ( refPoints[i-1] >= refPoints[i] )
+            return false;
+    }
+    return true;
+}
+
 }
 
 bool Test_ExactPointMatching::test1()
@@ -186,9 +197,12 @@ bool Test_ExactPointMatching::test(const std::vector< McVec3f > & coords1,
     }
     printf("\n");
     printf("score: %f\n", pointMatching.getScore());
+
+    const bool result = isOrderedByRefPoint(refPoints);
+    printf("ordered by reference point: %s\n", result ? "ok" : "FAILED");
     fflush(stdout);
 
-    return true;
+    return result;
 }
 
 bool Test_ExactPointMatching::testMaxCardinality(const std::vector< McVec3f > & coords1,
@@ -220,9 +234,12 @@ bool Test_ExactPointMatching::testMaxCardinality(const std::vector< McVec3f > &
     }
     printf("\n");
     printf("score: %f\n", pointMatching.getScore());
+
+    const bool result = isOrderedByRefPoint(refPoints);
+    printf("ordered by reference point: %s\n", result ? "ok" : "FAILED");
     fflush(stdout);
 
-    return true;
+    return result;
 }
 
 bool Test_ExactPointMatching::testUserDefinedEdgeWeights(const std::vector< McVec3f > & coords1,
@@ -258,7 +275,10 @@ bool Test_ExactPointMatching::testUserDefinedEdgeWeights(const std::vector< McVe
     }
     printf("\n");
     printf("score: %f\n", pointMatching.getScore());
+
+    const bool result = isOrderedByRefPoint(refPoints);
+    printf("ordered by reference point: %s\n", result ? "ok" : "FAILED");
     fflush(stdout);
 
-    return true;
+    return result;
 }
@@ -1,13 +1,18 @@
 
 #include <mclib/McVec3.h>
 #include <mclib/McMat4.h>
+#include <mclib/McHandle.h>
 
 #include "SimplePointRepresentation3d.h"
 #include "GreedyPointMatchingAlgorithm.h"
+#include "IterativePointMatching.h"
+#include "StartTransformationGenerator3d.h"
 #include "Transformation.h"
 #include "PointMatchingDataStruct.h"
 #include "Test_GreedyPointMatching.h"
 
+#include <cmath>
+#include <random>
 #include <vector>
 
 namespace
@@ -134,6 +139,242 @@ bool Test_GreedyPointMatching::test5()
     return test(coords1, coords2);
 }
 
+bool Test_GreedyPointMatching::testIncremental()
+{
+    printf("Test_GreedyPointMatching::testIncremental\n");
+
+    // second point set is a noisy, shifted copy of the first one
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> position(0.0f, 100.0f);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+    std::vector<McVec3f> coords1(2000);
+    std::vector<McVec3f> coords2(2000);
+    for ( size_t i=0; i<coords1.size(); ++i )
+    {
+        coords1[i] = McVec3f(position(generator), position(generator), position(generator));
+        coords2[i] = coords1[i] + McVec3f(1.5f + noise(generator), -1.0f + noise(generator), noise(generator));
+    }
+
+    SimplePointRepresentation3d pointRep1(2.0, 0.0);
+    pointRep1.setCoords(coords1);
+
+    SimplePointRepresentation3d pointRep2(2.0, 0.0);
+    pointRep2.setCoords(coords2);
+
+    Transformation startTransform;
+    getIdentityTransformation(startTransform);
+
+    GreedyPointMatchingAlgorithm greedyAlgorithm;
+
+    PointMatchingDataStruct pointMatching[2];
+    Transformation pointRep2Transform[2];
+    int numIterations[2];
+    for ( int incremental=0; incremental<2; ++incremental )
+    {
+        IterativePointMatching iterativePointMatching;
+        iterativePointMatching.setIncremental(incremental);
+        iterativePointMatching.computePointMatching(&greedyAlgorithm,
+                                                    &pointRep1,
+                                                    &pointRep2,
+                                                    &startTransform,
+                                                    &pointMatching[incremental],
+                                                    &pointRep2Transform[incremental],
+                                                    numIterations[incremental]);
+    }
+
+    bool isEqual =    pointMatching[0].getRefPoints() == pointMatching[1].getRefPoints()
+                   && pointMatching[0].getQueryPoints() == pointMatching[1].getQueryPoints()
+                   && pointMatching[0].getScore() == pointMatching[1].getScore()
+                   && numIterations[0] == numIterations[1];
+
+    const McMat4f & matrix0 = pointRep2Transform[0].getTransformation3d();
+    const McMat4f & matrix1 = pointRep2Transform[1].getTransformation3d();
+    for ( int i=0; i<4; ++i )
+        for ( int j=0; j<4; ++j )
+            isEqual = isEqual && matrix0[i][j] == matrix1[i][j];
+
+    printf("matching size %d, %d iterations: %s\n",
+           int(pointMatching[0].getRefPoints().size()),
+           numIterations[0],
+           isEqual ? "ok" : "FAILED");
+    fflush(stdout);
+
+    return isEqual;
+}
+
+bool Test_GreedyPointMatching::testConsecutive()
+{
+    printf("Test_GreedyPointMatching::testConsecutive\n");
+
+    // point sets moving slowly, as in consecutive frames of a movie
+    std::mt19937 generator(2);
+    std::uniform_real_distribution<float> position(0.0f, 100.0f);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+    const int numFrames = 20;
+    std::vector<McVec3f> coords(500);
+    for ( size_t i=0; i<coords.size(); ++i )
+        coords[i] = McVec3f(position(generator), position(generator), position(generator));
+
+    std::vector< McHandle<SimplePointRepresentation3d> > pointReps(numFrames);
+    std::vector<const PointRepresentation *> pointRepPtrs(numFrames);
+    for ( int t=0; t<numFrames; ++t )
+    {
+        for ( size_t i=0; i<coords.size(); ++i )
+            coords[i] += McVec3f(noise(generator), noise(generator), noise(generator));
+
+        pointReps[t] = new SimplePointRepresentation3d(2.0, 0.0);
+        pointReps[t]->setCoords(coords);
+        pointRepPtrs[t] = pointReps[t];
+    }
+
+    Transformation pointRep2Transform;
+    getIdentityTransformation(pointRep2Transform);
+
+    GreedyPointMatchingAlgorithm greedyAlgorithm;
+
+    std::vector< McHandle<PointMatchingDataStruct> > pointMatchings;
+    greedyAlgorithm.computeConsecutivePointMatchings(pointRepPtrs,
+                                                     &pointRep2Transform,
+                                                     pointMatchings);
+
+    bool isEqual = ( int(pointMatchings.size()) == numFrames - 1 );
+    for ( int t=0; isEqual && t<numFrames-1; ++t )
+    {
+        PointMatchingDataStruct pointMatching;
+        greedyAlgorithm.computePointMatching(pointReps[t],
+                                             pointReps[t+1],
+                                             &pointRep2Transform,
+                                             &pointMatching);
+
+        isEqual =    pointMatching.getRefPoints() == pointMatchings[t]->getRefPoints()
+                  && pointMatching.getQueryPoints() == pointMatchings[t]->getQueryPoints()
+                  && pointMatching.getScore() == pointMatchings[t]->getScore();
+    }
+
+    printf("%d frames: %s\n", numFrames, isEqual ? "ok" : "FAILED");
+    fflush(stdout);
+
+    return isEqual;
+}
+
+bool Test_GreedyPointMatching::testBestPointMatching()
+{
+    printf("Test_GreedyPointMatching::testBestPointMatching\n");
+
+    const bool resultExact = testBestPointMatching(0.0f);
+    const bool resultNoisy = testBestPointMatching(0.3f);
+
+    return resultExact && resultNoisy;
+}
+
+bool Test_GreedyPointMatching::testBestPointMatching(const float noiseLevel)
+{
+    // second point set is a rotated, shifted and noisy copy of the first
+    // one with additional points
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<float> position(0.0f, 30.0f);
+    std::uniform_real_distribution<float> noise(-noiseLevel, noiseLevel);
+
+    const float angle = 0.3f;
+    std::vector<McVec3f> coords1(15);
+    std::vector<McVec3f> coords2(coords1.size());
+    for ( size_t i=0; i<coords1.size(); ++i )
+    {
+        coords1[i] = McVec3f(position(generator), position(generator), position(generator));
+        coords2[i] = McVec3f(cos(angle) * coords1[i][0] - sin(angle) * coords1[i][1] + 5.0f,
+                             sin(angle) * coords1[i][0] + cos(angle) * coords1[i][1] - 3.0f,
+                             coords1[i][2] + 1.0f);
+        if ( noiseLevel > 0.0f )
+            coords2[i] += McVec3f(noise(generator), noise(generator), noise(generator));
+    }
+    for ( int i=0; i<3; ++i )
+        coords2.push_back(McVec3f(position(generator), position(generator), position(generator)));
+
+    SimplePointRepresentation3d pointRep1(2.0, 1.0);
+    pointRep1.setCoords(coords1);
+
+    SimplePointRepresentation3d pointRep2(2.0, 1.0);
+    pointRep2.setCoords(coords2);
+
+    StartTransformationGenerator3d startTransformationGenerator;
+    startTransformationGenerator.setMinimumCliqueSize(3);
+    startTransformationGenerator.setMaxNumStartTransformations(50);
+
+    std::vector<Transformation> cliqueTransforms;
+    startTransformationGenerator.compute(&pointRep1, &pointRep2, cliqueTransforms);
+
+    // every start transformation appears twice, so that the best score is
+    // reached by at least two of them and the first one has to be kept
+    const int numCliqueTransforms = cliqueTransforms.size();
+    std::vector<Transformation> startTransforms(cliqueTransforms);
+    startTransforms.insert(startTransforms.end(), cliqueTransforms.begin(), cliqueTransforms.end());
+
+    GreedyPointMatchingAlgorithm greedyAlgorithm;
+
+    // one start transformation after another, keeping the first best one
+    int bestStartTransform = -1;
+    PointMatchingDataStruct bestPointMatching;
+    Transformation bestPointRep2Transform;
+    IterativePointMatching iterativePointMatching;
+    for ( size_t i=0; i<startTransforms.size(); ++i )
+    {
+        PointMatchingDataStruct pointMatching;
+        Transformation pointRep2Transform;
+        const bool isValid = iterativePointMatching.computePointMatching(&greedyAlgorithm,
+                                                                         &pointRep1,
+                                                                         &pointRep2,
+                                                                         &startTransforms[i],
+                                                                         &pointMatching,
+                                                                         &pointRep2Transform);
+        if ( isValid && pointMatching.getScore() > bestPointMatching.getScore() )
+        {
+            bestStartTransform = i;
+            bestPointMatching = pointMatching;
+            bestPointRep2Transform = pointRep2Transform;
+        }
+    }
+
+    bool isEqual = ( bestStartTransform >= 0 && bestStartTransform < numCliqueTransforms );
+
+    const int numThreads[] = { 1, 2, 3, 0 };
+    for ( int t=0; t<4; ++t )
+    {
+        PointMatchingDataStruct pointMatching;
+        Transformation pointRep2Transform;
+        const int startTransform = iterativePointMatching.computeBestPointMatching(&greedyAlgorithm,
+                                                                                   &pointRep1,
+                                                                                   &pointRep2,
+                                                                                   startTransforms,
+                                                                                   &pointMatching,
+                                                                                   &pointRep2Transform,
+                                                                                   numThreads[t]);
+
+        isEqual =    isEqual
+                  && startTransform == bestStartTransform
+                  && pointMatching.getRefPoints() == bestPointMatching.getRefPoints()
+                  && pointMatching.getQueryPoints() == bestPointMatching.getQueryPoints()
+                  && pointMatching.getScore() == bestPointMatching.getScore();
+
+        const McMat4f & matrix0 = bestPointRep2Transform.getTransformation3d();
+        const McMat4f & matrix1 = pointRep2Transform.getTransformation3d();
+        for ( int i=0; i<4; ++i )
+            for ( int j=0; j<4; ++j )
+                isEqual = isEqual && matrix0[i][j] == matrix1[i][j];
+    }
+
+    printf("noise %.1f, %d start transformations, best %d, matching size %d: %s\n",
+           noiseLevel,
+           int(startTransforms.size()),
+           bestStartTransform,
+           int(bestPointMatching.getRefPoints().size()),
+           isEqual ? "ok" : "FAILED");
+    fflush(stdout);
+
+    return isEqual;
+}
+
 bool Test_GreedyPointMatching::test(const std::vector< McVec3f > & coords1,
 				   const std::vector< McVec3f > & coords2)
 {
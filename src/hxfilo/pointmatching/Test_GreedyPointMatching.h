@@ -14,6 +14,17 @@ public:
     static bool test4();
     static bool test5();
 
+    /// Compares incremental and non-incremental iterative point matching.
+    static bool testIncremental();
+
+    /// Compares batched matching of consecutive point sets with single matchings.
+    static bool testConsecutive();
+
+    /// Compares the parallel search for the best start transformation
+    /// with processing the start transformations one after another.
+    static bool testBestPointMatching();
+    static bool testBestPointMatching(const float noiseLevel);
+
     static bool test(const std::vector< McVec3f > & coords1,
 		     const std::vector< McVec3f > & coords2);
 };
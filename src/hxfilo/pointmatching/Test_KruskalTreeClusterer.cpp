@@ -0,0 +1,139 @@
+#include "hxgraphalgorithms/KruskalTreeClusterer.h"
+#include "Test_KruskalTreeClusterer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Weight of a minimum spanning forest with Prim's algorithm on the dense
+// weight matrix, using only edges with weight <= maxWeight.
+void computeReferenceForest(const int numNodes,
+                            const std::vector<Edge *> & edges,
+                            const double maxWeight,
+                            double & forestWeight,
+                            int & numForestEdges)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    std::vector<std::vector<double> > weights(numNodes, std::vector<double>(numNodes, infinity));
+    for ( size_t i=0; i<edges.size(); ++i )
+    {
+        const int from = edges[i]->from->index;
+        const int to = edges[i]->to->index;
+        if ( from == to || edges[i]->weight > maxWeight )
+            continue;
+        if ( edges[i]->weight < weights[from][to] )
+            weights[from][to] = weights[to][from] = edges[i]->weight;
+    }
+
+    forestWeight = 0.0;
+    numForestEdges = 0;
+
+    std::vector<bool> isInForest(numNodes, false);
+    std::vector<double> distance(numNodes, infinity);
+    for ( int start=0; start<numNodes; ++start )
+    {
+        if ( isInForest[start] )
+            continue;
+
+        // grow the tree containing start
+        distance[start] = 0.0;
+        while ( true )
+        {
+            int next = -1;
+            for ( int n=0; n<numNodes; ++n )
+            {
+                if ( !isInForest[n] && distance[n] < infinity && ( next < 0 || distance[n] < distance[next] ) )
+                    next = n;
+            }
+            if ( next < 0 )
+                break;
+
+            isInForest[next] = true;
+            if ( next != start )
+            {
+                forestWeight += distance[next];
+                ++numForestEdges;
+            }
+
+            for ( int n=0; n<numNodes; ++n )
+            {
+                if ( !isInForest[n] && weights[next][n] < distance[n] )
+                    distance[n] = weights[next][n];
+            }
+        }
+    }
+}
+
+}
+
+bool Test_KruskalTreeClusterer::test1()
+{
+    printf("Test_KruskalTreeClusterer::test1\n");
+
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    return ( test(10, 20, infinity) &&
+             test(50, 40, infinity) &&
+             test(100, 1000, infinity) &&
+             test(100, 1000, 0.3) &&
+             test(300, 3000, 0.2) );
+}
+
+bool Test_KruskalTreeClusterer::test(const int numNodes,
+                                     const int numEdges,
+                                     const double maxWeight)
+{
+    std::mt19937 generator(numNodes + numEdges);
+    std::uniform_real_distribution<double> value(0.0, 1.0);
+    std::uniform_int_distribution<int> node(0, numNodes - 1);
+
+    std::vector<Node *> nodes(numNodes);
+    for ( int n=0; n<numNodes; ++n )
+    {
+        std::vector<double> values(3);
+        for ( size_t v=0; v<values.size(); ++v )
+            values[v] = value(generator);
+        nodes[n] = new Node(n, 0, n, values);
+    }
+
+    std::vector<Edge *> edges(numEdges);
+    for ( int e=0; e<numEdges; ++e )
+        edges[e] = new Edge(nodes[node(generator)], nodes[node(generator)]);
+
+    const std::vector<Edge *> forest =
+        KruskalTreeClusterer::computeMinimalSpanningForest(edges, maxWeight);
+
+    double forestWeight = 0.0;
+    for ( size_t e=0; e<forest.size(); ++e )
+        forestWeight += forest[e]->weight;
+
+    double referenceWeight = 0.0;
+    int numReferenceEdges = 0;
+    computeReferenceForest(numNodes, edges, maxWeight, referenceWeight, numReferenceEdges);
+
+    bool isSorted = true;
+    for ( size_t e=1; e<forest.size(); ++e )
+        isSorted = isSorted && ( forest[e-1]->weight <= forest[e]->weight );
+
+    const bool result = ( isSorted &&
+                          int(forest.size()) == numReferenceEdges &&
+                          std::fabs(forestWeight - referenceWeight) < 1.0e-9 * (1.0 + referenceWeight) );
+
+    printf("%d nodes, %d edges: %d forest edges, weight %f (reference %f) %s\n",
+           numNodes, numEdges, int(forest.size()), forestWeight, referenceWeight,
+           result ? "ok" : "FAILED");
+    fflush(stdout);
+
+    for ( int e=0; e<numEdges; ++e )
+        delete edges[e];
+    for ( int n=0; n<numNodes; ++n )
+        delete nodes[n];
+
+    return result;
+}
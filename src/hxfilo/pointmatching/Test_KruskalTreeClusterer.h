@@ -0,0 +1,14 @@
+#ifndef TEST_KRUSKAL_TREE_CLUSTERER_H
+#define TEST_KRUSKAL_TREE_CLUSTERER_H
+
+class Test_KruskalTreeClusterer
+{
+public:
+    static bool test1();
+
+    static bool test(const int numNodes,
+                     const int numEdges,
+                     const double maxWeight);
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "hxgraphalgorithms/McMinCostBipartiteMatching.h"
+#include "Test_MinCostBipartiteMatching.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Minimum cost of a matching of each cardinality, by enumerating all
+// matchings of the dense cost matrix. Missing edges have infinite cost.
+void enumerateMatchings(const std::vector<std::vector<double> > & costs,
+                        const int vertex1,
+                        std::vector<bool> & isMatched2,
+                        const int cardinality,
+                        const double cost,
+                        std::vector<double> & minCosts)
+{
+    if ( cost < minCosts[cardinality] )
+        minCosts[cardinality] = cost;
+
+    if ( vertex1 == int(costs.size()) )
+        return;
+
+    enumerateMatchings(costs, vertex1 + 1, isMatched2, cardinality, cost, minCosts);
+
+    for ( size_t v2=0; v2<isMatched2.size(); ++v2 )
+    {
+        if ( isMatched2[v2] || std::isinf(costs[vertex1][v2]) )
+            continue;
+
+        isMatched2[v2] = true;
+        enumerateMatchings(costs, vertex1 + 1, isMatched2, cardinality + 1, cost + costs[vertex1][v2], minCosts);
+        isMatched2[v2] = false;
+    }
+}
+
+// Checks that the matching only uses edges of the graph, that no vertex
+// is matched twice, that it is ordered by vertex of the first set and
+// that its cost is the sum of its edge costs.
+bool isValidMatching(const std::vector<std::vector<double> > & costs,
+                     const std::vector<int> & vertices1,
+                     const std::vector<int> & vertices2,
+                     const double matchingCost)
+{
+    if ( vertices1.size() != vertices2.size() )
+        return false;
+
+    std::vector<bool> isMatched2(costs.empty() ? 0 : costs[0].size(), false);
+    double cost = 0.0;
+    for ( size_t i=0; i<vertices1.size(); ++i )
+    {
+        if ( i > 0 && vertices1[i-1] >= vertices1[i] )
+            return false;
+        if ( isMatched2[vertices2[i]] || std::isinf(costs[vertices1[i]][vertices2[i]]) )
+            return false;
+        isMatched2[vertices2[i]] = true;
+        cost += costs[vertices1[i]][vertices2[i]];
+    }
+
+    return ( std::fabs(cost - matchingCost) < 1.0e-9 );
+}
+
+}
+
+bool Test_MinCostBipartiteMatching::test1()
+{
+    printf("Test_MinCostBipartiteMatching::test1\n");
+
+    return ( test(10000, 0.0) &&
+             test(10000, -1.0) );
+}
+
+// Compares the matchings of all cardinalities on random sparse graphs with
+// up to 6 vertices in each set against exhaustive enumeration.
+bool Test_MinCostBipartiteMatching::test(const int numGraphs,
+                                         const double minCost)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    std::mt19937 generator(numGraphs + int(minCost));
+    std::uniform_int_distribution<int> numVertices(1, 6);
+    std::uniform_real_distribution<double> edgeProbability(0.0, 1.0);
+    std::uniform_real_distribution<double> value(minCost, 1.0);
+
+    int numFailed = 0;
+    for ( int g=0; g<numGraphs; ++g )
+    {
+        const int numVertices1 = numVertices(generator);
+        const int numVertices2 = numVertices(generator);
+        const double density = edgeProbability(generator);
+
+        McMinCostBipartiteMatching matching;
+        matching.init(numVertices1, numVertices2);
+
+        std::vector<std::vector<double> > costs(numVertices1, std::vector<double>(numVertices2, infinity));
+        for ( int v1=0; v1<numVertices1; ++v1 )
+        {
+            for ( int v2=0; v2<numVertices2; ++v2 )
+            {
+                if ( edgeProbability(generator) < density )
+                {
+                    costs[v1][v2] = value(generator);
+                    matching.addEdge(v1, v2, costs[v1][v2]);
+                }
+            }
+        }
+
+        std::vector<double> minCosts(std::min(numVertices1, numVertices2) + 1, infinity);
+        std::vector<bool> isMatched2(numVertices2, false);
+        enumerateMatchings(costs, 0, isMatched2, 0, 0.0, minCosts);
+
+        int maxCardinality = 0;
+        while ( maxCardinality + 1 < int(minCosts.size()) && !std::isinf(minCosts[maxCardinality + 1]) )
+            ++maxCardinality;
+
+        bool result = true;
+        std::vector<int> vertices1;
+        std::vector<int> vertices2;
+        for ( int k=1; k<=maxCardinality; ++k )
+        {
+            if ( !matching.augment() )
+            {
+                result = false;
+                break;
+            }
+
+            matching.getMatching(vertices1, vertices2);
+            result = ( result &&
+                       matching.getCardinality() == k &&
+                       int(vertices1.size()) == k &&
+                       std::fabs(matching.getCost() - minCosts[k]) < 1.0e-9 &&
+                       isValidMatching(costs, vertices1, vertices2, matching.getCost()) );
+        }
+
+        // The matching has maximum cardinality now and must not change.
+        const double cost = matching.getCost();
+        result = ( result &&
+                   !matching.augment() &&
+                   matching.getCardinality() == maxCardinality &&
+                   matching.getCost() == cost );
+
+        if ( !result )
+            ++numFailed;
+    }
+
+    const bool result = ( numFailed == 0 );
+
+    printf("%d graphs, costs in [%.0f, 1]: %d failed %s\n",
+           numGraphs, minCost, numFailed, result ? "ok" : "FAILED");
+    fflush(stdout);
+
+    return result;
+}
@@ -0,0 +1,13 @@
+#ifndef TEST_MIN_COST_BIPARTITE_MATCHING_H
+#define TEST_MIN_COST_BIPARTITE_MATCHING_H
+
+class Test_MinCostBipartiteMatching
+{
+public:
+    static bool test1();
+
+    static bool test(const int numGraphs,
+                     const double minCost);
+};
+
+#endif
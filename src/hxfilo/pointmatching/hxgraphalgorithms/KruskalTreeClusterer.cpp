@@ -3,16 +3,26 @@
 #include <algorithm>
 
 
-//(McVec3f const & one, McVec3f const & two)
-inline int compareEdges(Edge * const & one, Edge * const & two) 
+// orders edges by weight
+inline bool hasSmallerWeight(const Edge * one, const Edge * two) 
 {    
-	if(one->weight<two->weight) return -1;
-    if(one->weight>two->weight) return 1;
-    else return 0;
+	return one->weight < two->weight;
+}
+
+// number of nodes needed to store the nodes of the edges by index
+inline int getNumNodes(const std::vector<Edge *> & edges) 
+{
+	int numNodes = 0;
+	for(size_t i=0; i<edges.size(); i++) {
+		numNodes = std::max(numNodes, edges[i]->from->index + 1);
+		numNodes = std::max(numNodes, edges[i]->to->index + 1);
+	}
+
+	return numNodes;
 }
 //////////////////////////////////////////////////////////////////////////////////////////
 // Die Hauptfunktion welche ein Bild erhaelt und es segmentiert
-std::vector<std::vector<int> > KruskalTreeClusterer::clusterGraph(std::vector<std::vector<Node *> > theNodes, std::vector<Edge *> theEdges) {
+std::vector<std::vector<int> > KruskalTreeClusterer::clusterGraph(const std::vector<std::vector<Node *> > & theNodes, const std::vector<Edge *> & theEdges) {
     size_t i;
 	// Graphen segmentieren
 	std::vector<TreeList *> result = getMinimalSpanningTree(theEdges);
@@ -42,20 +52,21 @@ std::vector<std::vector<int> > KruskalTreeClusterer::clusterGraph(std::vector<st
 
 			ret[x][y] = i+1;
 		}
+
+		delete tree;
 	}				
 
 	return ret;
 }
 //////////////////////////////////////////////////////////////////////////////////////////
-std::vector<TreeList *> KruskalTreeClusterer::getMinimalSpanningTree(std::vector<Edge *> edges) {
+std::vector<TreeList *> KruskalTreeClusterer::getMinimalSpanningTree(const std::vector<Edge *> & edges) {
 
-    size_t i=0;
-	// erste Mal Menge aller Kanten dem Gewicht nach sortieren
-	//sortEdges(edges);		
-    std::sort(edges.begin(), edges.end());
+	std::vector<TreeList *> trees;
+	if(edges.empty()) 
+		return trees;
 
 	double sum =0;
-	for(i=0; i<edges.size();i++) {		
+	for(size_t i=0; i<edges.size();i++) {		
 		sum += edges[i]->weight;
 	}
 
@@ -64,12 +75,15 @@ std::vector<TreeList *> KruskalTreeClusterer::getMinimalSpanningTree(std::vector
 	splitter = sum*3.0/4.0;	
 
 	// Kruskalalgorithmus ausfuehren
-	std::vector<TreeList *> trees = spanTree(edges);							
+	std::vector<Edge *> forest = computeMinimalSpanningForest(edges, splitter);
+	std::vector<TreeList *> allTrees = spanTree(forest);
 
-	// mutig aber richtig!		
-	for(i=trees.size()-1; i>=0; i--) {
-		if(trees[i]->depth < 5) {			
-            trees.erase(trees.begin() + i);
+	// only keep trees with at least 5 edges
+	for(size_t i=0; i<allTrees.size(); i++) {
+		if(allTrees[i]->depth < 5) {			
+			delete allTrees[i];
+		} else {
+			trees.push_back(allTrees[i]);
 		}
 	}	
 
@@ -77,85 +91,86 @@ std::vector<TreeList *> KruskalTreeClusterer::getMinimalSpanningTree(std::vector
 }
 //////////////////////////////////////////////////////////////////////////////////////////
 // fuehrt den Algorithmus von Kruskal aus
-std::vector<TreeList *> KruskalTreeClusterer::spanTree(std::vector<Edge *> edges) {
-	// hier werden alle bisherigen Baeume gespeichert
-	// dieser Vektor muesste am Ende des Algorithmus nur noch ein Element
-	// haben, der letztendliche Baum
-	std::vector<TreeList *> tmpTrees;
-
-	// die Baeume der from und to Knoten der aktuellen Kante
-	TreeList * fromTree;
-	TreeList * toTree;		
-    for(size_t i=0; i<edges.size(); i++) {
-		//	System.out.print("-"+i);
-		if(edges[i]->weight>splitter) 
-			break;
-
-		// die Baeume zu denen beide Kantenpunkte hinzugehoeren
-		int idxFrom = getIndexOfNode(tmpTrees, edges[i]->from);
-		int idxTo = getIndexOfNode(tmpTrees, edges[i]->to);		
-
-		// union-find machen
-		if(idxFrom!=idxTo) {				
-			if(idxFrom == -1) {
-				// idxFrom = -1 also idxTo nicht 0, nur addEdge an ToBaum
-				toTree = tmpTrees[idxTo];
-				toTree->appendEdge(edges[i]);
-			} else if(idxTo == -1) {
-				// idxTo = -1 also idxfrom nicht 0, nur addEdge an FromBaum
-				fromTree = tmpTrees[idxFrom];
-				fromTree->appendEdge(edges[i]);					
-			} else {
-				// groesseren Baum suchen, daran den anderen ranhaengen
-				// und diesen anschliessend aus dem Vector entfernen
-				fromTree = tmpTrees[idxFrom];										
-				toTree = tmpTrees[idxTo];
-
-				if(fromTree->depth>toTree->depth) {
-					fromTree->joinTrees(toTree);
-                    tmpTrees.erase(tmpTrees.begin() + idxTo);
-				} else {
-					toTree->joinTrees(fromTree);
-                    tmpTrees.erase(tmpTrees.begin() + idxFrom);
-				}					
-			}
-		} else {
-			// beide haben den selben Index, nun noch pruefen ob beide neu sind
-			// oder ob beide im gleichen Baum sind								
-			if(idxFrom==-1) {
-				// beide sind neu, also neuen TreeList initiieren
-				TreeList * newList = new TreeList(edges[i]);
-                tmpTrees.push_back(newList);
-			} else {
-				// beide gehoeren zum selben Baum, also diesen Knoten nicht
-				// hinzunehmen ==> nichts machen
-			}
-		}						
+std::vector<Edge *> KruskalTreeClusterer::computeMinimalSpanningForest(const std::vector<Edge *> & edges, const double maxWeight) {
+
+	std::vector<Edge *> sortedEdges;
+	sortedEdges.reserve(edges.size());
+	for(size_t i=0; i<edges.size(); i++) {
+		if(edges[i]->weight <= maxWeight) 
+			sortedEdges.push_back(edges[i]);
 	}
 
-	return tmpTrees;
+	// Menge aller Kanten dem Gewicht nach sortieren
+	std::stable_sort(sortedEdges.begin(), sortedEdges.end(), hasSmallerWeight);
+
+	// union-find, each node is a tree of its own in the beginning
+	const int numNodes = getNumNodes(sortedEdges);
+	std::vector<int> parent(numNodes);
+	std::vector<int> treeSize(numNodes, 1);
+	for(int n=0; n<numNodes; n++) {
+		parent[n] = n;
+	}
+
+	std::vector<Edge *> forest;
+	for(size_t i=0; i<sortedEdges.size(); i++) {
+		int rootFrom = findRoot(parent, sortedEdges[i]->from->index);
+		int rootTo = findRoot(parent, sortedEdges[i]->to->index);
+
+		// beide gehoeren zum selben Baum, also diese Kante nicht hinzunehmen
+		if(rootFrom == rootTo) 
+			continue;
+
+		// kleineren Baum an den groesseren haengen
+		if(treeSize[rootFrom] < treeSize[rootTo]) 
+			std::swap(rootFrom, rootTo);
+		parent[rootTo] = rootFrom;
+		treeSize[rootFrom] += treeSize[rootTo];
+
+		forest.push_back(sortedEdges[i]);
+	}
+
+	return forest;
 }
 //////////////////////////////////////////////////////////////////////////////////////////
-// sucht in allen bisherigen Baeumen ob dieser Knoten darin vorkam und gibt
-// den Index des Baumes zurueck bei dem es vorkam
-int KruskalTreeClusterer::getIndexOfNode(std::vector<TreeList *> tmpTrees, Node * n) {	
-    for(size_t i=0; i<tmpTrees.size(); i++) {
-		if(findEdge(tmpTrees[i], n)==1) {			
-			return i;
+// teilt den Wald in seine Baeume auf
+std::vector<TreeList *> KruskalTreeClusterer::spanTree(const std::vector<Edge *> & forestEdges) {
+
+	const int numNodes = getNumNodes(forestEdges);
+	std::vector<int> parent(numNodes);
+	for(int n=0; n<numNodes; n++) {
+		parent[n] = n;
+	}
+
+	for(size_t i=0; i<forestEdges.size(); i++) {
+		const int rootFrom = findRoot(parent, forestEdges[i]->from->index);
+		const int rootTo = findRoot(parent, forestEdges[i]->to->index);
+		parent[rootTo] = rootFrom;
+	}
+
+	// hier werden alle Baeume gespeichert, in der Reihenfolge ihrer leichtesten Kante
+	std::vector<TreeList *> trees;
+	std::vector<int> treeOfRoot(numNodes, -1);
+	for(size_t i=0; i<forestEdges.size(); i++) {
+		const int root = findRoot(parent, forestEdges[i]->from->index);
+		if(treeOfRoot[root] == -1) {
+			treeOfRoot[root] = trees.size();
+			trees.push_back(new TreeList(forestEdges[i]));
+		} else {
+			trees[treeOfRoot[root]]->appendEdge(forestEdges[i]);
 		}
 	}
 
-	return -1;
+	return trees;
 }
 //////////////////////////////////////////////////////////////////////////////////////////
-// sucht in einem Baum ob der Knoten darin vorkommt
-int KruskalTreeClusterer::findEdge(TreeList * tList, Node * n) {
-    for(size_t i=0; i<tList->indices.size(); i++) {
-		if(n->index==tList->indices[i])
-			return 1;
+// sucht die Wurzel des Baumes, in dem der Knoten liegt
+int KruskalTreeClusterer::findRoot(std::vector<int> & parent, int node) {	
+	while(parent[node] != node) {
+		parent[node] = parent[parent[node]];
+		node = parent[node];
 	}
 
-	return -1;
+	return node;
 }			
 
 
@@ -13,7 +13,14 @@ class HXGRAPHALGORITHMS_API KruskalTreeClusterer {
 public:
 	// Main function: returning for each node a id of its cluster (-1 if not clustered)
 	// theNodes and theEdges dexcribing the graph to be clustered
-	std::vector<std::vector<int> > clusterGraph(std::vector<std::vector<Node *> > theNodes, std::vector<Edge *> theEdges);
+	std::vector<std::vector<int> > clusterGraph(const std::vector<std::vector<Node *> > & theNodes, const std::vector<Edge *> & theEdges);
+
+	// Computes a minimum spanning forest of the graph given by edges with Kruskal's
+	// algorithm, using only edges with a weight <= maxWeight. The edges are sorted by
+	// weight once (equal weights keep their order) and the trees are kept in a
+	// union-find structure, so that the running time is O(E log E).
+	// Returns the edges of the forest in the order of increasing weight.
+	static std::vector<Edge *> computeMinimalSpanningForest(const std::vector<Edge *> & edges, const double maxWeight);
 
 private:
 
@@ -21,17 +28,13 @@ private:
 	double splitter;
 
 	// Kruskal Tree Clustering Algorithm
-	std::vector<TreeList *> getMinimalSpanningTree(std::vector<Edge *> edges);
-
-	// fuehrt den Algorithmus von Kruskal aus
-	std::vector<TreeList *> spanTree(std::vector<Edge *> edges);
+	std::vector<TreeList *> getMinimalSpanningTree(const std::vector<Edge *> & edges);
 
-	// sucht in allen bisherigen Baeumen ob dieser Knoten darin vorkam und gibt
-	// den Index des Baumes zurueck bei dem es vorkam
-	int getIndexOfNode(std::vector<TreeList *> tmpTrees, Node * n);
+	// splits the spanning forest into its trees, ordered by their lightest edge
+	std::vector<TreeList *> spanTree(const std::vector<Edge *> & forestEdges);
 
-	// sucht in einem Baum ob der Knoten darin vorkommt
-	int findEdge(TreeList * tList, Node * n);
+	// root of the tree containing node, with path halving
+	static int findRoot(std::vector<int> & parent, int node);
 };
 
 
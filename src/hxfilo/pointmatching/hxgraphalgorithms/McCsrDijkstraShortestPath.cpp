@@ -0,0 +1,236 @@
+#include "McCsrDijkstraShortestPath.h"
+
+#include <algorithm>
+
+McCsrDijkstraShortestPath::McCsrDijkstraShortestPath()
+{
+    m_numVertices = 0;
+    m_generation = 0;
+}
+
+void McCsrDijkstraShortestPath::setGraph(const int                   numVertices,
+                                         const std::vector<int>    & startVertices,
+                                         const std::vector<int>    & endVertices,
+                                         const std::vector<double> & edgeLengths)
+{
+    const int numEdges = startVertices.size();
+
+    m_numVertices = numVertices;
+
+    // sort edges by start vertex, keeping their order
+    m_firstEdge.assign(numVertices + 1, 0);
+    for ( int e=0; e<numEdges; e++ )
+        m_firstEdge[startVertices[e] + 1]++;
+    for ( int u=0; u<numVertices; u++ )
+        m_firstEdge[u + 1] += m_firstEdge[u];
+
+    m_edgeEndVertex.resize(numEdges);
+    m_edgeLength.resize(numEdges);
+    m_edgeId.resize(numEdges);
+
+    std::vector<int> nextEdge(m_firstEdge.begin(), m_firstEdge.end() - 1);
+    for ( int e=0; e<numEdges; e++ ) {
+        const int sortedEdge = nextEdge[startVertices[e]]++;
+        m_edgeEndVertex[sortedEdge] = endVertices[e];
+        m_edgeLength[sortedEdge] = edgeLengths[e];
+        m_edgeId[sortedEdge] = e;
+    }
+
+    m_generation = 0;
+    m_generationOfVertex.assign(numVertices, 0);
+    m_distance.resize(numVertices);
+    m_predEdge.resize(numVertices);
+    m_heapPos.resize(numVertices);
+    m_heap.clear();
+}
+
+int McCsrDijkstraShortestPath::getNumVertices() const
+{
+    return m_numVertices;
+}
+
+bool McCsrDijkstraShortestPath::computeOneToOne(const int s, const int t)
+{
+    startQuery(s);
+
+    while ( !m_heap.empty() ) {
+        const int u = heapPop();
+        if ( u == t ) {
+            // end vertex has been reached, i.e., shortest path has
+            // been found
+            return true;
+        }
+
+        relaxEdges(u);
+    }
+
+    return false;
+}
+
+void McCsrDijkstraShortestPath::computeOneToAll(const int s)
+{
+    startQuery(s);
+
+    while ( !m_heap.empty() ) {
+        relaxEdges(heapPop());
+    }
+}
+
+double McCsrDijkstraShortestPath::getDistance(const int v) const
+{
+    if ( !isReached(v) )
+        return -1.0;
+
+    return m_distance[v];
+}
+
+int McCsrDijkstraShortestPath::getPredEdge(const int v) const
+{
+    if ( !isReached(v) || m_predEdge[v] < 0 )
+        return -1;
+
+    return m_edgeId[m_predEdge[v]];
+}
+
+bool McCsrDijkstraShortestPath::getPath(const int t, std::vector<int> & path) const
+{
+    path.clear();
+
+    if ( !isReached(t) )
+        return false;
+
+    // the start vertex of a sorted edge is found by binary search
+    int v = t;
+    path.push_back(v);
+    while ( m_predEdge[v] >= 0 ) {
+        const int e = m_predEdge[v];
+        v = std::upper_bound(m_firstEdge.begin(), m_firstEdge.end(), e) - m_firstEdge.begin() - 1;
+        path.push_back(v);
+    }
+    std::reverse(path.begin(), path.end());
+
+    return true;
+}
+
+void McCsrDijkstraShortestPath::startQuery(const int s)
+{
+    // Invalidate the data of all vertices by starting a new generation.
+    // Only when the counter wraps around, the data has to be reset.
+    m_generation++;
+    if ( m_generation == 0 ) {
+        std::fill(m_generationOfVertex.begin(), m_generationOfVertex.end(), 0);
+        m_generation = 1;
+    }
+
+    m_heap.clear();
+
+    m_generationOfVertex[s] = m_generation;
+    m_distance[s] = 0.0;
+    m_predEdge[s] = -1;
+    heapPush(s);
+}
+
+void McCsrDijkstraShortestPath::relaxEdges(const int u)
+{
+    const double distance = m_distance[u];
+
+    // iterate over all edges leaving vertex u
+    for ( int e=m_firstEdge[u]; e<m_firstEdge[u + 1]; e++ ) {
+        const int v = m_edgeEndVertex[e];
+        const double newDistance = distance + m_edgeLength[e];
+
+        if ( !isReached(v) ) {
+            // v is reached for the first time
+            m_generationOfVertex[v] = m_generation;
+            m_distance[v] = newDistance;
+            m_predEdge[v] = e;
+            heapPush(v);
+        }
+        else if ( m_heapPos[v] >= 0 && newDistance < m_distance[v] ) {
+            // v is still in the heap and newDistance is shorter
+            m_distance[v] = newDistance;
+            m_predEdge[v] = e;
+            heapDecreaseKey(v);
+        }
+    }
+}
+
+void McCsrDijkstraShortestPath::heapPush(const int v)
+{
+    m_heapPos[v] = m_heap.size();
+    m_heap.push_back(v);
+    heapSiftUp(m_heap.size() - 1);
+}
+
+int McCsrDijkstraShortestPath::heapPop()
+{
+    const int minVertex = m_heap[0];
+    m_heapPos[minVertex] = -1;
+
+    const int lastVertex = m_heap.back();
+    m_heap.pop_back();
+    if ( !m_heap.empty() ) {
+        m_heap[0] = lastVertex;
+        m_heapPos[lastVertex] = 0;
+        heapSiftDown(0);
+    }
+
+    return minVertex;
+}
+
+void McCsrDijkstraShortestPath::heapDecreaseKey(const int v)
+{
+    heapSiftUp(m_heapPos[v]);
+}
+
+void McCsrDijkstraShortestPath::heapSiftUp(int pos)
+{
+    const int v = m_heap[pos];
+    const double distance = m_distance[v];
+
+    while ( pos > 0 ) {
+        const int parentPos = (pos - 1) / 4;
+        const int parent = m_heap[parentPos];
+        if ( !(distance < m_distance[parent]) )
+            break;
+
+        m_heap[pos] = parent;
+        m_heapPos[parent] = pos;
+        pos = parentPos;
+    }
+
+    m_heap[pos] = v;
+    m_heapPos[v] = pos;
+}
+
+void McCsrDijkstraShortestPath::heapSiftDown(int pos)
+{
+    const int heapSize = m_heap.size();
+    const int v = m_heap[pos];
+    const double distance = m_distance[v];
+
+    while ( true ) {
+        const int firstChildPos = 4 * pos + 1;
+        if ( firstChildPos >= heapSize )
+            break;
+
+        // smallest of up to 4 children
+        const int lastChildPos = std::min(firstChildPos + 4, heapSize);
+        int minChildPos = firstChildPos;
+        for ( int c=firstChildPos + 1; c<lastChildPos; c++ ) {
+            if ( m_distance[m_heap[c]] < m_distance[m_heap[minChildPos]] )
+                minChildPos = c;
+        }
+
+        const int minChild = m_heap[minChildPos];
+        if ( !(m_distance[minChild] < distance) )
+            break;
+
+        m_heap[pos] = minChild;
+        m_heapPos[minChild] = pos;
+        pos = minChildPos;
+    }
+
+    m_heap[pos] = v;
+    m_heapPos[v] = pos;
+}
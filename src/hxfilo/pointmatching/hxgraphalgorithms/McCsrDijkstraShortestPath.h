@@ -0,0 +1,100 @@
+#ifndef MC_CSR_DIJKSTRA_SHORTEST_PATH_H
+#define MC_CSR_DIJKSTRA_SHORTEST_PATH_H
+
+#include "api.h"
+
+#include <vector>
+
+/**
+    The class @c McCsrDijkstraShortestPath computes shortest paths in a
+    directed graph with non-negative edge lengths, like
+    @c McDijkstraShortestPath, but is meant for many queries on the
+    same graph.
+
+    The outgoing edges of all vertices are stored in one array, sorted
+    by start vertex (compressed sparse rows). The vertices that have
+    been reached but not settled are kept in a 4-ary heap that supports
+    decreasing the distance of a vertex. The distances and predecessor
+    edges are not reset before each query. Instead, each query gets a
+    new generation number, and the data of a vertex is only valid if it
+    was written in the current generation. A one-to-one query therefore
+    only pays for the vertices it touches before reaching the target.
+
+    Edges are numbered in the order in which they are passed to
+    @c setGraph. The shortest path to a vertex @c v is given implicitly
+    by its predecessor edge @c getPredEdge(v).
+*/
+class HXGRAPHALGORITHMS_API McCsrDijkstraShortestPath {
+public:
+    McCsrDijkstraShortestPath();
+
+    /** Sets the graph with @c numVertices vertices and the directed
+        edges from @c startVertices[i] to @c endVertices[i] with length
+        @c edgeLengths[i]. All lengths must be non-negative. */
+    void setGraph(const int                   numVertices,
+                  const std::vector<int>    & startVertices,
+                  const std::vector<int>    & endVertices,
+                  const std::vector<double> & edgeLengths);
+
+    int getNumVertices() const;
+
+    /** Computes the shortest path from vertex @c s to vertex @c t.
+        Stops as soon as @c t is reached. Returns false if there is no
+        path from @c s to @c t. */
+    bool computeOneToOne(const int s, const int t);
+
+    /** Computes the shortest paths from vertex @c s to all vertices
+        reachable from @c s. */
+    void computeOneToAll(const int s);
+
+    /** Returns the distance of vertex @c v from the start vertex of
+        the last query, or a negative value if @c v has not been
+        reached. After a one-to-one query, only the distances of the
+        target vertex and of the vertices closer than the target are
+        final. */
+    double getDistance(const int v) const;
+
+    /** Returns the index of the last edge on the shortest path to
+        vertex @c v, or -1 if @c v is the start vertex or has not been
+        reached. */
+    int getPredEdge(const int v) const;
+
+    /** Returns the vertices of the shortest path from the start vertex
+        of the last query to vertex @c t, beginning with the start
+        vertex. Returns false if @c t has not been reached. */
+    bool getPath(const int t, std::vector<int> & path) const;
+
+private:
+    void startQuery(const int s);
+    void relaxEdges(const int u);
+
+    bool isReached(const int v) const
+    { return (m_generationOfVertex[v] == m_generation); }
+
+    // 4-ary heap of vertices, ordered by distance
+    void heapPush(const int v);
+    int  heapPop();
+    void heapDecreaseKey(const int v);
+    void heapSiftUp(int pos);
+    void heapSiftDown(int pos);
+
+    int m_numVertices;
+
+    // Graph, outgoing edges of vertex u are m_firstEdge[u] to m_firstEdge[u+1]-1
+    std::vector<int>    m_firstEdge;
+    std::vector<int>    m_edgeEndVertex;
+    std::vector<double> m_edgeLength;
+    std::vector<int>    m_edgeId;
+
+    // Query data, only valid for a vertex if its generation is current
+    unsigned int              m_generation;
+    std::vector<unsigned int> m_generationOfVertex;
+    std::vector<double>       m_distance;
+    std::vector<int>          m_predEdge;
+
+    // Position of a reached vertex in the heap, -1 if it has been settled
+    std::vector<int>    m_heapPos;
+    std::vector<int>    m_heap;
+};
+
+#endif
@@ -72,6 +72,9 @@ public:
 
     The implementation of the algorithms is based on the book
     "Algorithmic graph theory" by James A. McHugh.
+
+    Both functions reset all vertices before each run. For repeated
+    queries on the same graph, @c McCsrDijkstraShortestPath is faster.
 */
 class HXGRAPHALGORITHMS_API McDijkstraShortestPath {
 public:
@@ -0,0 +1,242 @@
+#include "McMinCostBipartiteMatching.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+McMinCostBipartiteMatching::McMinCostBipartiteMatching()
+{
+    init(0, 0);
+}
+
+void McMinCostBipartiteMatching::init(const int numVertices1,
+                                      const int numVertices2)
+{
+    m_numVertices1 = numVertices1;
+    m_numVertices2 = numVertices2;
+
+    m_edgeVertex1.clear();
+    m_edgeVertex2.clear();
+    m_edgeCost.clear();
+    m_firstEdge.clear();
+
+    m_matchedEdge1.assign(numVertices1, -1);
+    m_matchedEdge2.assign(numVertices2, -1);
+    m_cardinality = 0;
+
+    m_needsInitialization = true;
+}
+
+void McMinCostBipartiteMatching::addEdge(const int vertex1,
+                                         const int vertex2,
+                                         const double cost)
+{
+    m_edgeVertex1.push_back(vertex1);
+    m_edgeVertex2.push_back(vertex2);
+    m_edgeCost.push_back(cost);
+
+    m_needsInitialization = true;
+}
+
+void McMinCostBipartiteMatching::initPotentials()
+{
+    const int numEdges = m_edgeCost.size();
+
+    // sort edges by vertex of the first set, keeping the order in which
+    // they were added
+    m_firstEdge.assign(m_numVertices1 + 1, 0);
+    for ( int e=0; e<numEdges; e++ )
+        m_firstEdge[m_edgeVertex1[e] + 1]++;
+    for ( int i=0; i<m_numVertices1; i++ )
+        m_firstEdge[i + 1] += m_firstEdge[i];
+
+    std::vector<int> nextEdge(m_firstEdge.begin(), m_firstEdge.end() - 1);
+    std::vector<int> edgeVertex2(numEdges);
+    std::vector<double> edgeCost(numEdges);
+    for ( int e=0; e<numEdges; e++ ) {
+        const int sortedEdge = nextEdge[m_edgeVertex1[e]]++;
+        edgeVertex2[sortedEdge] = m_edgeVertex2[e];
+        edgeCost[sortedEdge] = m_edgeCost[e];
+    }
+    m_edgeVertex2.swap(edgeVertex2);
+    m_edgeCost.swap(edgeCost);
+    for ( int i=0; i<m_numVertices1; i++ )
+        for ( int e=m_firstEdge[i]; e<m_firstEdge[i + 1]; e++ )
+            m_edgeVertex1[e] = i;
+
+    // The source vertex has potential 0 and is connected to the vertices
+    // of the first set with cost 0, the vertices of the second set are
+    // connected to the terminal vertex with cost 0. The potentials
+    // below make all reduced costs non-negative.
+    m_potential1.assign(m_numVertices1, 0.0);
+    m_potential2.assign(m_numVertices2, 0.0);
+    for ( int e=0; e<numEdges; e++ )
+        m_potential2[m_edgeVertex2[e]] = std::min(m_potential2[m_edgeVertex2[e]], m_edgeCost[e]);
+
+    m_terminalPotential = 0.0;
+    for ( int j=0; j<m_numVertices2; j++ )
+        m_terminalPotential = std::min(m_terminalPotential, m_potential2[j]);
+
+    m_matchedEdge1.assign(m_numVertices1, -1);
+    m_matchedEdge2.assign(m_numVertices2, -1);
+    m_cardinality = 0;
+
+    m_needsInitialization = false;
+}
+
+bool McMinCostBipartiteMatching::augment()
+{
+    if ( m_needsInitialization )
+        initPotentials();
+
+    const double infinity = std::numeric_limits<double>::max();
+
+    m_distance1.assign(m_numVertices1, infinity);
+    m_distance2.assign(m_numVertices2, infinity);
+    m_predEdge2.assign(m_numVertices2, -1);
+    double terminalDistance = infinity;
+    int terminalPred = -1;
+
+    // Heap elements are pairs of distance and vertex. Vertices of the first
+    // set are numbered 0..n1-1, vertices of the second set n1..n1+n2-1, the
+    // terminal vertex is n1+n2.
+    typedef std::pair<double, int> HeapElement;
+    std::priority_queue<HeapElement, std::vector<HeapElement>, std::greater<HeapElement> > heap;
+
+    const int terminalVertex = m_numVertices1 + m_numVertices2;
+
+    for ( int i=0; i<m_numVertices1; i++ ) {
+        if ( m_matchedEdge1[i] < 0 ) {
+            m_distance1[i] = std::max(-m_potential1[i], 0.0);
+            heap.push(HeapElement(m_distance1[i], i));
+        }
+    }
+
+    while ( !heap.empty() ) {
+        const HeapElement minElem = heap.top();
+        heap.pop();
+
+        const double distance = minElem.first;
+        const int u = minElem.second;
+
+        if ( u == terminalVertex ) {
+            // shortest augmenting path has been found
+            break;
+        }
+
+        if ( u < m_numVertices1 ) {
+            if ( distance > m_distance1[u] )
+                continue;
+
+            // unmatched edges to the second set
+            for ( int e=m_firstEdge[u]; e<m_firstEdge[u + 1]; e++ ) {
+                if ( e == m_matchedEdge1[u] )
+                    continue;
+
+                const int v = m_edgeVertex2[e];
+                const double reducedCost =
+                    std::max(m_edgeCost[e] + m_potential1[u] - m_potential2[v], 0.0);
+                const double newDistance = distance + reducedCost;
+                if ( newDistance < m_distance2[v] ) {
+                    m_distance2[v] = newDistance;
+                    m_predEdge2[v] = e;
+                    heap.push(HeapElement(newDistance, m_numVertices1 + v));
+                }
+            }
+        }
+        else {
+            const int v = u - m_numVertices1;
+            if ( distance > m_distance2[v] )
+                continue;
+
+            const int e = m_matchedEdge2[v];
+            if ( e < 0 ) {
+                // free vertex, edge to terminal vertex
+                const double reducedCost =
+                    std::max(m_potential2[v] - m_terminalPotential, 0.0);
+                const double newDistance = distance + reducedCost;
+                if ( newDistance < terminalDistance ) {
+                    terminalDistance = newDistance;
+                    terminalPred = v;
+                    heap.push(HeapElement(newDistance, terminalVertex));
+                }
+            }
+            else {
+                // inverted matching edge back to the first set
+                const int w = m_edgeVertex1[e];
+                const double reducedCost =
+                    std::max(-m_edgeCost[e] + m_potential2[v] - m_potential1[w], 0.0);
+                const double newDistance = distance + reducedCost;
+                if ( newDistance < m_distance1[w] ) {
+                    m_distance1[w] = newDistance;
+                    heap.push(HeapElement(newDistance, w));
+                }
+            }
+        }
+    }
+
+    if ( terminalPred < 0 ) {
+        // no augmenting path, the matching has maximum cardinality
+        return false;
+    }
+
+    // Update potentials. Vertices that have not been settled are at least
+    // as far away as the terminal vertex.
+    for ( int i=0; i<m_numVertices1; i++ )
+        m_potential1[i] += std::min(m_distance1[i], terminalDistance);
+    for ( int j=0; j<m_numVertices2; j++ )
+        m_potential2[j] += std::min(m_distance2[j], terminalDistance);
+    m_terminalPotential += terminalDistance;
+
+    // Invert the edges along the augmenting path. A matched vertex of the
+    // first set can only be reached via its matching edge.
+    int v = terminalPred;
+    while ( true ) {
+        const int e = m_predEdge2[v];
+        const int u = m_edgeVertex1[e];
+        const int oldEdge = m_matchedEdge1[u];
+
+        m_matchedEdge1[u] = e;
+        m_matchedEdge2[v] = e;
+
+        if ( oldEdge < 0 )
+            break;
+
+        v = m_edgeVertex2[oldEdge];
+    }
+
+    m_cardinality++;
+
+    return true;
+}
+
+int McMinCostBipartiteMatching::getCardinality() const
+{
+    return m_cardinality;
+}
+
+void McMinCostBipartiteMatching::getMatching(std::vector<int> & vertices1,
+                                             std::vector<int> & vertices2) const
+{
+    vertices1.clear();
+    vertices2.clear();
+
+    for ( int i=0; i<m_numVertices1; i++ ) {
+        if ( m_matchedEdge1[i] >= 0 ) {
+            vertices1.push_back(i);
+            vertices2.push_back(m_edgeVertex2[m_matchedEdge1[i]]);
+        }
+    }
+}
+
+double McMinCostBipartiteMatching::getCost() const
+{
+    double cost = 0.0;
+    for ( int i=0; i<m_numVertices1; i++ ) {
+        if ( m_matchedEdge1[i] >= 0 )
+            cost += m_edgeCost[m_matchedEdge1[i]];
+    }
+
+    return cost;
+}
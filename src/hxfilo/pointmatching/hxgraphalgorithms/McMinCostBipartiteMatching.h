@@ -0,0 +1,83 @@
+#ifndef MC_MIN_COST_BIPARTITE_MATCHING_H
+#define MC_MIN_COST_BIPARTITE_MATCHING_H
+
+#include "api.h"
+
+#include <vector>
+
+/**
+    The class @c McMinCostBipartiteMatching computes minimum cost
+    matchings of increasing cardinality in a sparse bipartite graph.
+    The vertices of the first and second set are numbered
+    independently, starting at 0. Only the edges that are added with
+    @c addEdge can be part of a matching.
+
+    Each call of @c augment increases the cardinality of the current
+    matching by one, such that the new matching has minimal total cost
+    among all matchings of this cardinality (successive shortest
+    paths). The shortest augmenting path is found with Dijkstra's
+    algorithm on reduced costs (Jonker-Volgenant potentials), so that
+    each augmentation only touches the edges of the sparse graph and
+    stops as soon as a free vertex of the second set is reached.
+
+    Negative edge costs are allowed.
+*/
+class HXGRAPHALGORITHMS_API McMinCostBipartiteMatching {
+public:
+    McMinCostBipartiteMatching();
+
+    /** Removes all edges and the current matching, and sets the number
+        of vertices in the two vertex sets. */
+    void init(const int numVertices1, const int numVertices2);
+
+    /** Adds an edge between vertex @c vertex1 of the first set and
+        @c vertex2 of the second set. Edges must be added before the
+        first call of @c augment. */
+    void addEdge(const int vertex1, const int vertex2, const double cost);
+
+    /** Finds a minimum cost matching with one more edge than the current
+        one. Returns false, if the current matching already has maximum
+        cardinality. The matching is not changed in this case. */
+    bool augment();
+
+    int getCardinality() const;
+
+    /** Returns the edges of the current matching, ordered by the vertex
+        of the first set. */
+    void getMatching(std::vector<int> & vertices1,
+                     std::vector<int> & vertices2) const;
+
+    double getCost() const;
+
+private:
+    void initPotentials();
+
+    int m_numVertices1;
+    int m_numVertices2;
+
+    // Edges, sorted by vertex of the first set after initialization
+    std::vector<int>    m_edgeVertex1;
+    std::vector<int>    m_edgeVertex2;
+    std::vector<double> m_edgeCost;
+    std::vector<int>    m_firstEdge;
+
+    // Index of matching edge of each vertex, -1 if free
+    std::vector<int>    m_matchedEdge1;
+    std::vector<int>    m_matchedEdge2;
+    int                 m_cardinality;
+
+    // Potentials of vertices of first set, second set and terminal vertex
+    std::vector<double> m_potential1;
+    std::vector<double> m_potential2;
+    double              m_terminalPotential;
+    bool                m_needsInitialization;
+
+    // Temporary data for Dijkstra's algorithm
+    std::vector<double> m_distance1;
+    std::vector<double> m_distance2;
+    std::vector<int>    m_predEdge2;
+    std::vector<char>   m_settled1;
+    std::vector<char>   m_settled2;
+};
+
+#endif